@@ -0,0 +1,202 @@
+#include <chrono>
+#include <cstdio>  // for std::fgets(), std::remove()
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <stdio.h> // for popen(), pclose()
+
+#include <boost/lexical_cast.hpp>
+#include <boost/program_options/options_description.hpp>
+#include <boost/program_options/parsers.hpp>        // for parse_command_line()
+#include <boost/program_options/value_semantic.hpp> // for value<>()
+#include <boost/program_options/variables_map.hpp>  // for variables_map, store() and notify()
+
+#include <mac_time_tracker/address.hpp>
+#include <mac_time_tracker/address_scanner.hpp>
+#include <mac_time_tracker/bit_kernels.hpp>
+#include <mac_time_tracker/csv.hpp>
+#include <mac_time_tracker/scan_records.hpp>
+#include <mac_time_tracker/set.hpp>
+#include <mac_time_tracker/time.hpp>
+
+namespace mtt = mac_time_tracker;
+
+////////////////////////
+// Command line options
+
+struct Parameters {
+  unsigned int hosts, scans, repeats;
+  std::string output_txt;
+
+  // Get parameters from command line args.
+  // If help is requested via command line, non-empty help_msg is also provided.
+  static Parameters fromCommandLine(const int argc, const char *const argv[],
+                                    std::string *const help_msg) {
+    namespace bpo = boost::program_options;
+    Parameters params;
+    bool help;
+    // define command line options
+    bpo::options_description arg_desc(
+        "address_scanner_benchmark",
+        /* line length in help msg = */ bpo::options_description::m_default_line_length,
+        /* desc length in help msg = */ bpo::options_description::m_default_line_length * 6 / 10);
+    arg_desc.add_options()
+        // key, correspinding variable, description
+        ("hosts", bpo::value(&params.hosts)->default_value(10000),
+         "number of hosts in output of arp-scan") //
+        ("scans", bpo::value(&params.scans)->default_value(100),
+         "number of scans of the hosts in a history of scans") //
+        ("repeats", bpo::value(&params.repeats)->default_value(10),
+         "number of measurements to average") //
+        ("output-txt",
+         bpo::value(&params.output_txt)->default_value("address_scanner_benchmark.txt"),
+         "path to temporary .txt file") //
+        ("help,h", bpo::bool_switch(&help), "print help message");
+    // parse command line args
+    bpo::variables_map arg_map;
+    bpo::store(bpo::parse_command_line(argc, argv, arg_desc), arg_map);
+    bpo::notify(arg_map);
+    // return results
+    *help_msg = help ? boost::lexical_cast<std::string>(arg_desc) : std::string("");
+    return params;
+  }
+};
+
+// mean time of repeated calls in microseconds
+template <class Function> double meanUs(const unsigned int repeats, const Function &func) {
+  const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (unsigned int i = 0; i < repeats; ++i) {
+    func();
+  }
+  return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start)
+             .count() /
+         repeats;
+}
+
+// the former path of Set::fromARPScan(); grep picks addresses and each line is parsed
+mtt::Set fromGrep(const std::string &filename) {
+  const std::unique_ptr<FILE, int (*)(FILE *)> fp(
+      popen((R"(grep '\([0-9a-fA-F]\{2\}[-:]\)\{5\}\([0-9a-fA-F]\{2\}\)' --only-matching )" +
+             filename)
+                .c_str(),
+            "r"),
+      pclose);
+  if (!fp) {
+    throw std::runtime_error("popen");
+  }
+  mtt::Set set;
+  char line[256];
+  while (std::fgets(line, 256, fp.get())) {
+    set.insert(mtt::Address::fromStr(line));
+  }
+  return set;
+}
+
+////////
+// Main
+
+int main(int argc, char *argv[]) {
+  // Parse command line args
+  std::string help_msg;
+  const Parameters params = Parameters::fromCommandLine(argc, argv, &help_msg);
+  if (!help_msg.empty()) {
+    std::cout << help_msg << std::endl;
+    return 0;
+  }
+
+  try {
+    // Make output of arp-scan with many hosts
+    std::mt19937_64 rng(12345);
+    std::vector<mtt::Address> addrs;
+    std::string output = "Interface: eth0, type: EN10MB, MAC: 02:42:ac:11:00:02, IPv4: 10.0.0.2\n"
+                         "Starting arp-scan 1.9.7 with 65536 hosts\n";
+    for (unsigned int i = 0; i < params.hosts; ++i) {
+      addrs.push_back(mtt::Address::fromInt(rng()));
+      output += "10.0." + boost::lexical_cast<std::string>(i / 256) + "." +
+                boost::lexical_cast<std::string>(i % 256) + "\t" + addrs.back().toStr() +
+                "\tSome Vendor, Inc.\n";
+    }
+    output += "\nEnding arp-scan 1.9.7: 65536 hosts scanned. " +
+              boost::lexical_cast<std::string>(params.hosts) + " responded\n";
+    {
+      std::ofstream ofs(params.output_txt);
+      ofs << output;
+    }
+
+    // Measure extraction of the addresses
+    std::cout << output.size() << " bytes of arp-scan output with " << params.hosts << " hosts"
+              << std::endl;
+    mtt::Set grep_set;
+    const double grep_us =
+        meanUs(params.repeats, [&]() { grep_set = fromGrep(params.output_txt); });
+    std::cout << std::setw(24) << "grep + fromStr(): " << std::fixed << std::setprecision(1)
+              << grep_us << " us" << std::endl;
+    std::vector<bool> simds(1, false);
+    if (mtt::BitKernels::hasAVX2()) {
+      simds.push_back(true);
+    } else {
+      std::cout << "AVX2 is not available" << std::endl;
+    }
+    for (const bool simd : simds) {
+      mtt::Set set;
+      const double scan_us = meanUs(params.repeats, [&]() {
+        set.clear();
+        mtt::AddressScanner::scan(output.data(), output.data() + output.size(),
+                                  std::inserter(set, set.end()), simd);
+      });
+      std::vector<mtt::Address> found;
+      const double vector_us = meanUs(params.repeats, [&]() {
+        found.clear();
+        mtt::AddressScanner::scan(output.data(), output.data() + output.size(),
+                                  std::back_inserter(found), simd);
+      });
+      if (set != grep_set || found.size() != grep_set.size()) {
+        throw std::runtime_error("Results of AddressScanner differ from the ones of grep");
+      }
+      std::cout << std::setw(22) << (simd ? "scan() avx2: " : "scan() scalar: ") << scan_us
+                << " us to a set, " << vector_us << " us to a vector" << std::endl;
+    }
+
+    // Measure reading a history of scans
+    const mtt::Time base_time = mtt::Time::fromStr("2021-03-11 00:00:00");
+    mtt::ScanRecords records;
+    std::bernoulli_distribution present(0.5);
+    for (unsigned int i_scan = 0; i_scan < params.scans; ++i_scan) {
+      mtt::Set &set = records[base_time + i_scan * std::chrono::minutes(5)];
+      for (const mtt::Address &addr : addrs) {
+        if (present(rng)) {
+          set.insert(addr);
+        }
+      }
+    }
+    const std::string history = records.toStr();
+    std::cout << history.size() << " bytes of a history of " << params.scans << " scans"
+              << std::endl;
+    const double tokenize_us = meanUs(std::max(params.repeats / 10, 1u), [&]() {
+      if (mtt::ScanRecords::fromCSV(mtt::CSV::fromStr(history)) != records) {
+        throw std::runtime_error("ScanRecords are not read correctly");
+      }
+    });
+    const double parse_us = meanUs(std::max(params.repeats / 10, 1u), [&]() {
+      if (mtt::ScanRecords::fromStr(history) != records) {
+        throw std::runtime_error("ScanRecords are not read correctly");
+      }
+    });
+    std::cout << std::setw(24) << "tokenized: " << tokenize_us / 1000. << " ms" << std::endl
+              << std::setw(24) << "scanned: " << parse_us / 1000. << " ms" << std::endl;
+
+    std::remove(params.output_txt.c_str());
+  } catch (const std::exception &err) {
+    std::cerr << err.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,157 @@
+#include <chrono>
+#include <cstdio> // for std::remove()
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/lexical_cast.hpp>
+#include <boost/program_options/options_description.hpp>
+#include <boost/program_options/parsers.hpp>        // for parse_command_line()
+#include <boost/program_options/value_semantic.hpp> // for value<>()
+#include <boost/program_options/variables_map.hpp>  // for variables_map, store() and notify()
+
+#include <mac_time_tracker/address.hpp>
+#include <mac_time_tracker/columnar_period_map.hpp>
+#include <mac_time_tracker/parallel.hpp>
+#include <mac_time_tracker/period_map.hpp>
+#include <mac_time_tracker/time.hpp>
+
+namespace mtt = mac_time_tracker;
+
+////////////////////////
+// Command line options
+
+struct Parameters {
+  unsigned int devices, scans, max_threads;
+  double presence;
+  std::string output_html;
+
+  // Get parameters from command line args.
+  // If help is requested via command line, non-empty help_msg is also provided.
+  static Parameters fromCommandLine(const int argc, const char *const argv[],
+                                    std::string *const help_msg) {
+    namespace bpo = boost::program_options;
+    Parameters params;
+    bool help;
+    // define command line options
+    bpo::options_description arg_desc(
+        "period_map_benchmark",
+        /* line length in help msg = */ bpo::options_description::m_default_line_length,
+        /* desc length in help msg = */ bpo::options_description::m_default_line_length * 6 / 10);
+    arg_desc.add_options()
+        // key, correspinding variable, description
+        ("devices", bpo::value(&params.devices)->default_value(10000),
+         "number of devices in the map") //
+        ("scans", bpo::value(&params.scans)->default_value(96),
+         "number of 5-minute scans in the map") //
+        ("presence", bpo::value(&params.presence)->default_value(0.5),
+         "probability that a device is present in a scan") //
+        ("max-threads", bpo::value(&params.max_threads)->default_value(0),
+         "measure with 1, 2, 4, ... threads up to this number."
+         " 0 means the number of hardware threads.") //
+        ("output-html",
+         bpo::value(&params.output_html)->default_value("period_map_benchmark.html"),
+         "path to temporary .html file") //
+        ("help,h", bpo::bool_switch(&help), "print help message");
+    // parse command line args
+    bpo::variables_map arg_map;
+    bpo::store(bpo::parse_command_line(argc, argv, arg_desc), arg_map);
+    bpo::notify(arg_map);
+    // return results
+    *help_msg = help ? boost::lexical_cast<std::string>(arg_desc) : std::string("");
+    return params;
+  }
+};
+
+std::string readFile(const std::string &filename) {
+  std::ifstream ifs(filename);
+  if (!ifs) {
+    throw std::runtime_error("Cannot open '" + filename + "' to read");
+  }
+  return std::string(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+}
+
+double elapsedMs(const std::chrono::steady_clock::time_point &start) {
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+////////
+// Main
+
+int main(int argc, char *argv[]) {
+  namespace sc = std::chrono;
+
+  // Parse command line args
+  std::string help_msg;
+  const Parameters params = Parameters::fromCommandLine(argc, argv, &help_msg);
+  if (!help_msg.empty()) {
+    std::cout << help_msg << std::endl;
+    return 0;
+  }
+
+  try {
+    // Make a map like a tracking period with many devices
+    const mtt::Time base_time = mtt::Time::fromStr("2021-03-11 00:00:00");
+    mtt::ColumnarPeriodMap tracked_addrs(base_time);
+    std::mt19937 rng(12345);
+    std::bernoulli_distribution present(params.presence);
+    for (unsigned int i_scan = 0; i_scan < params.scans; ++i_scan) {
+      const mtt::PeriodMap::Period period = {base_time + i_scan * sc::minutes(5),
+                                             base_time + (i_scan + 1) * sc::minutes(5)};
+      for (unsigned int i_dev = 0; i_dev < params.devices; ++i_dev) {
+        if (present(rng)) {
+          tracked_addrs.insert(
+              {period,
+               {mtt::Address::fromInt(0x001122000000ull + i_dev),
+                "Category" + boost::lexical_cast<std::string>(i_dev % 100), "Device"}});
+        }
+      }
+    }
+    std::cout << tracked_addrs.size() << " entries of " << params.devices << " devices in "
+              << params.scans << " scans ("
+              << tracked_addrs.memoryUsage() / (1024. * 1024.) << " MiB)" << std::endl;
+
+    // Measure gap-filling and HTML formatting with increasing threads
+    const std::string html_in = "<!-- @DATE@ -->\n@DATA_ENTRIES@\n";
+    const unsigned int max_threads = mtt::resolveThreads(params.max_threads);
+    std::string serial_filled, serial_html;
+    double serial_ms = 0.;
+    std::cout << std::setw(8) << "threads" << std::setw(12) << "fill [ms]" << std::setw(12)
+              << "html [ms]" << std::setw(12) << "speed-up" << std::endl;
+    for (unsigned int n_threads = 1; n_threads <= max_threads; n_threads *= 2) {
+      sc::steady_clock::time_point start = sc::steady_clock::now();
+      const mtt::PeriodMap filled = tracked_addrs.filled(sc::hours(1), "*", n_threads);
+      const double fill_ms = elapsedMs(start);
+      start = sc::steady_clock::now();
+      filled.toHTML(params.output_html, html_in, mtt::Time::defaultFormat(),
+                    mtt::Address::defaultSeparator(), base_time, n_threads);
+      const double html_ms = elapsedMs(start);
+
+      // outputs must be byte-identical to the serial ones
+      const std::string filled_str = filled.toStr(), html_str = readFile(params.output_html);
+      if (n_threads == 1) {
+        serial_filled = filled_str;
+        serial_html = html_str;
+        serial_ms = fill_ms + html_ms;
+      } else if (filled_str != serial_filled || html_str != serial_html) {
+        throw std::runtime_error("Outputs on " + boost::lexical_cast<std::string>(n_threads) +
+                                 " threads differ from the serial ones");
+      }
+      std::cout << std::setw(8) << n_threads << std::fixed << std::setprecision(1)
+                << std::setw(12) << fill_ms << std::setw(12) << html_ms << std::setw(11)
+                << serial_ms / (fill_ms + html_ms) << "x" << std::endl;
+    }
+    std::remove(params.output_html.c_str());
+  } catch (const std::exception &err) {
+    std::cerr << err.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
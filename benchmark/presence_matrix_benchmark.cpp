@@ -0,0 +1,165 @@
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/lexical_cast.hpp>
+#include <boost/program_options/options_description.hpp>
+#include <boost/program_options/parsers.hpp>        // for parse_command_line()
+#include <boost/program_options/value_semantic.hpp> // for value<>()
+#include <boost/program_options/variables_map.hpp>  // for variables_map, store() and notify()
+
+#include <mac_time_tracker/address.hpp>
+#include <mac_time_tracker/bit_kernels.hpp>
+#include <mac_time_tracker/columnar_period_map.hpp>
+#include <mac_time_tracker/period_map.hpp>
+#include <mac_time_tracker/presence_matrix.hpp>
+#include <mac_time_tracker/time.hpp>
+
+namespace mtt = mac_time_tracker;
+
+////////////////////////
+// Command line options
+
+struct Parameters {
+  unsigned int devices, scans, categories, max_fill, repeats;
+  double presence;
+
+  // Get parameters from command line args.
+  // If help is requested via command line, non-empty help_msg is also provided.
+  static Parameters fromCommandLine(const int argc, const char *const argv[],
+                                    std::string *const help_msg) {
+    namespace bpo = boost::program_options;
+    Parameters params;
+    bool help;
+    // define command line options
+    bpo::options_description arg_desc(
+        "presence_matrix_benchmark",
+        /* line length in help msg = */ bpo::options_description::m_default_line_length,
+        /* desc length in help msg = */ bpo::options_description::m_default_line_length * 6 / 10);
+    arg_desc.add_options()
+        // key, correspinding variable, description
+        ("devices", bpo::value(&params.devices)->default_value(10000),
+         "number of devices in the matrix") //
+        ("scans", bpo::value(&params.scans)->default_value(288),
+         "number of 5-minute scans (slots) in the matrix") //
+        ("categories", bpo::value(&params.categories)->default_value(100),
+         "number of categories of the devices") //
+        ("presence", bpo::value(&params.presence)->default_value(0.5),
+         "probability that a device is present in a scan") //
+        ("max-fill", bpo::value(&params.max_fill)->default_value(60),
+         "fill gaps up to this value in minutes") //
+        ("repeats", bpo::value(&params.repeats)->default_value(100),
+         "number of measurements to average") //
+        ("help,h", bpo::bool_switch(&help), "print help message");
+    // parse command line args
+    bpo::variables_map arg_map;
+    bpo::store(bpo::parse_command_line(argc, argv, arg_desc), arg_map);
+    bpo::notify(arg_map);
+    // return results
+    *help_msg = help ? boost::lexical_cast<std::string>(arg_desc) : std::string("");
+    return params;
+  }
+};
+
+// mean time of repeated calls in microseconds
+template <class Function> double meanUs(const unsigned int repeats, const Function &func) {
+  const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  for (unsigned int i = 0; i < repeats; ++i) {
+    func();
+  }
+  return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start)
+             .count() /
+         repeats;
+}
+
+////////
+// Main
+
+int main(int argc, char *argv[]) {
+  namespace sc = std::chrono;
+
+  // Parse command line args
+  std::string help_msg;
+  const Parameters params = Parameters::fromCommandLine(argc, argv, &help_msg);
+  if (!help_msg.empty()) {
+    std::cout << help_msg << std::endl;
+    return 0;
+  }
+
+  try {
+    // Make a map like a tracking period with many devices
+    const mtt::Time base_time = mtt::Time::fromStr("2021-03-11 00:00:00");
+    mtt::ColumnarPeriodMap tracked_addrs(base_time);
+    std::mt19937 rng(12345);
+    std::bernoulli_distribution present(params.presence);
+    for (unsigned int i_scan = 0; i_scan < params.scans; ++i_scan) {
+      const mtt::PeriodMap::Period period = {base_time + i_scan * sc::minutes(5),
+                                             base_time + (i_scan + 1) * sc::minutes(5)};
+      for (unsigned int i_dev = 0; i_dev < params.devices; ++i_dev) {
+        if (present(rng)) {
+          tracked_addrs.insert(
+              {period,
+               {mtt::Address::fromInt(0x001122000000ull + i_dev),
+                "Category" + boost::lexical_cast<std::string>(i_dev % params.categories),
+                "Device"}});
+        }
+      }
+    }
+    const sc::steady_clock::time_point start = sc::steady_clock::now();
+    const mtt::PresenceMatrix matrix = mtt::PresenceMatrix::fromRange(
+        tracked_addrs.begin(), tracked_addrs.end(), base_time, sc::minutes(5), params.scans);
+    std::cout << tracked_addrs.size() << " entries of " << params.devices << " devices in "
+              << params.scans << " scans to the matrix in "
+              << sc::duration<double, std::milli>(sc::steady_clock::now() - start).count()
+              << " ms" << std::endl;
+
+    // Measure kernels on scalar and AVX2 versions
+    std::vector<bool> simds(1, false);
+    if (mtt::BitKernels::hasAVX2()) {
+      simds.push_back(true);
+    } else {
+      std::cout << "AVX2 is not available" << std::endl;
+    }
+    std::cout << std::setw(8) << "kernel" << std::setw(12) << "fill [us]" << std::setw(12)
+              << "total [us]" << std::setw(15) << "devices [us]" << std::setw(18)
+              << "categories [us]" << std::endl;
+    std::size_t serial_slots = 0;
+    for (const bool simd : simds) {
+      std::size_t slots = 0;
+      const double fill_us = meanUs(params.repeats, [&]() {
+        slots = matrix.filled(sc::minutes(params.max_fill), simd).totalPresentSlots(simd);
+      });
+      const double total_us =
+          meanUs(params.repeats, [&]() { slots = matrix.totalPresentSlots(simd); });
+      const double devices_us = meanUs(params.repeats, [&]() { matrix.presence(simd); });
+      std::vector<std::string> categories;
+      const double categories_us =
+          meanUs(params.repeats, [&]() { matrix.coPresence(&categories, simd); });
+      // results must not depend on the kernels
+      if (!simd) {
+        serial_slots = slots;
+      } else if (slots != serial_slots) {
+        throw std::runtime_error("Results of AVX2 kernels differ from the scalar ones");
+      }
+      std::cout << std::setw(8) << (simd ? "avx2" : "scalar") << std::fixed
+                << std::setprecision(1) << std::setw(12) << fill_us << std::setw(12) << total_us
+                << std::setw(15) << devices_us << std::setw(18) << categories_us << std::endl;
+    }
+
+    // Reference; filling of entries
+    const double entries_us = meanUs(std::max(params.repeats / 100, 1u), [&]() {
+      tracked_addrs.filled(sc::minutes(params.max_fill));
+    });
+    std::cout << "ColumnarPeriodMap::filled(): " << entries_us << " us" << std::endl;
+  } catch (const std::exception &err) {
+    std::cerr << err.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,344 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <ctime> // for std::tm
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <boost/lexical_cast.hpp>
+#include <boost/program_options/options_description.hpp>
+#include <boost/program_options/parsers.hpp>        // for parse_command_line()
+#include <boost/program_options/value_semantic.hpp> // for value<>()
+#include <boost/program_options/variables_map.hpp>  // for variables_map, store() and notify()
+
+#include <mac_time_tracker/address.hpp>
+#include <mac_time_tracker/csv.hpp>
+#include <mac_time_tracker/period_map.hpp>
+#include <mac_time_tracker/time.hpp>
+
+namespace mtt = mac_time_tracker;
+
+////////////////////////
+// Command line options
+
+struct Parameters {
+  unsigned int devices, days, seed;
+  std::chrono::minutes scan_interval;
+  double churn, randomized;
+  std::string start, known_addr_csv, tracked_addr_csv_fmt, scan_records, arp_scan_output;
+
+  // Get parameters from command line args.
+  // If help is requested via command line, non-empty help_msg is also provided.
+  static Parameters fromCommandLine(const int argc, const char *const argv[],
+                                    std::string *const help_msg) {
+    namespace bpo = boost::program_options;
+    Parameters params;
+    bool help;
+    // define command line options
+    bpo::options_description arg_desc(
+        "workload_generator",
+        /* line length in help msg = */ bpo::options_description::m_default_line_length,
+        /* desc length in help msg = */ bpo::options_description::m_default_line_length * 6 / 10);
+    arg_desc.add_options()
+        // key, correspinding variable, description
+        ("devices", bpo::value(&params.devices)->default_value(10000),
+         "number of known devices at the start. about 2 devices belong to a person"
+         " and 5% are always-on infrastructure.") //
+        ("days", bpo::value(&params.days)->default_value(1), "number of days to generate") //
+        ("start", bpo::value(&params.start)->default_value("2021-03-01 00:00:00"),
+         "start time, which should be a midnight") //
+        ("scan-interval",
+         bpo::value<unsigned int>()->default_value(5)->notifier([&params](const unsigned int val) {
+           params.scan_interval = std::chrono::minutes(val);
+         }),
+         "interval between scans in minutes") //
+        ("churn", bpo::value(&params.churn)->default_value(0.01),
+         "probability that a device is replaced by a new one of the same owner each day") //
+        ("randomized", bpo::value(&params.randomized)->default_value(0.05),
+         "probability that a present person shows a new randomized address in a scan") //
+        ("seed", bpo::value(&params.seed)->default_value(1),
+         "random seed. outputs are same for the same parameters.") //
+        ("known-addr-csv", bpo::value(&params.known_addr_csv)->default_value(""),
+         "path to output address book of all devices ever known. empty means no output.") //
+        ("tracked-addr-csv", bpo::value(&params.tracked_addr_csv_fmt)->default_value(""),
+         "path to output .csv file of each day like mac_time_tracker's."
+         " will be formatted by std::put_time(). empty means no output.") //
+        ("scan-records", bpo::value(&params.scan_records)->default_value(""),
+         "path to output scan records for mac_time_tracker --replay."
+         " empty means no output.") //
+        ("arp-scan-output", bpo::value(&params.arp_scan_output)->default_value(""),
+         "path to output of arp-scan runs, one per scan. empty means no output.") //
+        ("help,h", bpo::bool_switch(&help), "print help message");
+    // parse command line args
+    bpo::variables_map arg_map;
+    bpo::store(bpo::parse_command_line(argc, argv, arg_desc), arg_map);
+    bpo::notify(arg_map);
+    // return results
+    *help_msg = help ? boost::lexical_cast<std::string>(arg_desc) : std::string("");
+    return params;
+  }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Random numbers from splitmix64 that do not depend on the standard library
+// so that outputs are reproducible on any platform
+
+class Random {
+public:
+  explicit Random(const std::uint64_t seed) : state_(seed) {}
+
+  std::uint64_t next() {
+    std::uint64_t z = (state_ += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+  }
+  // in [0, 1)
+  double uniform() { return (next() >> 11) * (1. / (1ull << 53)); }
+  double uniform(const double lo, const double hi) { return lo + (hi - lo) * uniform(); }
+  bool bernoulli(const double p) { return uniform() < p; }
+  // Box-Muller
+  double normal(const double mean, const double stddev) {
+    const double pi = 3.14159265358979323846;
+    const double u1 = 1. - uniform(), u2 = uniform();
+    return mean + stddev * std::sqrt(-2. * std::log(u1)) * std::cos(2. * pi * u2);
+  }
+
+private:
+  std::uint64_t state_;
+};
+
+//////////////////////
+// Model of presence
+
+struct Device {
+  mtt::Address address;
+  std::uint32_t ip; // in 10.0.0.0/8
+  std::size_t owner;
+  const char *kind;
+  double detection; // probability to reply to a scan while present
+};
+
+// a person who comes on weekdays (and sometimes on weekends)
+// and may be out for lunch. owner 0 is the infrastructure that is always present.
+struct Person {
+  std::string name;
+  double arrival_hour, stay_hours, weekday_attendance;
+
+  // presence in a day as hours from its midnight
+  struct Day {
+    bool present;
+    double arrival, departure, break_start, break_end;
+  };
+
+  Day dayOf(const bool weekend, Random *const rng) const {
+    Day day = {};
+    if (name.empty()) {
+      day.present = true;
+      day.arrival = 0.;
+      day.departure = 24.;
+      return day;
+    }
+    day.present = rng->bernoulli(weekend ? weekday_attendance * 0.2 : weekday_attendance);
+    day.arrival = std::max(rng->normal(arrival_hour, 0.5), 0.);
+    day.departure = std::min(day.arrival + std::max(rng->normal(stay_hours, 1.), 0.5), 24.);
+    if (rng->bernoulli(0.3)) {
+      day.break_start = rng->normal(12., 0.5);
+      day.break_end = day.break_start + rng->uniform(0.5, 1.);
+    }
+    return day;
+  }
+};
+
+const char *const kinds[] = {"Phone", "PC", "Tablet", "Watch"};
+const double detections[] = {0.85, 0.97, 0.9, 0.75};
+const std::uint32_t ouis[] = {0x001122, 0x3C22FB, 0xF0189B, 0xACDE48, 0x28CFE9, 0x7C2EBD};
+
+// a globally administered address of a vendor, which is unique among the used ones
+mtt::Address newAddress(std::unordered_set<std::uint64_t> *const used, Random *const rng) {
+  while (true) {
+    const std::uint64_t oui = ouis[rng->next() % (sizeof(ouis) / sizeof(ouis[0]))];
+    const std::uint64_t addr = (oui << 24) | (rng->next() & 0xFFFFFF);
+    if (used->insert(addr).second) {
+      return mtt::Address::fromInt(addr);
+    }
+  }
+}
+
+Device newDevice(const std::size_t owner, std::unordered_set<std::uint64_t> *const used,
+                 Random *const rng) {
+  const std::size_t kind = owner == 0 ? 1 : rng->next() % 4;
+  return {newAddress(used, rng), 0x0A000000u | std::uint32_t(rng->next() & 0xFFFFFF), owner,
+          owner == 0 ? "Printer" : kinds[kind], owner == 0 ? 0.99 : detections[kind]};
+}
+
+using Replies = std::vector<std::pair<mtt::Address, std::uint32_t>>; // (MAC, IPv4)
+
+// 'Interface: ...' header, a line per reply and footer like arp-scan 1.9
+void writeARPScan(std::ostream &os, const Replies &replies) {
+  os << "Interface: eth0, type: EN10MB, MAC: 02:00:0a:00:00:01, IPv4: 10.0.0.1\n"
+     << "Starting arp-scan 1.9.7 with 16777214 hosts (https://github.com/royhills/arp-scan)\n";
+  for (const Replies::value_type &reply : replies) {
+    os << (reply.second >> 24) << "." << ((reply.second >> 16) & 0xFF) << "."
+       << ((reply.second >> 8) & 0xFF) << "." << (reply.second & 0xFF) << "\t"
+       << reply.first.toStr(':') << "\t(Unknown)\n";
+  }
+  os << "\n"
+     << replies.size() << " packets received by filter, 0 packets dropped by kernel\n"
+     << "Ending arp-scan 1.9.7: 16777214 hosts scanned. " << replies.size() << " responded\n";
+}
+
+std::unique_ptr<std::ofstream> openOutput(const std::string &filename) {
+  if (filename.empty()) {
+    return std::unique_ptr<std::ofstream>();
+  }
+  std::unique_ptr<std::ofstream> ofs(new std::ofstream(filename));
+  if (!*ofs) {
+    throw std::runtime_error("Cannot open '" + filename + "' to write");
+  }
+  return ofs;
+}
+
+////////
+// Main
+
+int main(int argc, char *argv[]) {
+  namespace sc = std::chrono;
+
+  // Parse command line args
+  std::string help_msg;
+  const Parameters params = Parameters::fromCommandLine(argc, argv, &help_msg);
+  if (!help_msg.empty()) {
+    std::cout << help_msg << std::endl;
+    return 0;
+  }
+
+  try {
+    Random rng(params.seed);
+    std::unordered_set<std::uint64_t> used_addrs;
+
+    // People and their devices. the first 5% of devices belong to the infrastructure.
+    std::vector<Person> people(1);
+    std::vector<Device> devices;
+    while (devices.size() < params.devices) {
+      if (devices.size() >= params.devices / 20) {
+        people.push_back({"Person" + boost::lexical_cast<std::string>(people.size()),
+                          rng.uniform(7., 10.), rng.uniform(6., 10.), rng.uniform(0.7, 0.95)});
+      }
+      const std::size_t n_devices = people.size() == 1 ? 1 : 1 + rng.next() % 3;
+      for (std::size_t i = 0; i < n_devices && devices.size() < params.devices; ++i) {
+        devices.push_back(newDevice(people.size() - 1, &used_addrs, &rng));
+      }
+    }
+    std::vector<Device> all_devices = devices; // incl. retired ones for the address book
+
+    std::unique_ptr<std::ofstream> scan_records = openOutput(params.scan_records),
+                                   arp_scan_output = openOutput(params.arp_scan_output);
+    const mtt::Time start = mtt::Time::fromStr(params.start);
+    std::size_t n_entries = 0, n_scans = 0;
+    for (unsigned int i_day = 0; i_day < params.days; ++i_day) {
+      const mtt::Time day_start = start + sc::hours(24 * i_day);
+      // churn of devices except on the first day
+      if (i_day > 0) {
+        for (Device &device : devices) {
+          if (device.owner > 0 && rng.bernoulli(params.churn)) {
+            device = newDevice(device.owner, &used_addrs, &rng);
+            all_devices.push_back(device);
+          }
+        }
+      }
+      std::tm tm = {};
+      const std::time_t t = mtt::Time::clock::to_time_t(day_start);
+      localtime_r(&t, &tm);
+      const bool weekend = tm.tm_wday == 0 || tm.tm_wday == 6;
+      std::vector<Person::Day> days;
+      for (const Person &person : people) {
+        days.push_back(person.dayOf(weekend, &rng));
+      }
+
+      std::unique_ptr<std::ofstream> tracked_addrs;
+      if (!params.tracked_addr_csv_fmt.empty()) {
+        tracked_addrs = openOutput(day_start.toStr(params.tracked_addr_csv_fmt));
+      }
+      for (mtt::Time scan_start = day_start; scan_start < day_start + sc::hours(24);
+           scan_start += params.scan_interval) {
+        const mtt::PeriodMap::Period period = {scan_start, scan_start + params.scan_interval};
+        const double hour = sc::duration<double, std::ratio<3600>>(scan_start - day_start).count();
+        Replies replies;
+        std::vector<bool> present_people(people.size(), false);
+        for (const Device &device : devices) {
+          const Person::Day &day = days[device.owner];
+          if (!day.present || hour < day.arrival || hour >= day.departure ||
+              (hour >= day.break_start && hour < day.break_end) ||
+              !rng.bernoulli(device.detection)) {
+            continue;
+          }
+          present_people[device.owner] = true;
+          replies.push_back({device.address, device.ip});
+          if (tracked_addrs) {
+            const Person &owner = people[device.owner];
+            mtt::CSV::writeLine(*tracked_addrs,
+                                mtt::PeriodMap::entryToCSV(
+                                    period, {device.address,
+                                             owner.name.empty() ? "Infrastructure" : owner.name,
+                                             device.kind}));
+          }
+          ++n_entries;
+        }
+        // randomized addresses that are never seen again
+        for (std::size_t i = 1; i < people.size(); ++i) {
+          if (present_people[i] && rng.bernoulli(params.randomized)) {
+            // locally administered and unicast
+            replies.push_back({mtt::Address::fromInt(0x020000000000ull |
+                                                     (rng.next() & 0xFCFFFFFFFFFFull)),
+                               0x0A000000u | std::uint32_t(rng.next() & 0xFFFFFF)});
+          }
+        }
+        // the scan finishes a few seconds after its start
+        if (scan_records) {
+          std::vector<std::string> line(1, mtt::Time(scan_start + sc::seconds(3)).toStr());
+          for (const Replies::value_type &reply : replies) {
+            line.push_back(reply.first.toStr());
+          }
+          mtt::CSV::writeLine(*scan_records, line);
+        }
+        if (arp_scan_output) {
+          writeARPScan(*arp_scan_output, replies);
+        }
+        ++n_scans;
+      }
+      if (tracked_addrs && !*tracked_addrs) {
+        throw std::runtime_error("Cannot write tracked addresses");
+      }
+    }
+
+    // the address book of all devices in the order of appearance
+    if (std::unique_ptr<std::ofstream> known_addrs = openOutput(params.known_addr_csv)) {
+      for (const Device &device : all_devices) {
+        const Person &owner = people[device.owner];
+        *known_addrs << device.address << ", "
+                     << (owner.name.empty() ? "Infrastructure" : owner.name) << ", "
+                     << device.kind << "\n";
+      }
+      if (!*known_addrs) {
+        throw std::runtime_error("Cannot write known addresses");
+      }
+    }
+    if ((scan_records && !*scan_records) || (arp_scan_output && !*arp_scan_output)) {
+      throw std::runtime_error("Cannot write scans");
+    }
+    std::cout << all_devices.size() << " devices of " << people.size() - 1 << " people, "
+              << n_entries << " entries in " << n_scans << " scans" << std::endl;
+  } catch (const std::exception &err) {
+    std::cerr << err.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
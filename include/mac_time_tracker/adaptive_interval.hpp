@@ -0,0 +1,48 @@
+#ifndef MAC_TIME_TRACKER_ADAPTIVE_INTERVAL_HPP
+#define MAC_TIME_TRACKER_ADAPTIVE_INTERVAL_HPP
+
+#include <chrono>
+#include <stdexcept>
+
+namespace mac_time_tracker {
+
+/////////////////////////////////////////////////////////////////////////////////////
+// Interval between scans that doubles while scan results are stable (up to the max)
+// and returns to the min once they change.
+// the interval is always a multiple of the min so that scanning periods stay on the grid
+// of the min interval.
+
+class AdaptiveInterval {
+public:
+  using Duration = std::chrono::minutes;
+
+public:
+  AdaptiveInterval(const Duration &min, const Duration &max)
+      : min_(min), max_(max < min ? min : max), current_(min) {
+    if (min_ <= Duration::zero()) {
+      throw std::runtime_error("AdaptiveInterval::AdaptiveInterval(): Min must be positive");
+    }
+  }
+
+  // give whether the last scan result differs from the previous one
+  void update(const bool changed) {
+    if (changed) {
+      current_ = min_;
+    } else if (current_ * 2 <= max_) {
+      current_ *= 2;
+    } else {
+      // the largest multiple of min not exceeding max
+      current_ = (max_ / min_) * min_;
+    }
+  }
+
+  const Duration &current() const { return current_; }
+  const Duration &min() const { return min_; }
+  const Duration &max() const { return max_; }
+
+private:
+  Duration min_, max_, current_;
+};
+} // namespace mac_time_tracker
+
+#endif
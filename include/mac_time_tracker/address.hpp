@@ -2,8 +2,8 @@
 #define MAC_TIME_TRACKER_ADDRESS_HPP
 
 #include <array>
+#include <cctype> // for std::isspace()
 #include <cstdint>
-#include <cstdio>
 #include <iostream>
 #include <string>
 
@@ -14,7 +14,9 @@ namespace mac_time_tracker {
 ///////////////
 // MAC address
 
-class Address : public std::array<std::uint8_t, 6>, public Readable<Address>, public Writable {
+class Address : public std::array<std::uint8_t, 6>,
+                public Readable<Address>,
+                public Writable<Address> {
 public:
   Address() {}
   Address(const std::uint8_t v0, const std::uint8_t v1, const std::uint8_t v2,
@@ -27,37 +29,102 @@ public:
     (*this)[5] = v5;
   }
 
-  using Writable::toStr;
-  std::string toStr(const char sep) const {
-    char str[18];
-    // "%02X" -> 2 chars (2) of hex in uppercase (X), 0-padded (0)
-    std::sprintf(str, "%02X %02X %02X %02X %02X %02X", (*this)[0], (*this)[1], (*this)[2],
-                 (*this)[3], (*this)[4], (*this)[5]);
-    str[2] = str[5] = str[8] = str[11] = str[14] = sep;
-    return str;
+  // parse a string like "00:AA:11:bb:22:Cc" or "0a-1B-2c-3D-4e-5F" after optional spaces
+  // at the beginning of [first, last). it must be followed by a space or the end
+  // as it is read from a stream. returns the end of the address, or nullptr on failure.
+  static const char *fromChars(const char *first, const char *const last, Address *const addr) {
+    while (first != last && std::isspace(static_cast<unsigned char>(*first))) {
+      ++first;
+    }
+    if (last - first < 17 ||
+        (last - first > 17 && !std::isspace(static_cast<unsigned char>(first[17])))) {
+      return nullptr;
+    }
+    Address val;
+    for (int i = 0; i < 6; ++i) {
+      const char *const octet = first + 3 * i;
+      const int hi = hexDigit(octet[0]), lo = hexDigit(octet[1]);
+      if (hi < 0 || lo < 0 || (i < 5 && octet[2] != ':' && octet[2] != '-')) {
+        return nullptr;
+      }
+      val[i] = (hi << 4) | lo;
+    }
+    *addr = val;
+    return first + 17;
+  }
+
+  // write a string like "00:AA:11:BB:22:CC" of 17 chars to [first, last).
+  // returns the end of the string, or nullptr if the chars are too few.
+  char *toChars(char *const first, char *const last, const char sep = defaultSeparator()) const {
+    static const char digits[] = "0123456789ABCDEF";
+    if (last - first < 17) {
+      return nullptr;
+    }
+    for (int i = 0; i < 6; ++i) {
+      char *const octet = first + 3 * i;
+      octet[0] = digits[(*this)[i] >> 4];
+      octet[1] = digits[(*this)[i] & 0xF];
+      if (i < 5) {
+        octet[2] = sep;
+      }
+    }
+    return first + 17;
+  }
+
+  std::string toStr(const char sep = defaultSeparator()) const {
+    char str[17];
+    return std::string(str, toChars(str, str + sizeof(str), sep));
   }
 
   static char defaultSeparator() { return ':'; }
 
+  // pack octets into the lower 48 bits of an integer. the first octet will be the most significant.
+  std::uint64_t toInt() const {
+    std::uint64_t val = 0;
+    for (const std::uint8_t octet : *this) {
+      val = (val << 8) | octet;
+    }
+    return val;
+  }
+
+  static Address fromInt(std::uint64_t val) {
+    Address addr;
+    for (int i = 5; i >= 0; --i) {
+      addr[i] = val & 0xFF;
+      val >>= 8;
+    }
+    return addr;
+  }
+
 private:
-  // read a string like "00:AA:11:bb:22:Cc" or "0a-1B-2c-3D-4e-5F" from the given stream
-  virtual void read(std::istream &is) override {
+  friend class Readable<Address>;
+  friend class Writable<Address>;
+
+  // value of a hex digit, or -1 if it is not
+  static int hexDigit(const char c) {
+    return c >= '0' && c <= '9'   ? c - '0'
+           : c >= 'a' && c <= 'f' ? c - 'a' + 10
+           : c >= 'A' && c <= 'F' ? c - 'A' + 10
+                                  : -1;
+  }
+
+  // read a whitespace-separated token from the given stream and parse it by fromChars()
+  void read(std::istream &is) {
     std::string str;
     is >> str;
-    // sscanf returns number of items scanned, which is 6 on success
-    //   "%2hhx"   -> 2 chars (2) of hex (x) to uint8_t (hh)
-    //   "%*1[-:]" -> 1 char (1) of '-' or ':' to be ignored (*)
-    if (str.size() != 17 ||
-        std::sscanf(
-            str.c_str(), "%2hhx%*1[-:]%2hhx%*1[-:]%2hhx%*1[-:]%2hhx%*1[-:]%2hhx%*1[-:]%2hhx",
-            &(*this)[0], &(*this)[1], &(*this)[2], &(*this)[3], &(*this)[4], &(*this)[5]) != 6) {
+    if (!fromChars(str.data(), str.data() + str.size(), this)) {
       is.setstate(std::istream::failbit);
     }
   }
 
-  // write a string like "00:AA:11:BB:22:CC" to the given stream
-  virtual void write(std::ostream &os) const override { os << toStr(defaultSeparator()); }
+  void write(std::ostream &os) const {
+    char str[17];
+    os.write(str, toChars(str, str + sizeof(str)) - str);
+  }
 };
+
+// the I/O bases are empty, so an address is as large as its octets in containers
+static_assert(sizeof(Address) == 6, "Address must be packed in 6 octets");
 } // namespace mac_time_tracker
 
 #endif
\ No newline at end of file
@@ -1,6 +1,9 @@
 #ifndef MAC_TIME_TRACKER_ADDRESS_MAP_HPP
 #define MAC_TIME_TRACKER_ADDRESS_MAP_HPP
 
+#include <cstdint>
+#include <cctype>
+#include <cstdio>
 #include <iostream>
 #include <map>
 #include <stdexcept>
@@ -10,14 +13,18 @@
 #include <boost/lexical_cast.hpp>
 
 #include <mac_time_tracker/address.hpp>
+#include <mac_time_tracker/address_trie.hpp>
 #include <mac_time_tracker/csv.hpp>
 #include <mac_time_tracker/io.hpp>
 
 namespace mac_time_tracker {
 
+class AddressMapSnapshot;
+
 /////////////////////////////////////////////////////////////////////////////////////////
 // Map from MAC address to category (ex. owner's name) and description (ex. device type)
-// that is useful to represent known addresses
+// that is useful to represent known addresses.
+// also holds patterns (ex. OUIs) to categorize addresses that are not listed exactly.
 
 struct AddressMapTraits {
   struct Info {
@@ -33,6 +40,7 @@ private:
 
 public:
   using Info = AddressMapTraits::Info;
+  using Patterns = AddressTrie<Info>;
 
 public:
   // Constructors
@@ -40,7 +48,11 @@ public:
   AddressMap(const Base &base) : Base(base) {}
   AddressMap(Base &&base) : Base(base) {}
 
-  // Create an instance from a CSV, each line is '<address>, <category>, <description>'
+  // Create an instance from a CSV, each line is '<address>, <category>, <description>'.
+  // <address> can also be a pattern like
+  //   - '00:11:22:*' that matches addresses starting with the given octets
+  //   - '00:11:22:33:40:00/36' that matches addresses starting with the given 36 bits
+  //   - '02:00:00:00:00:00/02:00:00:00:00:00' that matches addresses with the masked bits
   static AddressMap fromCSV(const CSV &csv) {
     AddressMap map;
     for (std::size_t i = 0; i < csv.size(); ++i) {
@@ -52,10 +64,18 @@ public:
             boost::lexical_cast<std::string>(line.size()));
       }
       // boost::trim_copy() removes leading and trailing spaces
-      const Address addr = Address::fromStr(boost::trim_copy(line[0]));
+      const std::string key = boost::trim_copy(line[0]);
       const std::string category = boost::trim_copy(line[1]), desc = boost::trim_copy(line[2]);
-      if (!map.insert({addr, {category, desc}}).second) {
-        throw std::runtime_error("AddressMap::fromCSV(): Cannot insert an item {'" + addr.toStr() +
+      Address addr, mask;
+      if (!parsePattern(key, &addr, &mask)) {
+        addr = Address::fromStr(key);
+        mask = Address::fromInt(~std::uint64_t(0));
+      }
+      // exact addresses are stored in the base map so that the common case stays fast
+      if (!(mask == Address::fromInt(~std::uint64_t(0))
+                ? map.insert({addr, {category, desc}}).second
+                : map.patterns_.insert(addr, mask, {category, desc}))) {
+        throw std::runtime_error("AddressMap::fromCSV(): Cannot insert an item {'" + key +
                                  "', {'" + category + "', '" + desc +
                                  "'}}. Non-unique MAC address?");
       }
@@ -63,8 +83,68 @@ public:
     return map;
   }
 
+  // returns info of the exactly matching address or the most specific pattern,
+  // or nullptr if nothing matches
+  const Info *match(const Address &addr) const {
+    const const_iterator it = find(addr);
+    if (it != end()) {
+      return &it->second;
+    }
+    return patterns_.find(addr);
+  }
+
+  const Patterns &patterns() const { return patterns_; }
+
 private:
-  virtual void read(std::istream &is) override {
+  // parse a pattern like '00:11:22:*', '00:11:22:33:40:00/36' or '<address>/<mask>'.
+  // returns false if the string is not a pattern, or throws if the pattern is ill-formed.
+  static bool parsePattern(const std::string &str, Address *const addr, Address *const mask) {
+    const std::string::size_type slash = str.find('/');
+    if (slash != std::string::npos) {
+      *addr = Address::fromStr(str.substr(0, slash));
+      const std::string mask_str = str.substr(slash + 1);
+      unsigned int bits;
+      char trailing;
+      if (std::sscanf(mask_str.c_str(), "%u%c", &bits, &trailing) == 1) {
+        if (bits > 48) {
+          throw std::runtime_error("AddressMap::parsePattern(): Too long prefix in '" + str + "'");
+        }
+        *mask = Address::fromInt(bits == 0 ? 0 : ~std::uint64_t(0) << (48 - bits));
+      } else {
+        *mask = Address::fromStr(mask_str);
+      }
+    } else if (!str.empty() && str.back() == '*') {
+      // octets followed by a separator, i.e. "xx:" * n + "*"
+      const std::size_t n_octets = (str.size() - 1) / 3;
+      if (n_octets > 5 || str.size() != n_octets * 3 + 1) {
+        throw std::runtime_error("AddressMap::parsePattern(): Ill-formed pattern '" + str + "'");
+      }
+      std::uint64_t val = 0;
+      for (std::size_t i = 0; i < n_octets; ++i) {
+        unsigned int octet;
+        char hex[3] = {str[3 * i], str[3 * i + 1], '\0'}, sep = str[3 * i + 2], trailing;
+        if (std::sscanf(hex, "%2x%c", &octet, &trailing) != 1 || !std::isxdigit(hex[0]) ||
+            !std::isxdigit(hex[1]) || (sep != ':' && sep != '-')) {
+          throw std::runtime_error("AddressMap::parsePattern(): Ill-formed pattern '" + str +
+                                   "'");
+        }
+        val |= std::uint64_t(octet) << (40 - 8 * i);
+      }
+      *addr = Address::fromInt(val);
+      *mask = Address::fromInt(n_octets == 0 ? 0 : ~std::uint64_t(0) << (48 - 8 * n_octets));
+    } else {
+      return false;
+    }
+    if ((addr->toInt() & ~mask->toInt()) != 0) {
+      throw std::runtime_error("AddressMap::parsePattern(): Bits out of the mask are set in '" +
+                               str + "'");
+    }
+    return true;
+  }
+
+  friend class Readable<AddressMap>;
+
+  void read(std::istream &is) {
     CSV csv;
     is >> csv;
     try {
@@ -73,6 +153,10 @@ private:
       is.setstate(std::istream::failbit);
     }
   }
+
+private:
+  friend class AddressMapSnapshot; // to restore patterns
+  Patterns patterns_;
 };
 } // namespace mac_time_tracker
 
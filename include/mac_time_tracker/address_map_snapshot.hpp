@@ -0,0 +1,246 @@
+#ifndef MAC_TIME_TRACKER_ADDRESS_MAP_SNAPSHOT_HPP
+#define MAC_TIME_TRACKER_ADDRESS_MAP_SNAPSHOT_HPP
+
+#include <algorithm> // for std::copy()
+#include <cstdint>
+#include <cstdio> // for std::rename(), std::remove()
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <utility> // for std::move()
+#include <vector>
+
+#include <sys/stat.h> // for stat()
+
+#include <mac_time_tracker/address.hpp>
+#include <mac_time_tracker/address_map.hpp>
+#include <mac_time_tracker/mapped_file.hpp>
+
+namespace mac_time_tracker {
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+// Binary snapshot of an AddressMap that is loaded without parsing the source CSV.
+// the snapshot records the size, identity, modification time and hash of the source
+// and is stale if the size or the hash differs. the hash is skipped if the identity and
+// the modification time are same, and the source is older than the snapshot
+// (otherwise the source may have been rewritten within the resolution of timestamps).
+// layout (native byte order, which is checked on load);
+//   - Header
+//   - Record * n_exacts, sorted by address
+//   - Record * n_patterns, in the inserted order
+//   - characters of categories and descriptions referred by the records
+
+class AddressMapSnapshot {
+public:
+  // the source file of a snapshot
+  struct Source {
+    std::uint64_t size;
+    std::uint64_t device;
+    std::uint64_t inode;
+    std::int64_t mtime_sec;
+    std::int64_t mtime_nsec;
+    std::uint64_t hash; // FNV-1a of the contents
+  };
+
+public:
+  // returns the map in the CSV, loaded via the snapshot if it is fresh.
+  // otherwise parses the CSV and (re)writes the snapshot.
+  // the snapshot is only a cache, so a failure to write it is not an error of this
+  // but is reported to save_error if given (empty if written or not needed).
+  static AddressMap fromFile(const std::string &csv_filename,
+                             const std::string &snapshot_filename,
+                             std::string *const save_error = nullptr) {
+    if (save_error) {
+      save_error->clear();
+    }
+    AddressMap map;
+    if (load(snapshot_filename, csv_filename, &map)) {
+      return map;
+    }
+    // take the source before parsing so that a modification meanwhile makes the snapshot stale
+    const Source source = sourceOf(csv_filename);
+    map = AddressMap::fromFile(csv_filename);
+    try {
+      save(map, source, snapshot_filename);
+    } catch (const std::runtime_error &err) {
+      if (save_error) {
+        *save_error = err.what();
+      }
+    }
+    return map;
+  }
+
+  // returns false if the snapshot does not exist, is broken or is stale
+  static bool load(const std::string &snapshot_filename, const std::string &csv_filename,
+                   AddressMap *const map) {
+    MappedFile file(snapshot_filename);
+    if (!file.data || file.size < sizeof(Header)) {
+      return false;
+    }
+    Header header;
+    std::memcpy(&header, file.data, sizeof(Header));
+    if (std::memcmp(header.magic, magic(), sizeof(header.magic)) != 0 ||
+        header.version != version() || header.byte_order != byteOrder() ||
+        header.n_exacts + header.n_patterns > file.size / sizeof(Record) ||
+        file.size != sizeof(Header) + (header.n_exacts + header.n_patterns) * sizeof(Record) +
+                         header.strings_size) {
+      return false;
+    }
+
+    // the source must be the same
+    struct stat st;
+    if (::stat(csv_filename.c_str(), &st) != 0 ||
+        std::uint64_t(st.st_size) != header.source.size) {
+      return false;
+    }
+    const bool unchanged = std::uint64_t(st.st_dev) == header.source.device &&
+                           std::uint64_t(st.st_ino) == header.source.inode &&
+                           st.st_mtim.tv_sec == header.source.mtime_sec &&
+                           st.st_mtim.tv_nsec == header.source.mtime_nsec &&
+                           st.st_mtim.tv_sec < file.mtime.tv_sec;
+    if (!unchanged && hashOf(csv_filename) != header.source.hash) {
+      return false;
+    }
+
+    // build the map. exact addresses are sorted so hinted insertions take constant time.
+    const Record *const records = reinterpret_cast<const Record *>(file.data + sizeof(Header));
+    const char *const strings =
+        file.data + sizeof(Header) + (header.n_exacts + header.n_patterns) * sizeof(Record);
+    for (const Record *rec = records; rec != records + header.n_exacts + header.n_patterns;
+         ++rec) {
+      if (std::uint64_t(rec->category_offset) + rec->category_size > header.strings_size ||
+          std::uint64_t(rec->description_offset) + rec->description_size > header.strings_size) {
+        return false;
+      }
+    }
+    AddressMap loaded;
+    for (const Record *rec = records; rec != records + header.n_exacts; ++rec) {
+      loaded.insert(loaded.end(), {unpack(rec->address), infoOf(*rec, strings)});
+    }
+    for (const Record *rec = records + header.n_exacts;
+         rec != records + header.n_exacts + header.n_patterns; ++rec) {
+      loaded.patterns_.insert(unpack(rec->address), unpack(rec->mask), infoOf(*rec, strings));
+    }
+    *map = std::move(loaded);
+    return true;
+  }
+
+  // write the snapshot via a temporary file so that readers never see a partial one
+  static void save(const AddressMap &map, const Source &source,
+                   const std::string &snapshot_filename) {
+    std::vector<Record> records;
+    std::string strings;
+    for (const AddressMap::value_type &entry : map) {
+      records.push_back(recordOf(entry.first, Address::fromInt(~std::uint64_t(0)), entry.second,
+                                 &strings));
+    }
+    for (const AddressMap::Patterns::Rule &rule : map.patterns()) {
+      records.push_back(recordOf(rule.value, rule.mask, rule.item, &strings));
+    }
+    Header header;
+    std::memcpy(header.magic, magic(), sizeof(header.magic));
+    header.version = version();
+    header.byte_order = byteOrder();
+    header.source = source;
+    header.n_exacts = map.size();
+    header.n_patterns = map.patterns().size();
+    header.strings_size = strings.size();
+
+    const std::string temp_filename = snapshot_filename + ".tmp";
+    {
+      std::ofstream ofs(temp_filename, std::ios::binary);
+      ofs.write(reinterpret_cast<const char *>(&header), sizeof(header));
+      ofs.write(reinterpret_cast<const char *>(records.data()), records.size() * sizeof(Record));
+      ofs.write(strings.data(), strings.size());
+      if (!ofs) {
+        std::remove(temp_filename.c_str());
+        throw std::runtime_error("AddressMapSnapshot::save(): Cannot write to '" +
+                                 temp_filename + "'");
+      }
+    }
+    if (std::rename(temp_filename.c_str(), snapshot_filename.c_str()) != 0) {
+      std::remove(temp_filename.c_str());
+      throw std::runtime_error("AddressMapSnapshot::save(): Cannot rename '" + temp_filename +
+                               "' to '" + snapshot_filename + "'");
+    }
+  }
+
+  static Source sourceOf(const std::string &csv_filename) {
+    struct stat st;
+    if (::stat(csv_filename.c_str(), &st) != 0) {
+      throw std::runtime_error("AddressMapSnapshot::sourceOf(): Cannot stat '" + csv_filename +
+                               "'");
+    }
+    return {std::uint64_t(st.st_size), std::uint64_t(st.st_dev), std::uint64_t(st.st_ino),
+            st.st_mtim.tv_sec, st.st_mtim.tv_nsec, hashOf(csv_filename)};
+  }
+
+  // 64-bit FNV-1a of the contents of a file
+  static std::uint64_t hashOf(const std::string &filename) {
+    std::ifstream ifs(filename, std::ios::binary);
+    if (!ifs) {
+      throw std::runtime_error("AddressMapSnapshot::hashOf(): Cannot open '" + filename + "'");
+    }
+    std::uint64_t hash = 0xCBF29CE484222325ull;
+    char buf[1 << 16];
+    while (ifs.read(buf, sizeof(buf)) || ifs.gcount() > 0) {
+      for (std::streamsize i = 0; i < ifs.gcount(); ++i) {
+        hash = (hash ^ static_cast<unsigned char>(buf[i])) * 0x100000001B3ull;
+      }
+    }
+    return hash;
+  }
+
+  // bump this when the layout changes
+  static std::uint32_t version() { return 1; }
+
+private:
+  struct Header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byte_order;
+    Source source;
+    std::uint64_t n_exacts;
+    std::uint64_t n_patterns;
+    std::uint64_t strings_size;
+  };
+
+  struct Record {
+    std::uint8_t address[6];
+    std::uint8_t mask[6];
+    std::uint32_t category_offset; // in the strings
+    std::uint32_t category_size;
+    std::uint32_t description_offset;
+    std::uint32_t description_size;
+  };
+
+  static const char *magic() { return "MTTAMSS"; } // 7 chars + '\0'
+  static std::uint32_t byteOrder() { return 0x01020304; }
+
+  static Record recordOf(const Address &addr, const Address &mask, const AddressMap::Info &info,
+                         std::string *const strings) {
+    Record rec;
+    std::copy(addr.begin(), addr.end(), rec.address);
+    std::copy(mask.begin(), mask.end(), rec.mask);
+    rec.category_offset = strings->size();
+    rec.category_size = info.category.size();
+    *strings += info.category;
+    rec.description_offset = strings->size();
+    rec.description_size = info.description.size();
+    *strings += info.description;
+    return rec;
+  }
+
+  static Address unpack(const std::uint8_t (&octets)[6]) {
+    return Address(octets[0], octets[1], octets[2], octets[3], octets[4], octets[5]);
+  }
+
+  static AddressMap::Info infoOf(const Record &rec, const char *const strings) {
+    return {std::string(strings + rec.category_offset, rec.category_size),
+            std::string(strings + rec.description_offset, rec.description_size)};
+  }
+};
+} // namespace mac_time_tracker
+
+#endif
@@ -0,0 +1,133 @@
+#ifndef MAC_TIME_TRACKER_ADDRESS_SCANNER_HPP
+#define MAC_TIME_TRACKER_ADDRESS_SCANNER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <mac_time_tracker/address.hpp>
+#include <mac_time_tracker/bit_kernels.hpp> // for hasAVX2() and MAC_TIME_TRACKER_WITH_AVX2
+
+namespace mac_time_tracker {
+
+/////////////////////////////////////////////////////////////////////////////////////////
+// Scanner of MAC addresses like "00:aa:11:BB:22:cc" or "00-AA-11-bb-22-CC" in a text buffer
+// (ex. output of arp-scan). finds the same addresses as
+//   grep --only-matching '\([0-9a-fA-F]\{2\}[-:]\)\{5\}\([0-9a-fA-F]\{2\}\)'
+// i.e. the leftmost non-overlapping matches, ignoring surrounding chars.
+// bytes are classified into bit masks of hex digits and separators per 64-byte window,
+// with AVX2 if available, and all candidate positions of a window are found by shifts
+// and ands of the masks.
+
+struct AddressScanner {
+  // write addresses found in [first, last) to out. returns the end of the output.
+  template <class OutputIterator>
+  static OutputIterator scan(const char *const first, const char *const last, OutputIterator out,
+                             const bool simd = BitKernels::hasAVX2()) {
+    forEachMatch(first, last, simd, [&out](const char *const match) { *out++ = decode(match); });
+    return out;
+  }
+
+  // write the beginnings of addresses found in [first, last) to out.
+  // returns the end of the output.
+  template <class OutputIterator>
+  static OutputIterator find(const char *const first, const char *const last, OutputIterator out,
+                             const bool simd = BitKernels::hasAVX2()) {
+    forEachMatch(first, last, simd, [&out](const char *const match) { *out++ = match; });
+    return out;
+  }
+
+  // number of chars of an address
+  static constexpr std::size_t length() { return 17; }
+
+  // address of 17 chars at str which must be a match of scan()
+  static Address decode(const char *const str) {
+    Address addr;
+    for (int i = 0; i < 6; ++i) {
+      addr[i] = (hexValue(str[3 * i]) << 4) | hexValue(str[3 * i + 1]);
+    }
+    return addr;
+  }
+
+private:
+  template <class Function>
+  static void forEachMatch(const char *const first, const char *const last, const bool simd,
+                           const Function &func) {
+    // matches starting before a window ends within the window
+    static const std::size_t window = 64, stride = window - (length() - 1);
+    const char *next = first; // the beginning of the next match must not be before this
+    for (const char *pos = first; pos < last; pos += stride) {
+      std::uint64_t hex, sep;
+      if (last - pos >= std::ptrdiff_t(window)) {
+        classify(pos, &hex, &sep, simd);
+      } else {
+        // zeros are neither hex digits nor separators
+        char padded[window] = {};
+        std::memcpy(padded, pos, last - pos);
+        classify(padded, &hex, &sep, simd);
+      }
+      for (std::uint64_t cands = candidates(hex, sep) & ((std::uint64_t(1) << stride) - 1);
+           cands != 0; cands &= cands - 1) {
+        const char *const match = pos + __builtin_ctzll(cands);
+        if (match >= next) {
+          func(match);
+          next = match + length();
+        }
+      }
+    }
+  }
+
+  // value of a char which is known to be a hex digit. the 7th bit is set only on letters.
+  static std::uint8_t hexValue(const char c) { return (c & 0xF) + 9 * ((c >> 6) & 1); }
+
+  // bit i of the result is set if a match begins at the i-th byte, given masks of
+  // hex digits and separators of bytes
+  static std::uint64_t candidates(const std::uint64_t hex, const std::uint64_t sep) {
+    const std::uint64_t octet = hex & (hex >> 1);        // "xx"
+    const std::uint64_t octet_sep = octet & (sep >> 2); // "xx:"
+    return octet_sep & (octet_sep >> 3) & (octet_sep >> 6) & (octet_sep >> 9) &
+           (octet_sep >> 12) & (octet >> 15);
+  }
+
+  // masks of hex digits and separators of 64 bytes from str
+  static void classify(const char *const str, std::uint64_t *const hex, std::uint64_t *const sep,
+                       const bool simd) {
+#ifdef MAC_TIME_TRACKER_WITH_AVX2
+    if (simd) {
+      classifyAVX2(str, hex, sep);
+      return;
+    }
+#endif
+    *hex = *sep = 0;
+    for (int i = 0; i < 64; ++i) {
+      const char c = str[i], lower = c | 0x20;
+      *hex |= std::uint64_t((c >= '0' && c <= '9') || (lower >= 'a' && lower <= 'f')) << i;
+      *sep |= std::uint64_t(c == ':' || c == '-') << i;
+    }
+  }
+
+#ifdef MAC_TIME_TRACKER_WITH_AVX2
+  // bytes out of ASCII are negative as signed chars, so never in the ranges
+  __attribute__((target("avx2"))) static void
+  classifyAVX2(const char *const str, std::uint64_t *const hex, std::uint64_t *const sep) {
+    *hex = *sep = 0;
+    for (int half = 0; half < 2; ++half) {
+      const __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(str + 32 * half));
+      const __m256i lower = _mm256_or_si256(c, _mm256_set1_epi8(0x20));
+      const __m256i digit = _mm256_and_si256(_mm256_cmpgt_epi8(c, _mm256_set1_epi8('0' - 1)),
+                                             _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), c));
+      const __m256i letter =
+          _mm256_and_si256(_mm256_cmpgt_epi8(lower, _mm256_set1_epi8('a' - 1)),
+                           _mm256_cmpgt_epi8(_mm256_set1_epi8('f' + 1), lower));
+      const __m256i separator = _mm256_or_si256(_mm256_cmpeq_epi8(c, _mm256_set1_epi8(':')),
+                                                _mm256_cmpeq_epi8(c, _mm256_set1_epi8('-')));
+      *hex |= std::uint64_t(std::uint32_t(_mm256_movemask_epi8(_mm256_or_si256(digit, letter))))
+              << (32 * half);
+      *sep |= std::uint64_t(std::uint32_t(_mm256_movemask_epi8(separator))) << (32 * half);
+    }
+  }
+#endif
+};
+} // namespace mac_time_tracker
+
+#endif
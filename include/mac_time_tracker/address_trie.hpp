@@ -0,0 +1,110 @@
+#ifndef MAC_TIME_TRACKER_ADDRESS_TRIE_HPP
+#define MAC_TIME_TRACKER_ADDRESS_TRIE_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include <mac_time_tracker/address.hpp>
+
+namespace mac_time_tracker {
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Map from MAC address pattern (value/mask) to item that finds the most specific pattern
+// (i.e. the one having the most bits in its mask) matching to a given address.
+// patterns are stored in a binary trie over 48 bits from the most significant one,
+// where a bit out of the mask follows the 'any' edge instead of the '0' or '1' edge.
+// so prefix patterns (ex. 00:11:22:00:00:00/24) are looked up by a single walk
+// and non-prefix masks (ex. the locally administered bit) only add a few branches.
+
+template <class T> class AddressTrie {
+public:
+  struct Rule {
+    Address value;
+    Address mask;
+    T item;
+  };
+  using const_iterator = typename std::vector<Rule>::const_iterator;
+
+public:
+  AddressTrie() : nodes_(1) {}
+
+  // returns false if the same pattern already exists
+  bool insert(const Address &value, const Address &mask, const T &item) {
+    const std::uint64_t val = value.toInt(), msk = mask.toInt();
+    std::uint32_t node = 0;
+    for (int bit = 47; bit >= 0 && (msk & ((std::uint64_t(1) << (bit + 1)) - 1)) != 0; --bit) {
+      const int edge = (msk >> bit) & 1 ? int((val >> bit) & 1) : static_cast<int>(ANY);
+      if (nodes_[node].children[edge] == NONE) {
+        nodes_[node].children[edge] = nodes_.size();
+        nodes_.push_back(Node());
+      }
+      node = nodes_[node].children[edge];
+    }
+    if (nodes_[node].rule != NONE) {
+      return false;
+    }
+    nodes_[node].rule = rules_.size();
+    rules_.push_back({Address::fromInt(val & msk), mask, item});
+    return true;
+  }
+
+  // returns the item of the most specific pattern matching to the given address,
+  // or nullptr if nothing matches. the earlier inserted one wins if equally specific.
+  const T *find(const Address &addr) const {
+    const std::uint64_t val = addr.toInt();
+    const Rule *best = nullptr;
+    int best_bits = -1;
+    // depth-first search. the stack grows by at most one per bit.
+    struct Visit {
+      std::uint32_t node;
+      int bit;
+    } stack[64];
+    int size = 0;
+    stack[size++] = {0, 47};
+    while (size > 0) {
+      const Visit visit = stack[--size];
+      const Node &node = nodes_[visit.node];
+      if (node.rule != NONE) {
+        const Rule &rule = rules_[node.rule];
+        const int bits = __builtin_popcountll(rule.mask.toInt());
+        if (bits > best_bits || (bits == best_bits && &rule < best)) {
+          best = &rule;
+          best_bits = bits;
+        }
+      }
+      if (visit.bit < 0) {
+        continue;
+      }
+      const std::uint32_t exact = node.children[(val >> visit.bit) & 1], any = node.children[ANY];
+      if (any != NONE) {
+        stack[size++] = {any, visit.bit - 1};
+      }
+      if (exact != NONE) {
+        stack[size++] = {exact, visit.bit - 1};
+      }
+    }
+    return best ? &best->item : nullptr;
+  }
+
+  // iterate patterns in the inserted order
+  const_iterator begin() const { return rules_.begin(); }
+  const_iterator end() const { return rules_.end(); }
+  std::size_t size() const { return rules_.size(); }
+  bool empty() const { return rules_.empty(); }
+
+private:
+  enum : std::uint32_t { ANY = 2, NONE = 0xFFFFFFFF };
+
+  struct Node {
+    Node() : rule(NONE) { children[0] = children[1] = children[ANY] = NONE; }
+    std::uint32_t children[3]; // indices of nodes_ following '0', '1' and 'any' edges
+    std::uint32_t rule;        // index of rules_
+  };
+
+private:
+  std::vector<Node> nodes_; // the first one is the root
+  std::vector<Rule> rules_;
+};
+} // namespace mac_time_tracker
+
+#endif
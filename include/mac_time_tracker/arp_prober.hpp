@@ -0,0 +1,283 @@
+#ifndef MAC_TIME_TRACKER_ARP_PROBER_HPP
+#define MAC_TIME_TRACKER_ARP_PROBER_HPP
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <arpa/inet.h>       // for htons(), ntohs()
+#include <linux/if_ether.h>  // for ETH_P_ARP, ETH_P_IP
+#include <linux/if_packet.h> // for sockaddr_ll
+#include <net/if.h>          // for ifreq
+#include <netinet/in.h>      // for sockaddr_in
+#include <poll.h>            // for poll()
+#include <sys/ioctl.h>       // for ioctl()
+#include <sys/socket.h>      // for socket(), sendto(), recv()
+#include <unistd.h>          // for close()
+
+#include <mac_time_tracker/address.hpp>
+#include <mac_time_tracker/address_map.hpp>
+#include <mac_time_tracker/set.hpp>
+#include <mac_time_tracker/time.hpp>
+
+namespace mac_time_tracker {
+
+////////////////////////////////////////////////////////////////////////////////////////
+// Alternative to arp-scan that sends ARP requests over a raw socket (CAP_NET_RAW required).
+// remembers the last IPv4 address of each responder so that a scan probes only
+// the last addresses of known devices, which takes a round trip instead of a sweep.
+// sweeps the whole subnet of the interface on the first scan and every sweep interval
+// to discover new or moved devices.
+// IPv4 addresses are in the host byte order.
+
+class ArpProber {
+public:
+  using Frame = std::array<std::uint8_t, 42>; // ethernet header (14) + ARP (28)
+
+public:
+  // deadline: maximum time for a scan, in which unanswered requests are sent twice
+  ArpProber(const std::string &interface, const std::chrono::milliseconds &deadline,
+            const std::chrono::minutes &sweep_interval)
+      : deadline_(deadline), sweep_interval_(sweep_interval), swept_(false) {
+    fd_ = ::socket(AF_PACKET, SOCK_RAW | SOCK_NONBLOCK, htons(ETH_P_ARP));
+    if (fd_ < 0) {
+      throw std::runtime_error("ArpProber::ArpProber(): Cannot open a raw socket: " +
+                               std::string(std::strerror(errno)));
+    }
+    try {
+      ifreq ifr;
+      if (interface.size() >= sizeof(ifr.ifr_name)) {
+        throw std::runtime_error("ArpProber::ArpProber(): Too long interface name '" +
+                                 interface + "'");
+      }
+      ioctlInterface(interface, SIOCGIFINDEX, &ifr);
+      ifindex_ = ifr.ifr_ifindex;
+      ioctlInterface(interface, SIOCGIFHWADDR, &ifr);
+      std::copy(ifr.ifr_hwaddr.sa_data, ifr.ifr_hwaddr.sa_data + 6, mac_.begin());
+      ioctlInterface(interface, SIOCGIFADDR, &ifr);
+      ip_ = ntohl(reinterpret_cast<const sockaddr_in *>(&ifr.ifr_addr)->sin_addr.s_addr);
+      ioctlInterface(interface, SIOCGIFNETMASK, &ifr);
+      netmask_ = ntohl(reinterpret_cast<const sockaddr_in *>(&ifr.ifr_netmask)->sin_addr.s_addr);
+
+      sockaddr_ll sll = {};
+      sll.sll_family = AF_PACKET;
+      sll.sll_protocol = htons(ETH_P_ARP);
+      sll.sll_ifindex = ifindex_;
+      if (::bind(fd_, reinterpret_cast<const sockaddr *>(&sll), sizeof(sll)) != 0) {
+        throw std::runtime_error("ArpProber::ArpProber(): Cannot bind to '" + interface +
+                                 "': " + std::strerror(errno));
+      }
+      // replies of a sweep arrive in a burst
+      const int rcvbuf = 1 << 20;
+      ::setsockopt(fd_, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    } catch (...) {
+      ::close(fd_);
+      throw;
+    }
+  }
+
+  ~ArpProber() { ::close(fd_); }
+
+  ArpProber(const ArpProber &) = delete;
+  ArpProber &operator=(const ArpProber &) = delete;
+
+  // probe the last IPs of the known addresses, or sweep the subnet if it is the time
+  Set scan(const AddressMap &known, const Time &now) {
+    if (!swept_ || now - last_sweep_ >= sweep_interval_) {
+      swept_ = true;
+      last_sweep_ = now;
+      return probe(hostsOf(ip_, netmask_));
+    }
+    std::vector<std::uint32_t> ips;
+    for (const std::pair<const Address, std::uint32_t> &last_ip : last_ips_) {
+      if (known.match(last_ip.first)) {
+        ips.push_back(last_ip.second);
+      }
+    }
+    return probe(ips);
+  }
+
+  // send requests to the given IPs and returns addresses that replied until the deadline
+  Set probe(const std::vector<std::uint32_t> &ips) {
+    namespace sc = std::chrono;
+    Set found;
+    std::set<std::uint32_t> pending(ips.begin(), ips.end());
+    pending.erase(ip_);
+    const sc::steady_clock::time_point start = sc::steady_clock::now();
+    for (int attempt = 0; attempt < 2 && !pending.empty(); ++attempt) {
+      // the first attempt takes a half of the deadline and the retry takes the rest
+      const sc::steady_clock::time_point attempt_end = start + deadline_ * (attempt + 1) / 2;
+      const std::vector<std::uint32_t> targets(pending.begin(), pending.end());
+      std::size_t n_sent = 0;
+      while (!pending.empty()) {
+        const sc::steady_clock::time_point now = sc::steady_clock::now();
+        if (now >= attempt_end) {
+          break;
+        }
+        pollfd pfd = {fd_, static_cast<short>(POLLIN | (n_sent < targets.size() ? POLLOUT : 0)),
+                      0};
+        const int timeout_ms =
+            sc::duration_cast<sc::milliseconds>(attempt_end - now + sc::milliseconds(1)).count();
+        if (::poll(&pfd, 1, timeout_ms) < 0 && errno != EINTR) {
+          throw std::runtime_error("ArpProber::probe(): poll: " +
+                                   std::string(std::strerror(errno)));
+        }
+        if (pfd.revents & POLLIN) {
+          receive(&found, &pending);
+        }
+        if (pfd.revents & POLLOUT) {
+          n_sent += send(targets.data() + n_sent, targets.size() - n_sent);
+        }
+      }
+    }
+    return found;
+  }
+
+  // the last IP of each address that has replied
+  const std::map<Address, std::uint32_t> &lastIPs() const { return last_ips_; }
+  const Address &address() const { return mac_; }
+  std::uint32_t ip() const { return ip_; }
+  std::uint32_t netmask() const { return netmask_; }
+
+  // an ARP request that asks target_ip from (src_mac, src_ip), as a broadcast ethernet frame
+  static Frame makeRequest(const Address &src_mac, const std::uint32_t src_ip,
+                           const std::uint32_t target_ip) {
+    Frame frame = {};
+    std::uint8_t *p = frame.data();
+    std::fill(p, p + 6, 0xFF);                            // ethernet destination: broadcast
+    p = std::copy(src_mac.begin(), src_mac.end(), p + 6); // ethernet source
+    p = put16(p, ETH_P_ARP);                              // ethertype
+    p = put16(p, 1);                                      // hardware type: ethernet
+    p = put16(p, ETH_P_IP);                               // protocol type: IPv4
+    *p++ = 6;                                             // hardware address length
+    *p++ = 4;                                             // protocol address length
+    p = put16(p, 1);                                      // operation: request
+    p = std::copy(src_mac.begin(), src_mac.end(), p);     // sender hardware address
+    p = put32(p, src_ip);                                 // sender protocol address
+    p += 6;                                               // target hardware address: unknown
+    put32(p, target_ip);                                  // target protocol address
+    return frame;
+  }
+
+  // parse an ethernet frame as an ARP reply. returns false if it is not.
+  static bool parseReply(const std::uint8_t *const frame, const std::size_t size,
+                         Address *const sender_mac, std::uint32_t *const sender_ip) {
+    if (size < std::tuple_size<Frame>::value || get16(frame + 12) != ETH_P_ARP ||
+        get16(frame + 14) != 1 || get16(frame + 16) != ETH_P_IP || frame[18] != 6 ||
+        frame[19] != 4 || get16(frame + 20) != 2) {
+      return false;
+    }
+    std::copy(frame + 22, frame + 28, sender_mac->begin());
+    *sender_ip = get32(frame + 28);
+    return true;
+  }
+
+  // host addresses in the subnet, i.e. except the network and broadcast addresses.
+  // throws if the subnet is larger than /16.
+  static std::vector<std::uint32_t> hostsOf(const std::uint32_t ip, const std::uint32_t netmask) {
+    if (~netmask > 0xFFFF) {
+      throw std::runtime_error("ArpProber::hostsOf(): Too large subnet to sweep");
+    }
+    std::vector<std::uint32_t> hosts;
+    const std::uint32_t network = ip & netmask, broadcast = network | ~netmask;
+    for (std::uint32_t host = network + 1; host < broadcast; ++host) {
+      hosts.push_back(host);
+    }
+    // a /31 or /32 has no network or broadcast address
+    if (hosts.empty()) {
+      hosts.push_back(ip);
+    }
+    return hosts;
+  }
+
+private:
+  void ioctlInterface(const std::string &interface, const unsigned long request,
+                      ifreq *const ifr) const {
+    std::memset(ifr, 0, sizeof(*ifr));
+    std::strncpy(ifr->ifr_name, interface.c_str(), sizeof(ifr->ifr_name) - 1);
+    if (::ioctl(fd_, request, ifr) != 0) {
+      throw std::runtime_error("ArpProber::ioctlInterface(): Cannot get properties of '" +
+                               interface + "': " + std::strerror(errno));
+    }
+  }
+
+  // send requests as many as possible without blocking. returns the number sent.
+  std::size_t send(const std::uint32_t *const ips, const std::size_t n_ips) {
+    sockaddr_ll sll = {};
+    sll.sll_family = AF_PACKET;
+    sll.sll_protocol = htons(ETH_P_ARP);
+    sll.sll_ifindex = ifindex_;
+    sll.sll_halen = 6;
+    std::fill(sll.sll_addr, sll.sll_addr + 6, 0xFF);
+    std::size_t n_sent = 0;
+    for (; n_sent < n_ips; ++n_sent) {
+      const Frame frame = makeRequest(mac_, ip_, ips[n_sent]);
+      if (::sendto(fd_, frame.data(), frame.size(), 0, reinterpret_cast<const sockaddr *>(&sll),
+                   sizeof(sll)) < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS) {
+          break;
+        }
+        throw std::runtime_error("ArpProber::send(): sendto: " +
+                                 std::string(std::strerror(errno)));
+      }
+    }
+    return n_sent;
+  }
+
+  // receive all frames available without blocking
+  void receive(Set *const found, std::set<std::uint32_t> *const pending) {
+    std::uint8_t buf[1536];
+    while (true) {
+      const ssize_t size = ::recv(fd_, buf, sizeof(buf), MSG_DONTWAIT);
+      if (size < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+          return;
+        }
+        throw std::runtime_error("ArpProber::receive(): recv: " +
+                                 std::string(std::strerror(errno)));
+      }
+      Address mac;
+      std::uint32_t ip;
+      if (parseReply(buf, size, &mac, &ip) && !(mac == mac_)) {
+        found->insert(mac);
+        last_ips_[mac] = ip;
+        pending->erase(ip);
+      }
+    }
+  }
+
+  static std::uint8_t *put16(std::uint8_t *const p, const std::uint16_t val) {
+    p[0] = val >> 8;
+    p[1] = val & 0xFF;
+    return p + 2;
+  }
+  static std::uint8_t *put32(std::uint8_t *const p, const std::uint32_t val) {
+    return put16(put16(p, val >> 16), val & 0xFFFF);
+  }
+  static std::uint16_t get16(const std::uint8_t *const p) { return (p[0] << 8) | p[1]; }
+  static std::uint32_t get32(const std::uint8_t *const p) {
+    return (std::uint32_t(get16(p)) << 16) | get16(p + 2);
+  }
+
+private:
+  int fd_;
+  int ifindex_;
+  Address mac_;
+  std::uint32_t ip_, netmask_;
+  std::chrono::milliseconds deadline_;
+  std::chrono::minutes sweep_interval_;
+  bool swept_;
+  Time last_sweep_;
+  std::map<Address, std::uint32_t> last_ips_;
+};
+} // namespace mac_time_tracker
+
+#endif
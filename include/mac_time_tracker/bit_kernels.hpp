@@ -0,0 +1,175 @@
+#ifndef MAC_TIME_TRACKER_BIT_KERNELS_HPP
+#define MAC_TIME_TRACKER_BIT_KERNELS_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define MAC_TIME_TRACKER_WITH_AVX2
+#include <immintrin.h>
+#endif
+
+namespace mac_time_tracker {
+
+/////////////////////////////////////////////////////////////////////////////////////////
+// Kernels on arrays of 64-bit words where bit i of a bit vector is (i % 64) of word (i / 64).
+// each kernel has a scalar version and an AVX2 version which is compiled by the target
+// attribute without -mavx2 and is chosen at runtime if the CPU supports it.
+// bits out of arrays are 0.
+
+struct BitKernels {
+  // true if the AVX2 versions are available on this CPU
+  static bool hasAVX2() {
+#ifdef MAC_TIME_TRACKER_WITH_AVX2
+    static const bool has_avx2 = __builtin_cpu_supports("avx2");
+    return has_avx2;
+#else
+    return false;
+#endif
+  }
+
+  // number of set bits in words[0, n)
+  static std::uint64_t popcount(const std::uint64_t *const words, const std::size_t n,
+                                const bool simd = hasAVX2()) {
+#ifdef MAC_TIME_TRACKER_WITH_AVX2
+    if (simd) {
+      return popcountAVX2(words, nullptr, n);
+    }
+#endif
+    std::uint64_t count = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+      count += popcount64(words[i]);
+    }
+    return count;
+  }
+
+  // number of bits set in both a[0, n) and b[0, n)
+  static std::uint64_t popcountAnd(const std::uint64_t *const a, const std::uint64_t *const b,
+                                   const std::size_t n, const bool simd = hasAVX2()) {
+#ifdef MAC_TIME_TRACKER_WITH_AVX2
+    if (simd) {
+      return popcountAVX2(a, b, n);
+    }
+#endif
+    std::uint64_t count = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+      count += popcount64(a[i] & b[i]);
+    }
+    return count;
+  }
+
+  // dst = src | (src << shift) (towards higher bits) on n words.
+  // dst and src must not overlap.
+  static void orShiftedUp(std::uint64_t *const dst, const std::uint64_t *const src,
+                          const std::size_t n, const std::size_t shift,
+                          const bool simd = hasAVX2()) {
+    const std::size_t q = shift / 64, r = shift % 64;
+    std::size_t i = std::min(q + 1, n); // words that read src[-1] or before
+    for (std::size_t j = 0; j < i; ++j) {
+      dst[j] = src[j] | (j == q ? src[0] << r : 0);
+    }
+#ifdef MAC_TIME_TRACKER_WITH_AVX2
+    if (simd) {
+      i = orShiftedUpAVX2(dst, src, n, q, r, i);
+    }
+#endif
+    for (; i < n; ++i) {
+      dst[i] = src[i] | (src[i - q] << r) | (r > 0 ? src[i - q - 1] >> (64 - r) : 0);
+    }
+  }
+
+  // dst = src & (src >> shift) (towards lower bits) on n words.
+  // dst and src must not overlap.
+  static void andShiftedDown(std::uint64_t *const dst, const std::uint64_t *const src,
+                             const std::size_t n, const std::size_t shift,
+                             const bool simd = hasAVX2()) {
+    const std::size_t q = shift / 64, r = shift % 64;
+    std::size_t i = 0;
+#ifdef MAC_TIME_TRACKER_WITH_AVX2
+    if (simd) {
+      i = andShiftedDownAVX2(dst, src, n, q, r);
+    }
+#endif
+    for (; i < n; ++i) {
+      const std::uint64_t lo = i + q < n ? src[i + q] >> r : 0;
+      const std::uint64_t hi = r > 0 && i + q + 1 < n ? src[i + q + 1] << (64 - r) : 0;
+      dst[i] = src[i] & (lo | hi);
+    }
+  }
+
+  static unsigned int popcount64(const std::uint64_t word) { return __builtin_popcountll(word); }
+
+private:
+#ifdef MAC_TIME_TRACKER_WITH_AVX2
+  // popcount by nibble lookups with pshufb, summed up by psadbw.
+  // counts bits of a & b if b is not nullptr.
+  __attribute__((target("avx2"))) static std::uint64_t
+  popcountAVX2(const std::uint64_t *const a, const std::uint64_t *const b, const std::size_t n) {
+    const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, //
+                                            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low_mask = _mm256_set1_epi8(0x0F);
+    __m256i sums = _mm256_setzero_si256();
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+      __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+      if (b) {
+        v = _mm256_and_si256(v, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i)));
+      }
+      const __m256i lo = _mm256_and_si256(v, low_mask);
+      const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask);
+      const __m256i counts =
+          _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo), _mm256_shuffle_epi8(lookup, hi));
+      sums = _mm256_add_epi64(sums, _mm256_sad_epu8(counts, _mm256_setzero_si256()));
+    }
+    std::uint64_t count = std::uint64_t(_mm256_extract_epi64(sums, 0)) +
+                          std::uint64_t(_mm256_extract_epi64(sums, 1)) +
+                          std::uint64_t(_mm256_extract_epi64(sums, 2)) +
+                          std::uint64_t(_mm256_extract_epi64(sums, 3));
+    for (; i < n; ++i) {
+      count += popcount64(b ? a[i] & b[i] : a[i]);
+    }
+    return count;
+  }
+
+  // orShiftedUp() on 4 words at once from the i-th word. returns the first word not processed.
+  __attribute__((target("avx2"))) static std::size_t
+  orShiftedUpAVX2(std::uint64_t *const dst, const std::uint64_t *const src, const std::size_t n,
+                  const std::size_t q, const std::size_t r, std::size_t i) {
+    // shifts by 64 make 0
+    const __m128i left = _mm_cvtsi64_si128(r), right = _mm_cvtsi64_si128(64 - r);
+    for (; i + 4 <= n; i += 4) {
+      const __m256i cur = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i - q));
+      const __m256i prev =
+          _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i - q - 1));
+      const __m256i shifted =
+          _mm256_or_si256(_mm256_sll_epi64(cur, left), _mm256_srl_epi64(prev, right));
+      const __m256i self = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_or_si256(self, shifted));
+    }
+    return i;
+  }
+
+  // andShiftedDown() on 4 words at once from the first word while source words are in range.
+  // returns the first word not processed.
+  __attribute__((target("avx2"))) static std::size_t
+  andShiftedDownAVX2(std::uint64_t *const dst, const std::uint64_t *const src,
+                     const std::size_t n, const std::size_t q, const std::size_t r) {
+    const __m128i right = _mm_cvtsi64_si128(r), left = _mm_cvtsi64_si128(64 - r);
+    std::size_t i = 0;
+    for (; i + q + 5 <= n; i += 4) {
+      const __m256i cur = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i + q));
+      const __m256i next =
+          _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i + q + 1));
+      const __m256i shifted =
+          _mm256_or_si256(_mm256_srl_epi64(cur, right), _mm256_sll_epi64(next, left));
+      const __m256i self = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm256_and_si256(self, shifted));
+    }
+    return i;
+  }
+#endif
+};
+} // namespace mac_time_tracker
+
+#endif
@@ -0,0 +1,97 @@
+#ifndef MAC_TIME_TRACKER_CLOCK_HPP
+#define MAC_TIME_TRACKER_CLOCK_HPP
+
+#include <cerrno>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+
+#include <sys/timerfd.h>
+#include <time.h>   // for CLOCK_REALTIME
+#include <unistd.h> // for read(), close()
+
+#include <mac_time_tracker/time.hpp>
+
+namespace mac_time_tracker {
+
+////////////////////////////////////////////////////////////////////////////
+// Source of the present time that the tracking loop depends on.
+// SystemClock follows the wall clock, and ManualClock is moved explicitly
+// so that recorded scans can be replayed as fast as possible.
+// TimerFDClock is a SystemClock that sleeps on an absolute deadline of the wall clock.
+
+class Clock {
+public:
+  virtual ~Clock() {}
+
+  virtual Time now() const = 0;
+  virtual void sleepUntil(const Time &time) = 0;
+};
+
+class SystemClock : public Clock {
+public:
+  virtual Time now() const override { return Time::now(); }
+  virtual void sleepUntil(const Time &time) override { std::this_thread::sleep_until(time); }
+};
+
+// std::this_thread::sleep_until() sleeps for a relative duration computed before sleeping,
+// so it wakes up early or late if the wall clock is adjusted in between.
+// a timerfd armed with an absolute CLOCK_REALTIME deadline follows the adjustment.
+class TimerFDClock : public SystemClock {
+public:
+  TimerFDClock() : fd_(timerfd_create(CLOCK_REALTIME, TFD_CLOEXEC)) {
+    if (fd_ < 0) {
+      throw std::runtime_error("TimerFDClock::TimerFDClock(): timerfd_create");
+    }
+  }
+  TimerFDClock(const TimerFDClock &) = delete;
+  TimerFDClock &operator=(const TimerFDClock &) = delete;
+  virtual ~TimerFDClock() { ::close(fd_); }
+
+  virtual void sleepUntil(const Time &time) override {
+    namespace sc = std::chrono;
+    const std::int64_t ns = sc::duration_cast<sc::nanoseconds>(time.time_since_epoch()).count();
+    if (ns <= 0) {
+      return; // long past, and a zero deadline would disarm the timer
+    }
+    itimerspec spec = {};
+    spec.it_value.tv_sec = ns / 1000000000;
+    spec.it_value.tv_nsec = ns % 1000000000;
+    while (true) {
+      if (timerfd_settime(fd_, TFD_TIMER_ABSTIME | TFD_TIMER_CANCEL_ON_SET, &spec, nullptr) != 0) {
+        throw std::runtime_error("TimerFDClock::sleepUntil(): timerfd_settime");
+      }
+      std::uint64_t expirations;
+      if (::read(fd_, &expirations, sizeof(expirations)) == sizeof(expirations)) {
+        return;
+      }
+      // the wall clock was set (ECANCELED) or a signal arrived (EINTR). sleep again.
+      if (errno != ECANCELED && errno != EINTR) {
+        throw std::runtime_error("TimerFDClock::sleepUntil(): read");
+      }
+    }
+  }
+
+private:
+  int fd_;
+};
+
+class ManualClock : public Clock {
+public:
+  explicit ManualClock(const Time &time = Time()) : now_(time) {}
+
+  virtual Time now() const override { return now_; }
+
+  // returns immediately after moving the present time. never goes back.
+  virtual void sleepUntil(const Time &time) override {
+    if (now_ < time) {
+      now_ = time;
+    }
+  }
+
+private:
+  Time now_;
+};
+} // namespace mac_time_tracker
+
+#endif
@@ -0,0 +1,399 @@
+#ifndef MAC_TIME_TRACKER_COLUMNAR_PERIOD_MAP_HPP
+#define MAC_TIME_TRACKER_COLUMNAR_PERIOD_MAP_HPP
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility> // for std::pair<>
+#include <vector>
+
+#include <mac_time_tracker/address.hpp>
+#include <mac_time_tracker/csv.hpp>
+#include <mac_time_tracker/io.hpp>
+#include <mac_time_tracker/parallel.hpp>
+#include <mac_time_tracker/period_map.hpp>
+#include <mac_time_tracker/time.hpp>
+
+namespace mac_time_tracker {
+
+/////////////////////////////////////////////////////////////////////////////////////////
+// Append-only PeriodMap for entries inserted in the time order (i.e. as scans happen).
+// entries are stored in columns instead of tree nodes;
+//   - runs of entries sharing a period, as seconds relative to the base time (12 bytes/run)
+//   - ids of devices, i.e. interned packed addresses with their names (4 bytes/entry)
+// where names are interned pairs of category and description.
+// iterators visit entries in the same order as PeriodMap and return them by value.
+
+class ColumnarPeriodMap : public Writable<ColumnarPeriodMap> {
+private:
+  using PackedAddress = std::array<std::uint8_t, 6>;
+
+  struct Device {
+    PackedAddress address;
+    std::uint32_t names; // index of names_
+  };
+  using DeviceIds = std::map<std::pair<std::uint64_t, std::uint32_t>, std::uint32_t>;
+
+public:
+  using Period = PeriodMapTraits::Period;
+  using Info = PeriodMapTraits::Info;
+  using value_type = std::pair<Period, Info>;
+
+  class const_iterator {
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = ColumnarPeriodMap::value_type;
+    using difference_type = std::ptrdiff_t;
+    using reference = value_type; // entries are materialized on access
+    struct pointer {
+      value_type value;
+      const value_type *operator->() const { return &value; }
+    };
+
+  public:
+    const_iterator() : map_(nullptr), run_(0), index_(0) {}
+
+    value_type operator*() const { return {period(), info()}; }
+    pointer operator->() const { return {**this}; }
+
+    // cheaper accessors that do not materialize the whole entry
+    Period period() const { return map_->periodOf(map_->runs_[run_]); }
+    Address address() const { return unpack(device().address); }
+    Info info() const { return map_->infoAt(index_); }
+
+    const_iterator &operator++() {
+      ++index_;
+      if (run_ + 1 < map_->runs_.size() && index_ == map_->runs_[run_ + 1].begin) {
+        ++run_;
+      }
+      return *this;
+    }
+    const_iterator operator++(int) {
+      const const_iterator prev = *this;
+      ++*this;
+      return prev;
+    }
+
+    bool operator==(const const_iterator &other) const { return index_ == other.index_; }
+    bool operator!=(const const_iterator &other) const { return index_ != other.index_; }
+
+  private:
+    friend class ColumnarPeriodMap;
+    const Device &device() const { return map_->devices_[map_->entries_[index_]]; }
+
+    const_iterator(const ColumnarPeriodMap *const map, const std::size_t run,
+                   const std::size_t index)
+        : map_(map), run_(run), index_(index) {}
+
+  private:
+    const ColumnarPeriodMap *map_;
+    std::size_t run_;   // index of map_->runs_
+    std::size_t index_; // index of entries
+  };
+
+public:
+  // the base time must not be later than any periods inserted
+  explicit ColumnarPeriodMap(const Time &base = Time()) : base_(base) {}
+
+  // append an entry. its period must not be less than the last one's, must not start before
+  // the base time, must consist of whole seconds and must end within 2^32 seconds from the base.
+  void insert(const value_type &entry) {
+    const Run key = {toOffset(entry.first.first), toOffset(entry.first.second), 0};
+    if (runs_.empty() || runs_.back() < key) {
+      runs_.push_back({key.start, key.end, static_cast<std::uint32_t>(entries_.size())});
+    } else if (key < runs_.back()) {
+      throw std::runtime_error("ColumnarPeriodMap::insert(): Period '" +
+                               entry.first.first.toStr() + "' to '" +
+                               entry.first.second.toStr() + "' is out of order");
+    }
+    if (entries_.size() >= std::numeric_limits<std::uint32_t>::max()) {
+      throw std::runtime_error("ColumnarPeriodMap::insert(): Too many entries");
+    }
+    entries_.push_back(intern(entry.second));
+  }
+
+  const_iterator begin() const { return {this, 0, 0}; }
+  const_iterator end() const { return {this, runs_.empty() ? 0 : runs_.size() - 1, size()}; }
+  std::size_t size() const { return entries_.size(); }
+  bool empty() const { return entries_.empty(); }
+  const Time &base() const { return base_; }
+
+  // take the last entry of each address in the previous map that ends within max_age
+  // before the base time of this, so that filled() can bridge gaps over the base time.
+  // entries carried to the previous map are taken as well.
+  void carryOver(const ColumnarPeriodMap &prev, const Time::duration &max_age) {
+    std::map<std::uint64_t, value_type> lasts;
+    for (const value_type &tail : prev.tails_) {
+      lasts[tail.second.address.toInt()] = tail;
+    }
+    for (const_iterator entry = prev.begin(); entry != prev.end(); ++entry) {
+      lasts[entry.address().toInt()] = *entry;
+    }
+    tails_.clear();
+    for (const std::pair<const std::uint64_t, value_type> &last : lasts) {
+      const Time &end = last.second.first.second;
+      if (end <= base_ && base_ - end <= max_age) {
+        tails_.push_back(last.second);
+      }
+    }
+  }
+
+  // entries with the given period
+  std::pair<const_iterator, const_iterator> equal_range(const Period &period) const {
+    const std::vector<Run>::const_iterator run =
+        std::lower_bound(runs_.begin(), runs_.end(), period,
+                         [this](const Run &r, const Period &p) { return periodOf(r) < p; });
+    if (run == runs_.end() || periodOf(*run) != period) {
+      const std::size_t index = run == runs_.end() ? size() : run->begin;
+      return {const_iterator(this, run - runs_.begin(), index),
+              const_iterator(this, run - runs_.begin(), index)};
+    }
+    const std::vector<Run>::const_iterator next = run + 1;
+    return {const_iterator(this, run - runs_.begin(), run->begin),
+            next == runs_.end() ? end() : const_iterator(this, next - runs_.begin(), next->begin)};
+  }
+
+  // same as PeriodMap::filled() but sweeps entries once by remembering the last entry of each
+  // address. addresses are sharded by their hash over n_threads threads
+  // (0 means the number of hardware threads) and the result does not depend on it.
+  // gaps after entries carried over are also filled but clipped at the base time.
+  PeriodMap filled(const Time::duration &max_fill, const std::string &desc_suffix = "*",
+                   const unsigned int n_threads = 1) const {
+    // bucket entries and tails by shard in the order of entries,
+    // so that each shard visits only its own ones
+    const unsigned int n_shards = resolveThreads(n_threads);
+    std::vector<unsigned int> device_shards(devices_.size());
+    for (std::size_t i = 0; i < devices_.size(); ++i) {
+      device_shards[i] = (mix(toInt(devices_[i].address)) >> 32) % n_shards;
+    }
+    std::vector<std::vector<std::size_t>> shard_tails(n_shards);
+    for (std::size_t i = 0; i < tails_.size(); ++i) {
+      shard_tails[(mix(tails_[i].second.address.toInt()) >> 32) % n_shards].push_back(i);
+    }
+    std::vector<std::vector<std::pair<std::uint32_t, std::uint32_t>>> shard_entries(
+        n_shards); // pairs of run and entry indices
+    for (std::size_t run = 0; run < runs_.size(); ++run) {
+      const std::size_t run_end = run + 1 < runs_.size() ? runs_[run + 1].begin : size();
+      for (std::size_t index = runs_[run].begin; index < run_end; ++index) {
+        shard_entries[device_shards[entries_[index]]].push_back(
+            {static_cast<std::uint32_t>(run), static_cast<std::uint32_t>(index)});
+      }
+    }
+
+    // find gaps in each shard
+    std::vector<std::vector<Gap>> shard_gaps(n_shards);
+    parallelFor(n_shards, [&](const unsigned int shard) {
+      std::unordered_map<std::uint64_t, Gap> lasts; // the last entry and its end of each address
+      for (const std::size_t i : shard_tails[shard]) {
+        lasts[tails_[i].second.address.toInt()] = {toSignedOffset(tails_[i].first.second), 0,
+                                                   size() + i};
+      }
+      for (const std::pair<std::uint32_t, std::uint32_t> &entry : shard_entries[shard]) {
+        const Run &run = runs_[entry.first];
+        const std::pair<std::unordered_map<std::uint64_t, Gap>::iterator, bool> last =
+            lasts.insert({toInt(devices_[entries_[entry.second]].address), Gap()});
+        Gap &gap = last.first->second;
+        if (!last.second && run.start > std::max<std::int64_t>(gap.start, 0) &&
+            std::chrono::seconds(run.start - gap.start) <= max_fill) {
+          gap.end = run.start;
+          shard_gaps[shard].push_back({std::max<std::int64_t>(gap.start, 0), gap.end, gap.entry});
+        }
+        gap.start = run.end;
+        gap.entry = entry.second;
+      }
+    });
+
+    // merge the original entries and filling entries. filling entries follow the original ones
+    // and are ordered by the entries before the gaps if periods are same, like PeriodMap::filled().
+    std::vector<Gap> gaps;
+    for (const std::vector<Gap> &shard : shard_gaps) {
+      gaps.insert(gaps.end(), shard.begin(), shard.end());
+    }
+    std::sort(gaps.begin(), gaps.end());
+    PeriodMap ret;
+    std::vector<Gap>::const_iterator gap = gaps.begin();
+    for (const_iterator entry = begin(); entry != end() || gap != gaps.end();) {
+      if (gap == gaps.end() ||
+          (entry != end() &&
+           !(Run{static_cast<std::uint32_t>(gap->start), gap->end, 0} < runs_[entry.run_]))) {
+        ret.insert(ret.end(), *entry);
+        ++entry;
+      } else {
+        Info info = gap->entry < size() ? infoAt(gap->entry) : tails_[gap->entry - size()].second;
+        info.description += desc_suffix;
+        ret.insert(ret.end(), {{toTime(gap->start), toTime(gap->end)}, info});
+        ++gap;
+      }
+    }
+    return ret;
+  }
+
+  // see PeriodMap::toCSV()
+  CSV toCSV(const std::string &time_fmt = Time::defaultFormat(),
+            const char addr_sep = Address::defaultSeparator()) const {
+    return PeriodMap::rangeToCSV(begin(), end(), time_fmt, addr_sep);
+  }
+
+  // see PeriodMap::toHTML()
+  void toHTML(const std::string &filename, const std::string &template_str,
+              const std::string &time_fmt = Time::defaultFormat(),
+              const char addr_sep = Address::defaultSeparator(),
+              const Time &update_time = Time::now(), const unsigned int n_threads = 1) const {
+    PeriodMap::rangeToHTML(begin(), end(), filename, template_str, time_fmt, addr_sep,
+                           update_time, n_threads);
+  }
+
+  // approximate bytes used by the columns
+  std::size_t memoryUsage() const {
+    std::size_t bytes = runs_.capacity() * sizeof(Run) +
+                        entries_.capacity() * sizeof(std::uint32_t) +
+                        devices_.capacity() * sizeof(Device) +
+                        device_ids_.size() * (sizeof(DeviceIds::value_type) + 4 * sizeof(void *));
+    for (const std::pair<std::string, std::string> &names : names_) {
+      bytes += 2 * sizeof(names) + names.first.capacity() + names.second.capacity();
+    }
+    return bytes;
+  }
+
+  void clear() {
+    runs_.clear();
+    entries_.clear();
+    devices_.clear();
+    device_ids_.clear();
+    names_.clear();
+    name_ids_.clear();
+    tails_.clear();
+  }
+
+private:
+  struct Run {
+    std::uint32_t start; // seconds from the base time
+    std::uint32_t end;
+    std::uint32_t begin; // index of the first entry in this run
+
+    bool operator<(const Run &other) const {
+      return start != other.start ? start < other.start : end < other.end;
+    }
+  };
+
+  std::uint32_t toOffset(const Time &time) const {
+    namespace sc = std::chrono;
+    const Time::duration offset = time - base_;
+    if (offset < Time::duration::zero() || offset % sc::seconds(1) != Time::duration::zero() ||
+        sc::duration_cast<sc::seconds>(offset).count() >
+            std::numeric_limits<std::uint32_t>::max()) {
+      throw std::runtime_error("ColumnarPeriodMap::toOffset(): '" + time.toStr() +
+                               "' is not a whole second within 2^32 seconds from '" +
+                               base_.toStr() + "'");
+    }
+    return sc::duration_cast<sc::seconds>(offset).count();
+  }
+
+  // seconds from the base time, which may be negative (fractions are truncated)
+  std::int64_t toSignedOffset(const Time &time) const {
+    return std::chrono::duration_cast<std::chrono::seconds>(time - base_).count();
+  }
+
+  // a gap of an address from the end of an entry to the start of the next entry
+  struct Gap {
+    std::int64_t start; // seconds from the base time. negative if the entry is carried over.
+    std::uint32_t end;
+    std::size_t entry; // index of the entry before the gap. size() + i for tails_[i].
+
+    bool operator<(const Gap &other) const {
+      return start != other.start ? start < other.start
+                                  : end != other.end ? end < other.end : entry < other.entry;
+    }
+  };
+
+  Time toTime(const std::int64_t offset) const { return base_ + std::chrono::seconds(offset); }
+  Period periodOf(const Run &run) const { return {toTime(run.start), toTime(run.end)}; }
+  Info infoAt(const std::size_t index) const {
+    const Device &device = devices_[entries_[index]];
+    const std::pair<std::string, std::string> &names = names_[device.names];
+    return {unpack(device.address), names.first, names.second};
+  }
+
+  static PackedAddress pack(const Address &addr) { return addr; }
+  static Address unpack(const PackedAddress &packed) {
+    Address addr;
+    static_cast<PackedAddress &>(addr) = packed;
+    return addr;
+  }
+  static std::uint64_t toInt(const PackedAddress &packed) {
+    std::uint64_t val = 0;
+    for (const std::uint8_t octet : packed) {
+      val = (val << 8) | octet;
+    }
+    return val;
+  }
+
+  // finalizer of splitmix64 to shard addresses
+  static std::uint64_t mix(std::uint64_t val) {
+    val = (val ^ (val >> 30)) * 0xBF58476D1CE4E5B9ull;
+    val = (val ^ (val >> 27)) * 0x94D049BB133111EBull;
+    return val ^ (val >> 31);
+  }
+
+  // returns the id of the device
+  std::uint32_t intern(const Info &info) {
+    std::uint32_t names = static_cast<std::uint32_t>(names_.size());
+    const std::pair<std::map<std::pair<std::string, std::string>, std::uint32_t>::iterator, bool>
+        names_inserted = name_ids_.insert({{info.category, info.description}, names});
+    if (names_inserted.second) {
+      names_.push_back(names_inserted.first->first);
+    } else {
+      names = names_inserted.first->second;
+    }
+    const std::pair<DeviceIds::iterator, bool> device_inserted = device_ids_.insert(
+        {{info.address.toInt(), names}, static_cast<std::uint32_t>(devices_.size())});
+    if (device_inserted.second) {
+      devices_.push_back({pack(info.address), names});
+    }
+    return device_inserted.first->second;
+  }
+
+  friend class Writable<ColumnarPeriodMap>;
+
+  // same as toCSV() but streamed without materializing the CSV.
+  // the period is formatted once per run and the fields reuse their buffers.
+  void write(std::ostream &os) const {
+    std::vector<std::string> line(5);
+    for (std::size_t i_run = 0; i_run < runs_.size(); ++i_run) {
+      const Period period = periodOf(runs_[i_run]);
+      line[0] = period.first.toStr(Time::defaultFormat());
+      line[1] = period.second.toStr(Time::defaultFormat());
+      const std::size_t end = i_run + 1 < runs_.size() ? runs_[i_run + 1].begin : size();
+      for (std::size_t i = runs_[i_run].begin; i < end; ++i) {
+        const Device &device = devices_[entries_[i]];
+        const std::pair<std::string, std::string> &names = names_[device.names];
+        line[2] = unpack(device.address).toStr(Address::defaultSeparator());
+        line[3] = names.first;
+        line[4] = names.second;
+        CSV::writeLine(os, line);
+      }
+    }
+  }
+
+private:
+  Time base_;
+  std::vector<Run> runs_;
+  std::vector<std::uint32_t> entries_; // device ids
+  std::vector<Device> devices_;
+  DeviceIds device_ids_; // from (address, names)
+  std::vector<std::pair<std::string, std::string>> names_; // interned (category, description)
+  std::map<std::pair<std::string, std::string>, std::uint32_t> name_ids_;
+  std::vector<value_type> tails_; // entries carried over
+};
+} // namespace mac_time_tracker
+
+#endif
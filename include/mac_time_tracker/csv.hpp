@@ -12,7 +12,9 @@
 
 namespace mac_time_tracker {
 
-class CSV : public std::vector<std::vector<std::string>>, public Readable<CSV>, public Writable {
+class CSV : public std::vector<std::vector<std::string>>,
+            public Readable<CSV>,
+            public Writable<CSV> {
 private:
   using Base = std::vector<std::vector<std::string>>;
 
@@ -21,46 +23,75 @@ public:
   CSV(const Base &base) : Base(base) {}
   CSV(Base &&base) : Base(base) {}
 
+  // read a line of CSV from the given stream, which is useful to process a large CSV as a stream.
+  // returns false if the line is empty (i.e. the end of CSV).
+  static bool readLine(std::istream &is, std::vector<std::string> *const line) {
+    std::string str;
+    if (!readRawLine(is, &str)) {
+      return false;
+    }
+    splitLine(str, line);
+    return true;
+  }
+
+  // read a line of CSV without splitting it into fields.
+  // returns false if the line is empty (i.e. the end of CSV).
+  static bool readRawLine(std::istream &is, std::string *const str) {
+    str->clear(); // std::getline() does not clear it at EOF
+    std::getline(is, *str);
+    if (str->empty()) {
+      // this means successfully reached EOF but std::getline() set the fail flag
+      // because the last line was empty. cancel the fail flag (i.e. set only the eof flag)
+      // because that is ok as a CSV format.
+      if (is.fail() && !is.bad() && is.eof()) {
+        is.clear(/* new_state = */ std::istream::eofbit);
+      }
+      return false;
+    }
+    return true;
+  }
+
+  // tokenize a line of CSV into fields
+  static void splitLine(const std::string &str, std::vector<std::string> *const line) {
+    boost::tokenizer<boost::escaped_list_separator<char>> tokens(str);
+    line->assign(tokens.begin(), tokens.end());
+  }
+
+  // write a line of CSV to the given stream
+  static void writeLine(std::ostream &os, const std::vector<std::string> &line) {
+    for (std::size_t i = 0; i < line.size(); ++i) {
+      if (i > 0) {
+        os << ",";
+      }
+      std::string escaped = line[i];
+      boost::replace_all(escaped, R"(\)", R"(\\)"); // escape ch
+      boost::replace_all(escaped, R"(")", R"(\")"); // quote
+      boost::replace_all(escaped, "\n", R"(\n)");   // new line
+      os << "\"" << escaped << "\"";
+    }
+    os << "\n";
+  }
+
 private:
+  friend class Readable<CSV>;
+  friend class Writable<CSV>;
+
   // read CSV from the given stream.
   // this implements a variant of CSV that
   //   - ends with an empty line or EOF
   //   - allows different number of fields between lines
-  virtual void read(std::istream &is) override {
+  void read(std::istream &is) {
     clear();
-    while (true) {
-      // read a line from the stream
-      std::string line;
-      std::getline(is, line);
-      if (line.empty()) {
-        break;
-      }
-      // tokenize the line
-      boost::tokenizer<boost::escaped_list_separator<char>> tokens(line);
-      emplace_back(tokens.begin(), tokens.end());
-    }
-    // this means successfully reached EOF but std::getline() set the fail flag
-    // because the last line was empty. cancel the fail flag (i.e. set only the eof flag)
-    // because that is ok as a CSV format.
-    if (is.fail() && !is.bad() && is.eof()) {
-      is.clear(/* new_state = */ std::istream::eofbit);
+    std::vector<std::string> line;
+    while (readLine(is, &line)) {
+      push_back(line);
     }
   }
 
   // dump data to the given stream
-  virtual void write(std::ostream &os) const override {
+  void write(std::ostream &os) const {
     for (const std::vector<std::string> &line : *this) {
-      for (std::size_t i = 0; i < line.size(); ++i) {
-        if (i > 0) {
-          os << ",";
-        }
-        std::string escaped = line[i];
-        boost::replace_all(escaped, R"(\)", R"(\\)"); // escape ch
-        boost::replace_all(escaped, R"(")", R"(\")"); // quote
-        boost::replace_all(escaped, "\n", R"(\n)");   // new line
-        os << "\"" << escaped << "\"";
-      }
-      os << "\n";
+      writeLine(os, line);
     }
   }
 };
@@ -0,0 +1,103 @@
+#ifndef MAC_TIME_TRACKER_GZIP_HPP
+#define MAC_TIME_TRACKER_GZIP_HPP
+
+#include <cstdio> // for std::remove()
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+
+#include <zlib.h>
+
+namespace mac_time_tracker {
+
+/////////////////////////////////////////////////////////////////////////
+// Input file stream that reads both gzip-compressed and plain files.
+// zlib detects the format by the header and passes plain files through.
+
+class GzipFileBuf : public std::streambuf {
+public:
+  GzipFileBuf() : file_(nullptr) {}
+  GzipFileBuf(const GzipFileBuf &) = delete;
+  GzipFileBuf &operator=(const GzipFileBuf &) = delete;
+  virtual ~GzipFileBuf() { close(); }
+
+  bool open(const std::string &filename) {
+    close();
+    file_ = gzopen(filename.c_str(), "rb");
+    return file_ != nullptr;
+  }
+
+  void close() {
+    if (file_) {
+      gzclose(file_);
+      file_ = nullptr;
+    }
+    setg(buffer_, buffer_, buffer_);
+  }
+
+  bool is_open() const { return file_ != nullptr; }
+
+protected:
+  virtual int_type underflow() override {
+    if (gptr() < egptr()) {
+      return traits_type::to_int_type(*gptr());
+    }
+    if (!file_) {
+      return traits_type::eof();
+    }
+    const int n = gzread(file_, buffer_, sizeof(buffer_));
+    if (n < 0) {
+      throw std::runtime_error("GzipFileBuf::underflow(): gzread");
+    } else if (n == 0) {
+      return traits_type::eof();
+    }
+    setg(buffer_, buffer_, buffer_ + n);
+    return traits_type::to_int_type(*gptr());
+  }
+
+private:
+  gzFile file_;
+  char buffer_[1 << 16];
+};
+
+class GzipIFStream : public std::istream {
+public:
+  explicit GzipIFStream(const std::string &filename) : std::istream(&buf_) {
+    if (!buf_.open(filename)) {
+      setstate(std::istream::failbit);
+    }
+  }
+
+private:
+  GzipFileBuf buf_;
+};
+
+// compress a file to another as a stream, and then remove the source
+inline void gzipFile(const std::string &src, const std::string &dst) {
+  std::ifstream ifs(src, std::ios::binary);
+  if (!ifs) {
+    throw std::runtime_error("gzipFile(): Cannot open '" + src + "' to read");
+  }
+  const gzFile ofs = gzopen(dst.c_str(), "wb");
+  if (!ofs) {
+    throw std::runtime_error("gzipFile(): Cannot open '" + dst + "' to write");
+  }
+  char buffer[1 << 16];
+  bool ok = true;
+  while (ok && ifs) {
+    ifs.read(buffer, sizeof(buffer));
+    ok = ifs.gcount() == 0 || gzwrite(ofs, buffer, ifs.gcount()) == ifs.gcount();
+  }
+  ok = (gzclose(ofs) == Z_OK) && ok && !ifs.bad();
+  if (!ok) {
+    std::remove(dst.c_str());
+    throw std::runtime_error("gzipFile(): Cannot compress '" + src + "' to '" + dst + "'");
+  }
+  ifs.close();
+  std::remove(src.c_str());
+}
+} // namespace mac_time_tracker
+
+#endif
@@ -0,0 +1,283 @@
+#ifndef MAC_TIME_TRACKER_HISTORY_INDEX_HPP
+#define MAC_TIME_TRACKER_HISTORY_INDEX_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio> // for std::rename(), std::remove()
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <mac_time_tracker/address.hpp>
+#include <mac_time_tracker/mapped_file.hpp>
+#include <mac_time_tracker/period_map.hpp>
+#include <mac_time_tracker/time.hpp>
+
+namespace mac_time_tracker {
+
+//////////////////////////////////////////////////////////////////////////////////////////
+// Index from each address to its sorted, disjoint intervals of presence across periods.
+// adjacent or overlapping periods are coalesced, so adding the same entries twice does
+// not change the index and periods can be added in any order.
+// layout on disk (native byte order, which is checked on load);
+//   - Header
+//   - Slot * n_addresses, sorted by address
+//   - Interval * n_intervals, grouped by address in the order of the slots
+// HistoryIndex::File queries it in O(log n) without reading the whole file.
+
+class HistoryIndex {
+public:
+  // in seconds since the epoch
+  struct Interval {
+    std::int64_t start, end;
+  };
+  using Intervals = std::vector<Interval>;
+
+  class File;
+
+public:
+  // add entries in [first, last) of any container like PeriodMap
+  template <class Iterator> void add(const Iterator first, const Iterator last) {
+    for (Iterator it = first; it != last; ++it) {
+      const typename std::iterator_traits<Iterator>::value_type &entry = *it;
+      add(entry.second.address, entry.first);
+    }
+  }
+
+  void add(const Address &address, const PeriodMap::Period &period) {
+    Intervals &intervals = intervals_[address.toInt()];
+    Interval interval = {toSeconds(period.first), toSeconds(period.second)};
+    // usually appended to the last one
+    if (!intervals.empty() && intervals.back().start <= interval.start) {
+      if (intervals.back().end >= interval.start) {
+        intervals.back().end = std::max(intervals.back().end, interval.end);
+      } else {
+        intervals.push_back(interval);
+      }
+      return;
+    }
+    // merge with all intervals that overlap or touch it
+    Intervals::iterator lo = std::lower_bound(
+        intervals.begin(), intervals.end(), interval.start,
+        [](const Interval &i, const std::int64_t start) { return i.end < start; });
+    Intervals::iterator hi = lo;
+    for (; hi != intervals.end() && hi->start <= interval.end; ++hi) {
+      interval.start = std::min(interval.start, hi->start);
+      interval.end = std::max(interval.end, hi->end);
+    }
+    intervals.insert(intervals.erase(lo, hi), interval);
+  }
+
+  // add all intervals of another index (ex. of a single period)
+  void add(const HistoryIndex &other) {
+    for (const std::pair<const std::uint64_t, Intervals> &addr_intervals : other.intervals_) {
+      const Address address = Address::fromInt(addr_intervals.first);
+      for (const Interval &interval : addr_intervals.second) {
+        add(address, {fromSeconds(interval.start), fromSeconds(interval.end)});
+      }
+    }
+  }
+
+  const std::map<std::uint64_t, Intervals> &intervals() const { return intervals_; }
+  std::size_t size() const { return intervals_.size(); }
+
+  bool lastSeen(const Address &address, Time *const end) const {
+    const std::map<std::uint64_t, Intervals>::const_iterator it =
+        intervals_.find(address.toInt());
+    return it != intervals_.end() && lastSeenIn(it->second.data(), it->second.size(), end);
+  }
+
+  std::vector<PeriodMap::Period> presence(const Address &address, const Time &from,
+                                          const Time &to) const {
+    const std::map<std::uint64_t, Intervals>::const_iterator it =
+        intervals_.find(address.toInt());
+    return it != intervals_.end()
+               ? presenceIn(it->second.data(), it->second.size(), from, to)
+               : std::vector<PeriodMap::Period>();
+  }
+
+  // an empty index if the file does not exist
+  static HistoryIndex fromFile(const std::string &filename);
+
+  // write via a temporary file so that readers never see a partial one
+  void toFile(const std::string &filename) const {
+    Header header;
+    std::memcpy(header.magic, magic(), sizeof(header.magic));
+    header.version = version();
+    header.byte_order = byteOrder();
+    header.n_addresses = intervals_.size();
+    header.n_intervals = 0;
+    std::vector<Slot> slots;
+    for (const std::pair<const std::uint64_t, Intervals> &addr_intervals : intervals_) {
+      slots.push_back({addr_intervals.first, header.n_intervals, addr_intervals.second.size()});
+      header.n_intervals += addr_intervals.second.size();
+    }
+
+    const std::string temp_filename = filename + ".tmp";
+    {
+      std::ofstream ofs(temp_filename, std::ios::binary);
+      ofs.write(reinterpret_cast<const char *>(&header), sizeof(header));
+      ofs.write(reinterpret_cast<const char *>(slots.data()), slots.size() * sizeof(Slot));
+      for (const std::pair<const std::uint64_t, Intervals> &addr_intervals : intervals_) {
+        ofs.write(reinterpret_cast<const char *>(addr_intervals.second.data()),
+                  addr_intervals.second.size() * sizeof(Interval));
+      }
+      if (!ofs) {
+        std::remove(temp_filename.c_str());
+        throw std::runtime_error("HistoryIndex::toFile(): Cannot write to '" + temp_filename +
+                                 "'");
+      }
+    }
+    if (std::rename(temp_filename.c_str(), filename.c_str()) != 0) {
+      std::remove(temp_filename.c_str());
+      throw std::runtime_error("HistoryIndex::toFile(): Cannot rename '" + temp_filename +
+                               "' to '" + filename + "'");
+    }
+  }
+
+  // bump this when the layout changes
+  static std::uint32_t version() { return 1; }
+
+private:
+  struct Header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byte_order;
+    std::uint64_t n_addresses;
+    std::uint64_t n_intervals;
+  };
+
+  struct Slot {
+    std::uint64_t address;
+    std::uint64_t first; // index of the first interval
+    std::uint64_t count;
+  };
+
+  static const char *magic() { return "MTTHIDX"; } // 7 chars + '\0'
+  static std::uint32_t byteOrder() { return 0x01020304; }
+
+  static std::int64_t toSeconds(const Time &time) {
+    return std::chrono::duration_cast<std::chrono::seconds>(time.time_since_epoch()).count();
+  }
+
+  static Time fromSeconds(const std::int64_t sec) {
+    return Time(std::chrono::duration_cast<Time::duration>(std::chrono::seconds(sec)));
+  }
+
+  static bool lastSeenIn(const Interval *const intervals, const std::size_t n,
+                         Time *const end) {
+    if (n == 0) {
+      return false;
+    }
+    *end = fromSeconds(intervals[n - 1].end);
+    return true;
+  }
+
+  // intervals overlapping [from, to), clipped by it
+  static std::vector<PeriodMap::Period> presenceIn(const Interval *const intervals,
+                                                   const std::size_t n, const Time &from,
+                                                   const Time &to) {
+    const std::int64_t from_sec = toSeconds(from), to_sec = toSeconds(to);
+    std::vector<PeriodMap::Period> ret;
+    for (const Interval *it = std::upper_bound(
+             intervals, intervals + n, from_sec,
+             [](const std::int64_t sec, const Interval &i) { return sec < i.end; });
+         it != intervals + n && it->start < to_sec; ++it) {
+      ret.push_back({fromSeconds(std::max(it->start, from_sec)),
+                     fromSeconds(std::min(it->end, to_sec))});
+    }
+    return ret;
+  }
+
+private:
+  std::map<std::uint64_t, Intervals> intervals_; // by Address::toInt()
+};
+
+// read-only index mapped on memory
+class HistoryIndex::File {
+public:
+  explicit File(const std::string &filename)
+      : file_(filename), slots_(nullptr), intervals_(nullptr), n_addresses_(0), n_intervals_(0) {
+    if (!file_.data) {
+      throw std::runtime_error("HistoryIndex::File::File(): Cannot open '" + filename + "'");
+    }
+    Header header = {};
+    if (file_.size >= sizeof(Header)) {
+      std::memcpy(&header, file_.data, sizeof(Header));
+    }
+    if (std::memcmp(header.magic, magic(), sizeof(header.magic)) != 0 ||
+        header.version != version() || header.byte_order != byteOrder() ||
+        header.n_addresses > file_.size / sizeof(Slot) ||
+        header.n_intervals > file_.size / sizeof(Interval) ||
+        file_.size != sizeof(Header) + header.n_addresses * sizeof(Slot) +
+                          header.n_intervals * sizeof(Interval)) {
+      throw std::runtime_error("HistoryIndex::File::File(): Broken index '" + filename + "'");
+    }
+    slots_ = reinterpret_cast<const Slot *>(file_.data + sizeof(Header));
+    intervals_ = reinterpret_cast<const Interval *>(file_.data + sizeof(Header) +
+                                                    header.n_addresses * sizeof(Slot));
+    n_addresses_ = header.n_addresses;
+    n_intervals_ = header.n_intervals;
+    for (const Slot *slot = slots_; slot != slots_ + n_addresses_; ++slot) {
+      if (slot->first > n_intervals_ || slot->count > n_intervals_ - slot->first) {
+        throw std::runtime_error("HistoryIndex::File::File(): Broken index '" + filename + "'");
+      }
+    }
+  }
+
+  std::size_t size() const { return n_addresses_; }
+
+  bool lastSeen(const Address &address, Time *const end) const {
+    const Slot *const slot = find(address);
+    return slot && lastSeenIn(intervals_ + slot->first, slot->count, end);
+  }
+
+  std::vector<PeriodMap::Period> presence(const Address &address, const Time &from,
+                                          const Time &to) const {
+    const Slot *const slot = find(address);
+    return slot ? presenceIn(intervals_ + slot->first, slot->count, from, to)
+                : std::vector<PeriodMap::Period>();
+  }
+
+  // copy to a modifiable index
+  HistoryIndex load() const {
+    HistoryIndex index;
+    for (const Slot *slot = slots_; slot != slots_ + n_addresses_; ++slot) {
+      index.intervals_.insert(
+          index.intervals_.end(),
+          {slot->address, Intervals(intervals_ + slot->first,
+                                    intervals_ + slot->first + slot->count)});
+    }
+    return index;
+  }
+
+private:
+  const Slot *find(const Address &address) const {
+    const std::uint64_t key = address.toInt();
+    const Slot *const slot =
+        std::lower_bound(slots_, slots_ + n_addresses_, key,
+                         [](const Slot &s, const std::uint64_t k) { return s.address < k; });
+    return slot != slots_ + n_addresses_ && slot->address == key ? slot : nullptr;
+  }
+
+private:
+  MappedFile file_;
+  const Slot *slots_;
+  const Interval *intervals_;
+  std::uint64_t n_addresses_, n_intervals_;
+};
+
+inline HistoryIndex HistoryIndex::fromFile(const std::string &filename) {
+  if (!std::ifstream(filename)) {
+    return HistoryIndex();
+  }
+  return File(filename).load();
+}
+} // namespace mac_time_tracker
+
+#endif
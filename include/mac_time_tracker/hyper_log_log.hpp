@@ -0,0 +1,81 @@
+#ifndef MAC_TIME_TRACKER_HYPER_LOG_LOG_HPP
+#define MAC_TIME_TRACKER_HYPER_LOG_LOG_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include <mac_time_tracker/address.hpp>
+
+namespace mac_time_tracker {
+
+/////////////////////////////////////////////////////////////////////////////
+// Estimator of the number of distinct MAC addresses in constant memory.
+// 2^precision registers of 1 byte (4 KiB by default), ~1.6% standard error.
+// precision must be in [4, 18].
+
+class HyperLogLog {
+public:
+  explicit HyperLogLog(const unsigned int precision = 12)
+      : precision_(checkPrecision(precision)), registers_(std::size_t(1) << precision, 0) {}
+
+  void insert(const Address &addr) {
+    const std::uint64_t hash = mix(addr.toInt());
+    // the upper bits choose a register and the rest gives the rank
+    const std::size_t index = hash >> (64 - precision_);
+    const std::uint64_t rest = hash << precision_;
+    const std::uint8_t rank =
+        rest == 0 ? 64 - precision_ + 1 : static_cast<std::uint8_t>(__builtin_clzll(rest) + 1);
+    registers_[index] = std::max(registers_[index], rank);
+  }
+
+  // make this an estimator of the union. both must have the same precision.
+  void merge(const HyperLogLog &other) {
+    for (std::size_t i = 0; i < registers_.size(); ++i) {
+      registers_[i] = std::max(registers_[i], other.registers_[i]);
+    }
+  }
+
+  double estimate() const {
+    const double m = registers_.size();
+    double sum = 0.;
+    std::size_t zeros = 0;
+    for (const std::uint8_t reg : registers_) {
+      sum += std::ldexp(1., -reg);
+      zeros += (reg == 0 ? 1 : 0);
+    }
+    const double alpha = 0.7213 / (1. + 1.079 / m);
+    const double raw = alpha * m * m / sum;
+    // linear counting is more accurate for small cardinalities
+    if (raw <= 2.5 * m && zeros > 0) {
+      return m * std::log(m / zeros);
+    }
+    return raw;
+  }
+
+  void clear() { std::fill(registers_.begin(), registers_.end(), 0); }
+
+private:
+  static unsigned int checkPrecision(const unsigned int precision) {
+    if (precision < 4 || precision > 18) {
+      throw std::runtime_error("HyperLogLog::HyperLogLog(): Precision must be in [4, 18]");
+    }
+    return precision;
+  }
+
+  // finalizer of splitmix64 that spreads 48-bit addresses over 64 bits
+  static std::uint64_t mix(std::uint64_t val) {
+    val = (val ^ (val >> 30)) * 0xBF58476D1CE4E5B9ull;
+    val = (val ^ (val >> 27)) * 0x94D049BB133111EBull;
+    return val ^ (val >> 31);
+  }
+
+private:
+  unsigned int precision_;
+  std::vector<std::uint8_t> registers_;
+};
+} // namespace mac_time_tracker
+
+#endif
@@ -1,32 +1,70 @@
 #ifndef MAC_TIME_TRACKER_IO_HPP
 #define MAC_TIME_TRACKER_IO_HPP
 
+#include <cstddef>
 #include <fstream>
 #include <iostream>
 #include <sstream>
+#include <stdexcept>
+#include <streambuf>
 #include <string>
 
+#include <mac_time_tracker/gzip.hpp>
+
 namespace mac_time_tracker {
 
+///////////////////////////////////////////////////////////////////////////////////
+// Stream I/O of T, which is statically dispatched to private members of T;
+//   - void T::read(std::istream &)        for Readable<T>
+//   - void T::write(std::ostream &) const for Writable<T>
+// T befriends Readable<T> and Writable<T> to expose them only to these.
+// so the bases are empty and add neither a vtable pointer nor a byte to T.
+// T may also hide fromChars() or toChars() with parsers on chars that skip streams.
+
+// an input stream on [first, last) of chars without copying them
+class CharsIStream : private std::streambuf, public std::istream {
+public:
+  CharsIStream(const char *const first, const char *const last) : std::istream(this) {
+    setg(const_cast<char *>(first), const_cast<char *>(first), const_cast<char *>(last));
+  }
+
+  std::size_t consumed() const { return gptr() - eback(); }
+};
+
+// an output stream to [first, last) of chars, which fails when they are too few
+class CharsOStream : private std::streambuf, public std::ostream {
+public:
+  CharsOStream(char *const first, char *const last) : std::ostream(this) { setp(first, last); }
+
+  char *end() const { return pptr(); }
+};
+
 template <class T> class Readable {
 public:
   friend std::istream &operator>>(std::istream &is, Readable<T> &val) {
-    val.read(is);
+    readFrom(is, static_cast<T &>(val));
     return is;
   }
 
+  // parse a value at the beginning of [first, last) like std::from_chars() of C++17.
+  // returns the end of the parsed chars, or nullptr on failure.
+  static const char *fromChars(const char *const first, const char *const last, T *const val) {
+    CharsIStream is(first, last);
+    readFrom(is, *val);
+    return is.fail() ? nullptr : first + is.consumed();
+  }
+
   static T fromStr(const std::string &str) {
-    std::istringstream iss(str);
     T val;
-    iss >> val;
-    if (!iss) {
+    if (!T::fromChars(str.data(), str.data() + str.size(), &val)) {
       throw std::runtime_error("Readable::fromStr(): Cannot parse '" + str + "'");
     }
     return val;
   }
 
+  // read a plain or gzip-compressed file
   static T fromFile(const std::string &filename) {
-    std::ifstream ifs(filename);
+    GzipIFStream ifs(filename);
     if (!ifs) {
       throw std::runtime_error("Readable::fromFile(): Cannot open '" + filename + "' to read");
     }
@@ -39,19 +77,27 @@ public:
   }
 
 private:
-  virtual void read(std::istream &is) = 0;
+  static void readFrom(std::istream &is, T &val) { val.read(is); }
 };
 
-class Writable {
+template <class T> class Writable {
 public:
-  friend std::ostream &operator<<(std::ostream &os, const Writable &val) {
-    val.write(os);
+  friend std::ostream &operator<<(std::ostream &os, const Writable<T> &val) {
+    writeTo(os, static_cast<const T &>(val));
     return os;
   }
 
+  // write to [first, last) like std::to_chars() of C++17.
+  // returns the end of the written chars, or nullptr if they are too few.
+  char *toChars(char *const first, char *const last) const {
+    CharsOStream os(first, last);
+    writeTo(os, static_cast<const T &>(*this));
+    return os ? os.end() : nullptr;
+  }
+
   std::string toStr() const {
     std::ostringstream oss;
-    oss << *this;
+    writeTo(oss, static_cast<const T &>(*this));
     if (!oss) {
       throw std::runtime_error("Writable::toStr(): Cannot write to a string");
     }
@@ -63,15 +109,15 @@ public:
     if (!ofs) {
       throw std::runtime_error("Writable::toFile(): Cannot open '" + filename + "' to write");
     }
-    ofs << *this;
+    writeTo(ofs, static_cast<const T &>(*this));
     if (!ofs) {
       throw std::runtime_error("Writable::toFile(): Cannot write to '" + filename + "'");
     }
   }
 
 private:
-  virtual void write(std::ostream &os) const = 0;
+  static void writeTo(std::ostream &os, const T &val) { val.write(os); }
 };
 } // namespace mac_time_tracker
 
-#endif
\ No newline at end of file
+#endif
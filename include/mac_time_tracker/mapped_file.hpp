@@ -0,0 +1,46 @@
+#ifndef MAC_TIME_TRACKER_MAPPED_FILE_HPP
+#define MAC_TIME_TRACKER_MAPPED_FILE_HPP
+
+#include <string>
+
+#include <fcntl.h>    // for open()
+#include <sys/mman.h> // for mmap(), munmap()
+#include <sys/stat.h> // for fstat()
+#include <time.h>     // for timespec
+#include <unistd.h>   // for close()
+
+namespace mac_time_tracker {
+
+// read-only mapping of a whole file. data is nullptr if failed or the file is empty.
+struct MappedFile {
+  explicit MappedFile(const std::string &filename) : data(nullptr), size(0), mtime() {
+    const int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+      return;
+    }
+    struct stat st;
+    if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+      void *const addr = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (addr != MAP_FAILED) {
+        data = static_cast<const char *>(addr);
+        size = st.st_size;
+        mtime = st.st_mtim;
+      }
+    }
+    ::close(fd);
+  }
+  ~MappedFile() {
+    if (data) {
+      ::munmap(const_cast<char *>(data), size);
+    }
+  }
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  const char *data;
+  std::size_t size;
+  struct timespec mtime;
+};
+} // namespace mac_time_tracker
+
+#endif
@@ -0,0 +1,209 @@
+#ifndef MAC_TIME_TRACKER_OCCUPANCY_HPP
+#define MAC_TIME_TRACKER_OCCUPANCY_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <boost/lexical_cast.hpp>
+
+#include <mac_time_tracker/csv.hpp>
+#include <mac_time_tracker/io.hpp>
+#include <mac_time_tracker/period_map.hpp>
+#include <mac_time_tracker/time.hpp>
+
+namespace mac_time_tracker {
+
+/////////////////////////////////////////////////////////////////////////////////////////
+// Number of devices present per category in each slot (ex. hour) on the grid of
+// (base + n * slot), and in the latest scanning period.
+// counters are updated on each insertion of a scan result, so the cost of a scan is
+// proportional to the devices present in it, not to the history.
+// a device is counted once per slot in the category of its first insertion.
+// addresses are kept only for slots that the latest scanning period has not passed.
+
+class Occupancy : public Writable<Occupancy> {
+public:
+  using Period = PeriodMapTraits::Period;
+  using Info = PeriodMapTraits::Info;
+  using Counts = std::map<std::string, std::size_t>; // devices per category
+
+public:
+  Occupancy(const Time &base, const Time::duration &slot)
+      : base_(base), slot_(slot), unsealed_(Time::duration::min()) {
+    if (slot_ <= Time::duration::zero()) {
+      throw std::runtime_error("Occupancy::Occupancy(): Slot must be positive");
+    }
+  }
+
+  // start a scanning period which will be the latest one even if no device is inserted.
+  // a period not newer than the latest one is ignored.
+  void beginPeriod(const Period &period) {
+    if (period.first <= latest_.period.first) {
+      return;
+    }
+    latest_.period = period;
+    latest_.counts.clear();
+    latest_.devices.clear();
+    seal(period.first);
+  }
+
+  // count a device present in the period, which is usually the latest scanning period
+  void insert(const Period &period, const Info &info) {
+    const std::uint64_t device = info.address.toInt();
+    beginPeriod(period);
+    if (period.first == latest_.period.first && latest_.devices.insert(device).second) {
+      ++latest_.counts[info.category];
+    }
+    // slots overlapping the period
+    for (Time start = slotStart(period.first); start < period.second; start += slot_) {
+      Slot &slot = slots_[start];
+      if (slot.devices.insert(device).second) {
+        ++slot.counts[info.category];
+      }
+    }
+  }
+
+  // devices per category of each slot by the start. slots without devices are absent.
+  std::map<Time, Counts> slots() const {
+    std::map<Time, Counts> slots;
+    for (const std::pair<const Time, Slot> &slot : slots_) {
+      slots.insert(slots.end(), {slot.first, slot.second.counts});
+    }
+    return slots;
+  }
+
+  // the latest scanning period and devices per category in it
+  const Period &latestPeriod() const { return latest_.period; }
+  const Counts &latest() const { return latest_.counts; }
+
+  const Time::duration &slot() const { return slot_; }
+
+  // start of the slot that contains the given time
+  Time slotStart(const Time &time) const {
+    const Time::duration offset = time - base_;
+    std::int64_t n = offset / slot_;
+    if (offset < slot_ * n) {
+      --n; // round towards negative infinity
+    }
+    return base_ + slot_ * n;
+  }
+
+  // make a CSV, each line is '<slot start>, <slot end>, <category>, <devices>'
+  CSV toCSV(const std::string &time_fmt = Time::defaultFormat()) const {
+    CSV csv;
+    for (const std::pair<const Time, Slot> &slot : slots_) {
+      const std::string start = slot.first.toStr(time_fmt),
+                        end = Time(slot.first + slot_).toStr(time_fmt);
+      for (const Counts::value_type &count : slot.second.counts) {
+        csv.push_back({start, end, count.first, boost::lexical_cast<std::string>(count.second)});
+      }
+    }
+    return csv;
+  }
+
+  // make a JSON like
+  //   {"latest": {"start": "...", "end": "...", "devices": {"<category>": n, ...}},
+  //    "slots": [{"start": "...", "end": "...", "devices": {...}}, ...]}
+  std::string toJSON(const std::string &time_fmt = Time::defaultFormat()) const {
+    std::ostringstream oss;
+    oss << "{\"latest\": ";
+    writeJSONCounts(oss, latest_.period.first, latest_.period.second, latest_.counts, time_fmt);
+    oss << ",\n \"slots\": [";
+    for (std::map<Time, Slot>::const_iterator it = slots_.begin(); it != slots_.end(); ++it) {
+      oss << (it != slots_.begin() ? ",\n   " : "\n   ");
+      writeJSONCounts(oss, it->first, it->first + slot_, it->second.counts, time_fmt);
+    }
+    oss << "]}\n";
+    return oss.str();
+  }
+
+  // rows like "['<category>', new Date(<start>), new Date(<end>), <devices>]"
+  // which replace '@OCCUPANCY_ENTRIES@' in the HTML template
+  std::string toHTMLEntries() const {
+    namespace sc = std::chrono;
+    std::ostringstream oss;
+    for (const std::pair<const Time, Slot> &slot : slots_) {
+      const std::int64_t start =
+          sc::duration_cast<sc::milliseconds>(slot.first.time_since_epoch()).count();
+      const std::int64_t end = start + sc::duration_cast<sc::milliseconds>(slot_).count();
+      for (const Counts::value_type &count : slot.second.counts) {
+        if (oss.tellp() > 0) {
+          oss << "," << std::endl;
+        }
+        oss << "['" << count.first << "', new Date(" << start << "), new Date(" << end << "), "
+            << count.second << "]";
+      }
+    }
+    return oss.str();
+  }
+
+private:
+  struct Slot {
+    Counts counts;
+    std::unordered_set<std::uint64_t> devices; // by Address::toInt()
+  };
+
+  struct Latest : Slot {
+    Period period;
+  };
+
+  // forget devices of slots ended by the given time, which will not be counted anymore
+  void seal(const Time &time) {
+    for (std::map<Time, Slot>::iterator it = slots_.lower_bound(unsealed_);
+         it != slots_.end() && it->first + slot_ <= time; ++it) {
+      std::unordered_set<std::uint64_t>().swap(it->second.devices);
+      unsealed_ = it->first + slot_;
+    }
+  }
+
+  static void writeJSONCounts(std::ostream &os, const Time &start, const Time &end,
+                              const Counts &counts, const std::string &time_fmt) {
+    os << "{\"start\": " << jsonString(start.toStr(time_fmt))
+       << ", \"end\": " << jsonString(end.toStr(time_fmt)) << ", \"devices\": {";
+    for (Counts::const_iterator it = counts.begin(); it != counts.end(); ++it) {
+      os << (it != counts.begin() ? ", " : "") << jsonString(it->first) << ": " << it->second;
+    }
+    os << "}}";
+  }
+
+  static std::string jsonString(const std::string &str) {
+    std::string quoted = "\"";
+    for (const char c : str) {
+      if (c == '"' || c == '\\') {
+        quoted += '\\';
+        quoted += c;
+      } else if (static_cast<unsigned char>(c) < 0x20) {
+        static const char digits[] = "0123456789abcdef";
+        quoted += "\\u00";
+        quoted += digits[(c >> 4) & 0xF];
+        quoted += digits[c & 0xF];
+      } else {
+        quoted += c;
+      }
+    }
+    return quoted + "\"";
+  }
+
+  friend class Writable<Occupancy>;
+
+  void write(std::ostream &os) const { os << toCSV(); }
+
+private:
+  Time base_;
+  Time::duration slot_;
+  std::map<Time, Slot> slots_;
+  Time unsealed_; // start of the first slot whose devices are kept
+  Latest latest_;
+};
+} // namespace mac_time_tracker
+
+#endif
@@ -0,0 +1,239 @@
+#ifndef MAC_TIME_TRACKER_OUTPUT_SINK_HPP
+#define MAC_TIME_TRACKER_OUTPUT_SINK_HPP
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <poll.h>       // for poll()
+#include <sys/socket.h> // for socket(), connect(), send()
+#include <sys/un.h>     // for sockaddr_un
+#include <unistd.h>     // for close()
+
+namespace mac_time_tracker {
+
+////////////////////////////////////////////
+// Destination of a serialized output
+
+class OutputSink {
+public:
+  virtual ~OutputSink() {}
+
+  virtual void write(const std::string &content) = 0;
+
+  // a sink for a destination; '-' is the stdout, 'unix:<path>' is a unix domain socket
+  // and others are files
+  static std::unique_ptr<OutputSink> fromDestination(const std::string &destination);
+
+  static bool isFile(const std::string &destination) {
+    return destination != "-" && destination.compare(0, 5, "unix:") != 0;
+  }
+};
+
+// overwrites a file
+class FileSink : public OutputSink {
+public:
+  explicit FileSink(const std::string &filename) : filename_(filename) {}
+
+  virtual void write(const std::string &content) override {
+    std::ofstream ofs(filename_);
+    if (!ofs) {
+      throw std::runtime_error("FileSink::write(): Cannot open '" + filename_ + "' to write");
+    }
+    ofs << content;
+    if (!ofs) {
+      throw std::runtime_error("FileSink::write(): Cannot write to '" + filename_ + "'");
+    }
+  }
+
+private:
+  std::string filename_;
+};
+
+class StdoutSink : public OutputSink {
+public:
+  virtual void write(const std::string &content) override { std::cout << content << std::flush; }
+};
+
+// connects to a listening stream socket and sends the content followed by EOF.
+// the socket never blocks, and a consumer that does not take the whole content
+// within the timeout (ex. reading slowly or not at all) is an error.
+class UnixSocketSink : public OutputSink {
+public:
+  explicit UnixSocketSink(const std::string &path,
+                          const std::chrono::milliseconds &timeout = std::chrono::seconds(1))
+      : path_(path), timeout_(timeout) {}
+
+  virtual void write(const std::string &content) override {
+    sockaddr_un addr = {};
+    if (path_.size() >= sizeof(addr.sun_path)) {
+      throw std::runtime_error("UnixSocketSink::write(): Too long path '" + path_ + "'");
+    }
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, path_.c_str(), sizeof(addr.sun_path) - 1);
+    const std::chrono::steady_clock::time_point deadline =
+        std::chrono::steady_clock::now() + timeout_;
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+      throw std::runtime_error("UnixSocketSink::write(): Cannot open a socket: " +
+                               std::string(std::strerror(errno)));
+    }
+    try {
+      // a full backlog of the listener fails with EAGAIN instead of waiting
+      while (::connect(fd, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr)) != 0) {
+        const int error = errno;
+        if (error != EAGAIN && error != EINTR) {
+          throw std::runtime_error("UnixSocketSink::write(): Cannot connect to '" + path_ +
+                                   "': " + std::strerror(error));
+        }
+        if (!waitUntil(-1, deadline)) {
+          throw std::runtime_error("UnixSocketSink::write(): Timed out connecting to '" + path_ +
+                                   "'");
+        }
+      }
+      for (std::size_t n_sent = 0; n_sent < content.size();) {
+        const ssize_t n = ::send(fd, content.data() + n_sent, content.size() - n_sent,
+                                 MSG_NOSIGNAL);
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+          if (!waitUntil(fd, deadline)) {
+            throw std::runtime_error("UnixSocketSink::write(): Timed out sending to '" + path_ +
+                                     "'");
+          }
+        } else if (n < 0 && errno != EINTR) {
+          throw std::runtime_error("UnixSocketSink::write(): Cannot send to '" + path_ +
+                                   "': " + std::strerror(errno));
+        }
+        n_sent += n > 0 ? n : 0;
+      }
+    } catch (...) {
+      ::close(fd);
+      throw;
+    }
+    ::close(fd);
+  }
+
+private:
+  // wait until fd is writable, or for a while to retry if fd < 0.
+  // returns false if the deadline has passed.
+  static bool waitUntil(const int fd, const std::chrono::steady_clock::time_point &deadline) {
+    namespace sc = std::chrono;
+    const sc::steady_clock::duration rest = deadline - sc::steady_clock::now();
+    if (rest <= sc::steady_clock::duration::zero()) {
+      return false;
+    }
+    const int rest_ms = static_cast<int>(sc::duration_cast<sc::milliseconds>(rest).count()) + 1;
+    pollfd pfd = {fd, POLLOUT, 0};
+    ::poll(&pfd, fd < 0 ? 0 : 1, fd < 0 ? std::min(rest_ms, 10) : rest_ms);
+    return true;
+  }
+
+private:
+  std::string path_;
+  std::chrono::milliseconds timeout_;
+};
+
+inline std::unique_ptr<OutputSink> OutputSink::fromDestination(const std::string &destination) {
+  if (isFile(destination)) {
+    return std::unique_ptr<OutputSink>(new FileSink(destination));
+  }
+  if (destination == "-") {
+    return std::unique_ptr<OutputSink>(new StdoutSink());
+  }
+  return std::unique_ptr<OutputSink>(new UnixSocketSink(destination.substr(5)));
+}
+
+//////////////////////////////////////////////////////////////////////////////////////
+// Set of sinks that receive the same content, which is serialized once by the caller.
+// remembers the hash of the last written content and skips writing the same one,
+// so idle scans cause no writes. a failure of a sink stops neither the other sinks
+// nor the caller. the sink is retried on the next write even if the content is unchanged,
+// and its error is kept until then.
+
+class OutputFanOut {
+public:
+  explicit OutputFanOut(const std::vector<std::string> &destinations = {})
+      : requested_(false), last_hash_(0) {
+    for (const std::string &destination : destinations) {
+      sinks_.push_back({OutputSink::fromDestination(destination), false, 0});
+    }
+  }
+
+  // write the content to all sinks unless it is unchanged. returns false if unchanged.
+  bool write(const std::string &content) { return write(content, content); }
+
+  // same as above except that the change is detected by the key instead of the content
+  // (ex. the content without the update time)
+  bool write(const std::string &content, const std::string &key) {
+    const std::uint64_t hash = hashOf(key);
+    const bool changed = !requested_ || hash != last_hash_;
+    requested_ = true;
+    last_hash_ = hash;
+    errors_.clear();
+    for (Sink &sink : sinks_) {
+      if (sink.written && sink.hash == hash) {
+        continue;
+      }
+      try {
+        sink.sink->write(content);
+        sink.written = true;
+        sink.hash = hash;
+      } catch (const std::exception &err) {
+        sink.written = false;
+        errors_.push_back(err.what());
+      }
+    }
+    return changed;
+  }
+
+  // true if all sinks have the last content, i.e. false until the first write
+  // or while any sink is failing
+  bool written() const {
+    if (!requested_) {
+      return false;
+    }
+    for (const Sink &sink : sinks_) {
+      if (!sink.written || sink.hash != last_hash_) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // messages of sinks that failed on the last write
+  const std::vector<std::string> &errors() const { return errors_; }
+
+  std::size_t size() const { return sinks_.size(); }
+
+  // 64-bit FNV-1a
+  static std::uint64_t hashOf(const std::string &str) {
+    std::uint64_t hash = 0xCBF29CE484222325ull;
+    for (const char c : str) {
+      hash = (hash ^ static_cast<unsigned char>(c)) * 0x100000001B3ull;
+    }
+    return hash;
+  }
+
+private:
+  struct Sink {
+    std::unique_ptr<OutputSink> sink;
+    bool written;
+    std::uint64_t hash; // of the content written last
+  };
+
+  std::vector<Sink> sinks_;
+  bool requested_;
+  std::uint64_t last_hash_; // of the content requested last
+  std::vector<std::string> errors_;
+};
+} // namespace mac_time_tracker
+
+#endif
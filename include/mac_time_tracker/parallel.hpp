@@ -0,0 +1,48 @@
+#ifndef MAC_TIME_TRACKER_PARALLEL_HPP
+#define MAC_TIME_TRACKER_PARALLEL_HPP
+
+#include <algorithm>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace mac_time_tracker {
+
+// number of threads to use. 0 means the number of hardware threads.
+inline unsigned int resolveThreads(const unsigned int n_threads) {
+  return n_threads > 0 ? n_threads : std::max(std::thread::hardware_concurrency(), 1u);
+}
+
+// call func(i) for each i in [0, n) on its own thread (i = 0 on the calling thread).
+// after all calls finish, rethrow the exception from the smallest i if any.
+template <class Func> void parallelFor(const unsigned int n, const Func &func) {
+  std::vector<std::exception_ptr> errors(n);
+  std::vector<std::thread> threads;
+  for (unsigned int i = 1; i < n; ++i) {
+    threads.emplace_back([&func, &errors, i]() {
+      try {
+        func(i);
+      } catch (...) {
+        errors[i] = std::current_exception();
+      }
+    });
+  }
+  if (n > 0) {
+    try {
+      func(0);
+    } catch (...) {
+      errors[0] = std::current_exception();
+    }
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  for (const std::exception_ptr &error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+}
+} // namespace mac_time_tracker
+
+#endif
@@ -1,21 +1,27 @@
 #ifndef MAC_TIME_TRACKER_PERIOD_MAP_HPP
 #define MAC_TIME_TRACKER_PERIOD_MAP_HPP
 
+#include <algorithm>
 #include <chrono>
 #include <fstream>
 #include <iostream>
+#include <iterator> // for std::iterator_traits<>, std::distance(), std::advance()
 #include <map>
 #include <sstream>
 #include <stdexcept>
 #include <string>
 #include <utility> // for std::pair<>
+#include <vector>
 
 #include <mac_time_tracker/address.hpp>
 #include <mac_time_tracker/csv.hpp>
 #include <mac_time_tracker/io.hpp>
+#include <mac_time_tracker/parallel.hpp>
 #include <mac_time_tracker/time.hpp>
 
 #include <boost/algorithm/string/replace.hpp>
+#include <boost/algorithm/string/trim.hpp>
+#include <boost/lexical_cast.hpp>
 
 namespace mac_time_tracker {
 
@@ -33,7 +39,9 @@ struct PeriodMapTraits {
   using Base = std::multimap<Period, Info>;
 };
 
-class PeriodMap : public PeriodMapTraits::Base, public Writable {
+class PeriodMap : public PeriodMapTraits::Base,
+                  public Readable<PeriodMap>,
+                  public Writable<PeriodMap> {
 private:
   using Base = PeriodMapTraits::Base;
 
@@ -46,6 +54,33 @@ public:
   PeriodMap(const Base &base) : Base(base) {}
   PeriodMap(Base &&base) : Base(base) {}
 
+  // Create an instance from a CSV made by toCSV(),
+  // each line is '<start>, <end>, <address>, <category>, <description>'
+  static PeriodMap fromCSV(const CSV &csv, const std::string &time_fmt = Time::defaultFormat()) {
+    PeriodMap map;
+    for (std::size_t i = 0; i < csv.size(); ++i) {
+      try {
+        map.insert(map.end(), entryFromCSV(csv[i], time_fmt));
+      } catch (const std::runtime_error &err) {
+        throw std::runtime_error(std::string(err.what()) + " on the line " +
+                                 boost::lexical_cast<std::string>(i));
+      }
+    }
+    return map;
+  }
+
+  // parse a line of CSV made by toCSV()
+  static value_type entryFromCSV(const std::vector<std::string> &line,
+                                 const std::string &time_fmt = Time::defaultFormat()) {
+    if (line.size() != 5) {
+      throw std::runtime_error("PeriodMap::entryFromCSV(): Each line must have 5 elements but " +
+                               boost::lexical_cast<std::string>(line.size()) + " given");
+    }
+    return {{Time::fromStr(boost::trim_copy(line[0]), time_fmt),
+             Time::fromStr(boost::trim_copy(line[1]), time_fmt)},
+            {Address::fromStr(line[2]), line[3], line[4]}};
+  }
+
   // returns a copy of this after filling empty slots less than max_fill.
   // when inserting a filling entry, append desc_suffix to the description.
   PeriodMap filled(const Time::duration &max_fill, const std::string &desc_suffix = "*") const {
@@ -75,59 +110,154 @@ public:
   // make a CSV, each line is '<timestamp>, <address>, <category>, <description>'
   CSV toCSV(const std::string &time_fmt = Time::defaultFormat(),
             const char addr_sep = Address::defaultSeparator()) const {
+    return rangeToCSV(begin(), end(), time_fmt, addr_sep);
+  }
+
+  // toCSV() for entries in [first, last) of any container sorted like PeriodMap.
+  // the iterators may return entries by value (ex. ColumnarPeriodMap::const_iterator).
+  template <class Iterator>
+  static CSV rangeToCSV(const Iterator first, const Iterator last,
+                        const std::string &time_fmt = Time::defaultFormat(),
+                        const char addr_sep = Address::defaultSeparator()) {
     CSV csv;
-    for (const value_type &val : *this) {
-      const Period &period = val.first;
-      const Info &info = val.second;
-      csv.push_back(
-          std::vector<std::string>{period.first.toStr(time_fmt), period.second.toStr(time_fmt),
-                                   info.address.toStr(addr_sep), info.category, info.description});
+    for (Iterator it = first; it != last; ++it) {
+      const typename std::iterator_traits<Iterator>::value_type &entry = *it;
+      csv.push_back(entryToCSV(entry.first, entry.second, time_fmt, addr_sep));
     }
     return csv;
   }
 
+  static std::vector<std::string> entryToCSV(const Period &period, const Info &info,
+                                             const std::string &time_fmt = Time::defaultFormat(),
+                                             const char addr_sep = Address::defaultSeparator()) {
+    return {period.first.toStr(time_fmt), period.second.toStr(time_fmt),
+            info.address.toStr(addr_sep), info.category, info.description};
+  }
+
+  // write a HTML by replacing '@DATE@' and '@DATA_ENTRIES@' in the template
+  // to the update time and the entries, and '@OCCUPANCY_ENTRIES@' to nothing.
+  // the entries are formatted on n_threads threads (0 means the number of hardware threads)
+  // but the result is the same as on a thread.
   void toHTML(const std::string &filename, const std::string &template_str,
               const std::string &time_fmt = Time::defaultFormat(),
-              const char addr_sep = Address::defaultSeparator()) const {
+              const char addr_sep = Address::defaultSeparator(),
+              const Time &update_time = Time::now(), const unsigned int n_threads = 1) const {
+    rangeToHTML(begin(), end(), filename, template_str, time_fmt, addr_sep, update_time,
+                n_threads);
+  }
+
+  // toHTML() for entries in [first, last) like rangeToCSV()
+  template <class Iterator>
+  static void rangeToHTML(const Iterator first, const Iterator last, const std::string &filename,
+                          const std::string &template_str,
+                          const std::string &time_fmt = Time::defaultFormat(),
+                          const char addr_sep = Address::defaultSeparator(),
+                          const Time &update_time = Time::now(),
+                          const unsigned int n_threads = 1) {
     std::ofstream ofs(filename);
     if (!ofs) {
       throw std::runtime_error("TimeMap::toHTML(): Cannot open '" + filename + "' to write");
     }
+    ofs << fillHTMLTemplate(template_str,
+                            rangeToHTMLEntries(first, last, time_fmt, addr_sep, n_threads),
+                            update_time, time_fmt);
+  }
+
+  // replace '@DATE@', '@DATA_ENTRIES@' and '@OCCUPANCY_ENTRIES@' in the template.
+  // the occupancy entries are given by Occupancy::toHTMLEntries().
+  static std::string fillHTMLTemplate(const std::string &template_str,
+                                      const std::string &entries_str, const Time &update_time,
+                                      const std::string &time_fmt = Time::defaultFormat(),
+                                      const std::string &occupancy_str = "") {
+    std::string head = template_str;
+    boost::replace_all(head, "@DATE@", update_time.toStr(time_fmt));
+    boost::replace_all(head, "@OCCUPANCY_ENTRIES@", occupancy_str);
+    // the entries may be large, so they are copied once into the reserved result
+    static const std::string placeholder = "@DATA_ENTRIES@";
+    std::string str;
+    str.reserve(head.size() + entries_str.size());
+    std::string::size_type pos = 0;
+    for (std::string::size_type found; (found = head.find(placeholder, pos)) != std::string::npos;
+         pos = found + placeholder.size()) {
+      str.append(head, pos, found - pos);
+      str += entries_str;
+    }
+    str.append(head, pos, std::string::npos);
+    return str;
+  }
 
-    // replace '@DATE@' to last update date
-    std::string str = template_str;
-    boost::replace_all(str, "@DATE@", Time::now().toStr(time_fmt));
-
-    // replace '@DATA_ENTRIES@' to data
-    {
-      std::ostringstream entries_str;
-      for (const_iterator entry = begin(); entry != end(); ++entry) {
-        namespace sc = std::chrono;
-        if (entry != begin()) {
-          entries_str << "," << std::endl;
+  // rows of the data table for entries in [first, last), which replace '@DATA_ENTRIES@'.
+  // entries are split into contiguous chunks whose outputs are concatenated in order.
+  template <class Iterator>
+  static std::string rangeToHTMLEntries(const Iterator first, const Iterator last,
+                                        const std::string &time_fmt = Time::defaultFormat(),
+                                        const char addr_sep = Address::defaultSeparator(),
+                                        const unsigned int n_threads = 1) {
+    const std::size_t n_entries = std::distance(first, last);
+    const std::size_t n_chunks = std::min<std::size_t>(resolveThreads(n_threads), n_entries);
+    std::vector<Iterator> bounds(1, first);
+    for (std::size_t i = 1; i <= n_chunks; ++i) {
+      Iterator bound = bounds.back();
+      std::advance(bound, n_entries * i / n_chunks - n_entries * (i - 1) / n_chunks);
+      bounds.push_back(bound);
+    }
+    std::vector<std::string> chunks(n_chunks);
+    parallelFor(n_chunks, [&](const unsigned int i) {
+      std::ostringstream chunk;
+      for (Iterator it = bounds[i]; it != bounds[i + 1]; ++it) {
+        if (it != first) {
+          chunk << "," << std::endl;
         }
-        const Period &period = entry->first;
-        const Info &info = entry->second;
-        entries_str << "['" << info.category << "', "
-                    << "'" << info.address.toStr(addr_sep) << " (" << info.description << ")', "
-                    << "new Date("
-                    << sc::duration_cast<sc::milliseconds>(period.first.time_since_epoch()).count()
-                    << "), "
-                    << "new Date("
-                    << sc::duration_cast<sc::milliseconds>(period.second.time_since_epoch()).count()
-                    << ")] "
-                    << "/* " << period.first.toStr(time_fmt) << " to "
-                    << period.second.toStr(time_fmt) << " */";
+        const typename std::iterator_traits<Iterator>::value_type &entry = *it;
+        writeHTMLEntry(chunk, entry.first, entry.second, time_fmt, addr_sep);
       }
-      boost::replace_all(str, "@DATA_ENTRIES@", entries_str.str());
+      chunks[i] = chunk.str();
+    });
+    if (n_chunks == 1) {
+      return std::move(chunks[0]);
+    }
+    std::string entries_str;
+    std::size_t n_chars = 0;
+    for (const std::string &chunk : chunks) {
+      n_chars += chunk.size();
+    }
+    entries_str.reserve(n_chars);
+    for (const std::string &chunk : chunks) {
+      entries_str += chunk;
     }
+    return entries_str;
+  }
 
-    // finally write to the file
-    ofs << str;
+  // write an entry as a row of the data table in the HTML template
+  static void writeHTMLEntry(std::ostream &os, const Period &period, const Info &info,
+                             const std::string &time_fmt = Time::defaultFormat(),
+                             const char addr_sep = Address::defaultSeparator()) {
+    namespace sc = std::chrono;
+    os << "['" << info.category << "', "
+       << "'" << info.address.toStr(addr_sep) << " (" << info.description << ")', "
+       << "new Date("
+       << sc::duration_cast<sc::milliseconds>(period.first.time_since_epoch()).count() << "), "
+       << "new Date("
+       << sc::duration_cast<sc::milliseconds>(period.second.time_since_epoch()).count() << ")] "
+       << "/* " << period.first.toStr(time_fmt) << " to " << period.second.toStr(time_fmt)
+       << " */";
   }
 
 private:
-  virtual void write(std::ostream &os) const override { os << toCSV(); }
+  friend class Readable<PeriodMap>;
+  friend class Writable<PeriodMap>;
+
+  void read(std::istream &is) {
+    CSV csv;
+    is >> csv;
+    try {
+      *this = fromCSV(csv);
+    } catch (const std::runtime_error &) {
+      is.setstate(std::istream::failbit);
+    }
+  }
+
+  void write(std::ostream &os) const { os << toCSV(); }
 };
 
 } // namespace mac_time_tracker
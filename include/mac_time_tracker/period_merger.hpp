@@ -0,0 +1,114 @@
+#ifndef MAC_TIME_TRACKER_PERIOD_MERGER_HPP
+#define MAC_TIME_TRACKER_PERIOD_MERGER_HPP
+
+#include <algorithm>
+#include <functional> // for std::greater<>
+#include <iostream>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <tuple>   // for std::tie()
+#include <utility> // for std::pair<>
+#include <vector>
+
+#include <boost/lexical_cast.hpp>
+
+#include <mac_time_tracker/csv.hpp>
+#include <mac_time_tracker/period_map.hpp>
+#include <mac_time_tracker/time.hpp>
+
+namespace mac_time_tracker {
+
+///////////////////////////////////////////////////////////////////////////////////////////
+// K-way merge of CSV streams made by PeriodMap::toCSV() (i.e. entries sorted by period).
+// entries are read line by line and emitted in groups of the same period without duplicates,
+// so memory usage depends on the number of inputs and entries per period, not the history.
+
+class PeriodMerger {
+public:
+  using Entry = std::pair<PeriodMap::Period, PeriodMap::Info>;
+
+public:
+  explicit PeriodMerger(const std::vector<std::istream *> &inputs,
+                        const std::string &time_fmt = Time::defaultFormat())
+      : inputs_(inputs), heads_(inputs.size()), started_(inputs.size(), false),
+        time_fmt_(time_fmt) {
+    for (std::size_t i = 0; i < inputs_.size(); ++i) {
+      if (advance(i)) {
+        queue_.push({heads_[i].first, i});
+      }
+    }
+  }
+
+  // read the next group of unique entries having the same period.
+  // returns false if all the inputs have been consumed.
+  bool next(std::vector<Entry> *const group) {
+    group->clear();
+    if (queue_.empty()) {
+      return false;
+    }
+    const PeriodMap::Period period = queue_.top().first;
+    while (!queue_.empty() && queue_.top().first == period) {
+      const std::size_t i = queue_.top().second;
+      queue_.pop();
+      // take all entries of the period from this input, then queue it again if not consumed
+      while (true) {
+        group->push_back(heads_[i]);
+        if (!advance(i)) {
+          break;
+        } else if (heads_[i].first != period) {
+          queue_.push({heads_[i].first, i});
+          break;
+        }
+      }
+    }
+    // sort and remove duplicates
+    std::sort(group->begin(), group->end(), &lessInfo);
+    group->erase(std::unique(group->begin(), group->end(),
+                             [](const Entry &a, const Entry &b) {
+                               return !lessInfo(a, b) && !lessInfo(b, a);
+                             }),
+                 group->end());
+    return true;
+  }
+
+private:
+  // read the next entry of the input to its head.
+  // returns false if the input has been consumed.
+  bool advance(const std::size_t i) {
+    std::vector<std::string> line;
+    if (!CSV::readLine(*inputs_[i], &line)) {
+      if (inputs_[i]->bad()) {
+        throw std::runtime_error("PeriodMerger::advance(): Cannot read the input " +
+                                 boost::lexical_cast<std::string>(i));
+      }
+      return false;
+    }
+    const Entry entry = PeriodMap::entryFromCSV(line, time_fmt_);
+    if (started_[i] && entry.first < heads_[i].first) {
+      throw std::runtime_error("PeriodMerger::advance(): The input " +
+                               boost::lexical_cast<std::string>(i) + " is not sorted by period");
+    }
+    heads_[i] = entry;
+    started_[i] = true;
+    return true;
+  }
+
+  // order of entries in a group
+  static bool lessInfo(const Entry &a, const Entry &b) {
+    return std::tie(a.second.address, a.second.category, a.second.description) <
+           std::tie(b.second.address, b.second.category, b.second.description);
+  }
+
+private:
+  std::vector<std::istream *> inputs_;
+  std::vector<Entry> heads_;
+  std::vector<bool> started_;
+  std::string time_fmt_;
+  // min-heap of the period of heads and the index of the input
+  using QueueItem = std::pair<PeriodMap::Period, std::size_t>;
+  std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue_;
+};
+} // namespace mac_time_tracker
+
+#endif
@@ -0,0 +1,211 @@
+#ifndef MAC_TIME_TRACKER_PRESENCE_MATRIX_HPP
+#define MAC_TIME_TRACKER_PRESENCE_MATRIX_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <mac_time_tracker/address.hpp>
+#include <mac_time_tracker/bit_kernels.hpp>
+#include <mac_time_tracker/period_map.hpp>
+#include <mac_time_tracker/time.hpp>
+
+namespace mac_time_tracker {
+
+/////////////////////////////////////////////////////////////////////////////////////////
+// Presence of devices in a period as a bit matrix of device x slot,
+// where the period is divided into fixed-length slots (ex. scan intervals).
+// each row is padded by zeros at least as long as the slots, so the whole matrix can be
+// shifted as a bit vector without carrying bits of a row into the next one.
+// statistics run on BitKernels, which use AVX2 if available.
+
+class PresenceMatrix {
+public:
+  using Period = PeriodMapTraits::Period;
+  using Info = PeriodMapTraits::Info;
+
+public:
+  PresenceMatrix(const Time &start, const Time::duration &slot, const std::size_t n_slots)
+      : start_(start), slot_(slot), n_slots_(n_slots),
+        row_words_((2 * n_slots + 255) / 256 * 4) {}
+
+  // build from entries in [first, last) of any container like PeriodMap
+  template <class Iterator>
+  static PresenceMatrix fromRange(const Iterator first, const Iterator last, const Time &start,
+                                  const Time::duration &slot, const std::size_t n_slots) {
+    PresenceMatrix matrix(start, slot, n_slots);
+    for (Iterator it = first; it != last; ++it) {
+      const typename std::iterator_traits<Iterator>::value_type &entry = *it;
+      matrix.insert(entry.first, entry.second);
+    }
+    return matrix;
+  }
+
+  // mark slots overlapping the period as present for the device.
+  // a device is identified by its address and keeps the info on its first insertion.
+  void insert(const Period &period, const Info &info) {
+    const std::pair<std::unordered_map<std::uint64_t, std::size_t>::iterator, bool> row =
+        row_ids_.insert({info.address.toInt(), devices_.size()});
+    if (row.second) {
+      devices_.push_back(info);
+      bits_.resize(bits_.size() + row_words_, 0);
+    }
+    const std::int64_t slot_ticks = slot_.count();
+    const std::int64_t first = std::max<std::int64_t>(
+                           floorDiv((period.first - start_).count(), slot_ticks), 0),
+                       last = std::min<std::int64_t>(
+                           floorDiv((period.second - start_).count() + slot_ticks - 1, slot_ticks),
+                           n_slots_);
+    std::uint64_t *const row_bits = &bits_[row.first->second * row_words_];
+    for (std::int64_t i = first; i < last; ++i) {
+      row_bits[i / 64] |= std::uint64_t(1) << (i % 64);
+    }
+  }
+
+  std::size_t rows() const { return devices_.size(); }
+  std::size_t slots() const { return n_slots_; }
+  const Time &start() const { return start_; }
+  const Time::duration &slot() const { return slot_; }
+  const Info &device(const std::size_t row) const { return devices_[row]; }
+
+  bool test(const std::size_t row, const std::size_t slot) const {
+    return (bits_[row * row_words_ + slot / 64] >> (slot % 64)) & 1;
+  }
+
+  // returns a copy of this after filling gaps between present slots up to max_fill,
+  // like PeriodMap::filled(). gaps before the first or after the last present slot remain.
+  // this is a closing of each row, i.e. a dilation by max_fill slots followed by an erosion.
+  PresenceMatrix filled(const Time::duration &max_fill, const bool simd = BitKernels::hasAVX2())
+      const {
+    PresenceMatrix ret = *this;
+    const std::size_t n_fill = std::min<std::size_t>(max_fill / slot_, n_slots_);
+    if (n_fill == 0 || bits_.empty()) {
+      return ret;
+    }
+    // the window of each step doubles, swapping the source and destination buffers.
+    std::vector<std::uint64_t> src = bits_, dst(bits_.size());
+    // dilation; a bit is set if any of itself and the preceding n_fill bits is set.
+    // the row padding receives bits after the last present slot of the row.
+    for (std::size_t width = 1; width < n_fill + 1;) {
+      const std::size_t shift = std::min(width, n_fill + 1 - width);
+      BitKernels::orShiftedUp(dst.data(), src.data(), src.size(), shift, simd);
+      src.swap(dst);
+      width += shift;
+    }
+    // erosion; a bit remains if all of itself and the following n_fill bits are set
+    for (std::size_t width = 1; width < n_fill + 1;) {
+      const std::size_t shift = std::min(width, n_fill + 1 - width);
+      BitKernels::andShiftedDown(dst.data(), src.data(), src.size(), shift, simd);
+      src.swap(dst);
+      width += shift;
+    }
+    ret.bits_.swap(src);
+    ret.clearPadding();
+    return ret;
+  }
+
+  // number of present slots of a device, or of all the devices
+  std::size_t presentSlots(const std::size_t row, const bool simd = BitKernels::hasAVX2()) const {
+    return BitKernels::popcount(&bits_[row * row_words_], row_words_, simd);
+  }
+  std::size_t totalPresentSlots(const bool simd = BitKernels::hasAVX2()) const {
+    return BitKernels::popcount(bits_.data(), bits_.size(), simd);
+  }
+
+  // total present time of each device
+  std::vector<Time::duration> presence(const bool simd = BitKernels::hasAVX2()) const {
+    std::vector<Time::duration> durations;
+    durations.reserve(rows());
+    for (std::size_t row = 0; row < rows(); ++row) {
+      durations.push_back(slot_ * std::int64_t(presentSlots(row, simd)));
+    }
+    return durations;
+  }
+
+  // matrix of categories x categories where element (i, j) is the number of slots
+  // in which any device of categories[i] and any device of categories[j] are present.
+  // diagonal elements are slots in which each category is present.
+  std::vector<std::vector<std::size_t>> coPresence(std::vector<std::string> *const categories,
+                                                   const bool simd = BitKernels::hasAVX2()) const {
+    // presence of each category as the union of rows of its devices
+    std::map<std::string, std::vector<std::uint64_t>> category_bits;
+    for (std::size_t row = 0; row < rows(); ++row) {
+      std::vector<std::uint64_t> &union_bits = category_bits[devices_[row].category];
+      union_bits.resize(row_words_, 0);
+      const std::uint64_t *const row_bits = &bits_[row * row_words_];
+      for (std::size_t i = 0; i < row_words_; ++i) {
+        union_bits[i] |= row_bits[i];
+      }
+    }
+    categories->clear();
+    std::vector<const std::vector<std::uint64_t> *> unions;
+    for (const std::pair<const std::string, std::vector<std::uint64_t>> &category :
+         category_bits) {
+      categories->push_back(category.first);
+      unions.push_back(&category.second);
+    }
+    std::vector<std::vector<std::size_t>> counts(unions.size(),
+                                                 std::vector<std::size_t>(unions.size()));
+    for (std::size_t i = 0; i < unions.size(); ++i) {
+      for (std::size_t j = i; j < unions.size(); ++j) {
+        counts[i][j] = counts[j][i] =
+            BitKernels::popcountAnd(unions[i]->data(), unions[j]->data(), row_words_, simd);
+      }
+    }
+    return counts;
+  }
+
+  // present slots as entries of PeriodMap, a run of slots per entry
+  PeriodMap toPeriodMap() const {
+    PeriodMap map;
+    for (std::size_t row = 0; row < rows(); ++row) {
+      for (std::size_t slot = 0; slot < n_slots_;) {
+        if (!test(row, slot)) {
+          ++slot;
+          continue;
+        }
+        const std::size_t first = slot;
+        while (slot < n_slots_ && test(row, slot)) {
+          ++slot;
+        }
+        map.insert({{start_ + slot_ * std::int64_t(first), start_ + slot_ * std::int64_t(slot)},
+                    devices_[row]});
+      }
+    }
+    return map;
+  }
+
+private:
+  static std::int64_t floorDiv(const std::int64_t a, const std::int64_t b) {
+    return a / b - (a % b != 0 && (a < 0) != (b < 0) ? 1 : 0);
+  }
+
+  // zero bits after the slots of each row
+  void clearPadding() {
+    for (std::size_t row = 0; row < rows(); ++row) {
+      std::uint64_t *const row_bits = &bits_[row * row_words_];
+      if (n_slots_ % 64 != 0) {
+        row_bits[n_slots_ / 64] &= (std::uint64_t(1) << (n_slots_ % 64)) - 1;
+      }
+      std::fill(row_bits + (n_slots_ + 63) / 64, row_bits + row_words_, 0);
+    }
+  }
+
+private:
+  Time start_;
+  Time::duration slot_;
+  std::size_t n_slots_;
+  std::size_t row_words_; // multiple of 4 words (256 bits) for 2 * n_slots_ bits at least
+  std::vector<Info> devices_;
+  std::unordered_map<std::uint64_t, std::size_t> row_ids_; // by Address::toInt()
+  std::vector<std::uint64_t> bits_;                        // row-major
+};
+} // namespace mac_time_tracker
+
+#endif
@@ -0,0 +1,270 @@
+#ifndef MAC_TIME_TRACKER_SCAN_LOG_HPP
+#define MAC_TIME_TRACKER_SCAN_LOG_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <unistd.h> // for truncate()
+
+#include <mac_time_tracker/address.hpp>
+#include <mac_time_tracker/scan_records.hpp>
+#include <mac_time_tracker/set.hpp>
+#include <mac_time_tracker/time.hpp>
+
+namespace mac_time_tracker {
+
+/////////////////////////////////////////////////////////////////////////////////////////
+// Append-only binary log of raw scan results, which is a compact alternative to
+// the CSV of ScanRecords. each scan is stored as the difference from the previous one,
+// so a scan of stable devices costs a few bytes. layout;
+//   - magic "MTTSLOG" + version (8 bytes)
+//   - records, each of which is '<varint size of the rest> <payload>' and the payload is
+//     '<kind> <zigzag varint time in seconds> <addresses ...>'
+//       - Key:   time since the epoch, '<n> <addr>...' of the whole scan
+//       - Delta: time since the previous record, '<n> <addr>...' of left addresses
+//                and '<n> <addr>...' of arrived ones
+//     where sorted addresses are coded as varints of differences from the previous one.
+// a record broken by a crash while appending ends the log and is cut on the next append.
+
+class ScanLog {
+public:
+  // open a log to append to, which is created if it does not exist
+  explicit ScanLog(const std::string &filename)
+      : filename_(filename), has_header_(false), n_records_(0) {
+    std::ifstream ifs(filename, std::ios::binary);
+    const std::string data((std::istreambuf_iterator<char>(ifs)),
+                           std::istreambuf_iterator<char>());
+    if (data.empty()) {
+      return;
+    }
+    const std::size_t valid_size = parse(data, nullptr, &last_time_, &last_addrs_, &n_records_);
+    if (valid_size == 0) {
+      throw std::runtime_error("ScanLog::ScanLog(): '" + filename + "' is not a scan log");
+    }
+    if (valid_size < data.size() && ::truncate(filename.c_str(), valid_size) != 0) {
+      throw std::runtime_error("ScanLog::ScanLog(): Cannot cut a broken record of '" + filename +
+                               "'");
+    }
+    has_header_ = true;
+  }
+
+  void append(const Time &time, const Set &addrs) {
+    // a delta unless a key is smaller, e.g. on the first record
+    std::string record;
+    if (n_records_ > 0) {
+      record = encodeDelta(toSeconds(time) - toSeconds(last_time_), last_addrs_, addrs);
+    }
+    const std::string key = encodeKey(toSeconds(time), addrs);
+    if (n_records_ == 0 || key.size() < record.size()) {
+      record = key;
+    }
+
+    std::ofstream ofs(filename_, std::ios::binary | std::ios::app);
+    if (!ofs) {
+      throw std::runtime_error("ScanLog::append(): Cannot open '" + filename_ + "' to append");
+    }
+    std::string data;
+    if (!has_header_) {
+      data.assign(magic(), sizeof(std::uint64_t));
+    }
+    putVarint(&data, record.size());
+    data += record;
+    if (!ofs.write(data.data(), data.size()).flush()) {
+      throw std::runtime_error("ScanLog::append(): Cannot append to '" + filename_ + "'");
+    }
+    has_header_ = true;
+    last_time_ = time;
+    last_addrs_ = addrs;
+    ++n_records_;
+  }
+
+  std::size_t size() const { return n_records_; }
+
+  // load all records in a log. a broken record at the end is ignored.
+  static ScanRecords fromFile(const std::string &filename) {
+    std::ifstream ifs(filename, std::ios::binary);
+    if (!ifs) {
+      throw std::runtime_error("ScanLog::fromFile(): Cannot open '" + filename + "' to read");
+    }
+    const std::string data((std::istreambuf_iterator<char>(ifs)),
+                           std::istreambuf_iterator<char>());
+    ScanRecords records;
+    Time last_time;
+    Set last_addrs;
+    std::size_t n_records = 0;
+    if (parse(data, &records, &last_time, &last_addrs, &n_records) == 0) {
+      throw std::runtime_error("ScanLog::fromFile(): '" + filename + "' is not a scan log");
+    }
+    return records;
+  }
+
+  // true if the file begins with the magic of the log
+  static bool isLog(const std::string &filename) {
+    std::ifstream ifs(filename, std::ios::binary);
+    char head[sizeof(std::uint64_t)];
+    return ifs.read(head, sizeof(head)) && std::memcmp(head, magic(), sizeof(head)) == 0;
+  }
+
+private:
+  enum Kind { Key = 0, Delta = 1 };
+
+  static const char *magic() { return "MTTSLOG\x01"; } // the last byte is the version
+
+  static std::int64_t toSeconds(const Time &time) {
+    return std::chrono::duration_cast<std::chrono::seconds>(time.time_since_epoch()).count();
+  }
+
+  static std::string encodeKey(const std::int64_t time, const Set &addrs) {
+    std::string payload;
+    putVarint(&payload, Key);
+    putVarint(&payload, zigzag(time));
+    putAddresses(&payload, addrs.begin(), addrs.end());
+    return payload;
+  }
+
+  static std::string encodeDelta(const std::int64_t time_diff, const Set &last_addrs,
+                                 const Set &addrs) {
+    std::vector<Address> left, arrived;
+    std::set_difference(last_addrs.begin(), last_addrs.end(), addrs.begin(), addrs.end(),
+                        std::back_inserter(left));
+    std::set_difference(addrs.begin(), addrs.end(), last_addrs.begin(), last_addrs.end(),
+                        std::back_inserter(arrived));
+    std::string payload;
+    putVarint(&payload, Delta);
+    putVarint(&payload, zigzag(time_diff));
+    putAddresses(&payload, left.begin(), left.end());
+    putAddresses(&payload, arrived.begin(), arrived.end());
+    return payload;
+  }
+
+  // decode records into records (if not nullptr) and the last one if any.
+  // returns the size of the valid prefix of data, or 0 if the magic is wrong.
+  static std::size_t parse(const std::string &data, ScanRecords *const records,
+                           Time *const last_time, Set *const last_addrs,
+                           std::size_t *const n_records) {
+    if (data.size() < sizeof(std::uint64_t) ||
+        std::memcmp(data.data(), magic(), sizeof(std::uint64_t)) != 0) {
+      return 0;
+    }
+    const char *pos = data.data() + sizeof(std::uint64_t);
+    const char *const end = data.data() + data.size();
+    std::int64_t time = 0;
+    Set addrs;
+    while (pos != end) {
+      std::uint64_t size, kind, time_val;
+      const char *payload = pos;
+      if (!getVarint(&payload, end, &size) || size > std::uint64_t(end - payload)) {
+        break;
+      }
+      const char *const payload_end = payload + size;
+      Set next_addrs;
+      if (!getVarint(&payload, payload_end, &kind) ||
+          !getVarint(&payload, payload_end, &time_val)) {
+        break;
+      }
+      if (kind == Key && getAddresses(&payload, payload_end, &next_addrs)) {
+        time = unzigzag(time_val);
+      } else if (kind == Delta && *n_records > 0) {
+        Set left, arrived;
+        if (!getAddresses(&payload, payload_end, &left) ||
+            !getAddresses(&payload, payload_end, &arrived)) {
+          break;
+        }
+        std::set_difference(addrs.begin(), addrs.end(), left.begin(), left.end(),
+                            std::inserter(next_addrs, next_addrs.end()));
+        next_addrs.insert(arrived.begin(), arrived.end());
+        time += unzigzag(time_val);
+      } else {
+        break;
+      }
+      if (payload != payload_end) {
+        break;
+      }
+      addrs.swap(next_addrs);
+      ++*n_records;
+      if (records && !records->insert({Time(std::chrono::seconds(time)), addrs}).second) {
+        throw std::runtime_error("ScanLog::parse(): Cannot insert a record at '" +
+                                 Time(std::chrono::seconds(time)).toStr() +
+                                 "'. Non-unique timestamp?");
+      }
+      pos = payload_end;
+    }
+    if (*n_records > 0) {
+      *last_time = Time(std::chrono::seconds(time));
+      last_addrs->swap(addrs);
+    }
+    return pos - data.data();
+  }
+
+  static std::uint64_t zigzag(const std::int64_t val) {
+    return (std::uint64_t(val) << 1) ^ (val < 0 ? ~std::uint64_t(0) : 0);
+  }
+
+  static std::int64_t unzigzag(const std::uint64_t val) {
+    return std::int64_t(val >> 1) ^ -std::int64_t(val & 1);
+  }
+
+  static void putVarint(std::string *const out, std::uint64_t val) {
+    for (; val >= 0x80; val >>= 7) {
+      out->push_back(static_cast<char>((val & 0x7F) | 0x80));
+    }
+    out->push_back(static_cast<char>(val));
+  }
+
+  static bool getVarint(const char **const pos, const char *const end, std::uint64_t *const val) {
+    *val = 0;
+    for (int shift = 0; shift < 64 && *pos != end; shift += 7) {
+      const std::uint8_t byte = *(*pos)++;
+      *val |= std::uint64_t(byte & 0x7F) << shift;
+      if ((byte & 0x80) == 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // sorted addresses as differences from the previous one
+  template <class Iterator>
+  static void putAddresses(std::string *const out, const Iterator first, const Iterator last) {
+    putVarint(out, std::distance(first, last));
+    std::uint64_t prev = 0;
+    for (Iterator it = first; it != last; ++it) {
+      const std::uint64_t val = it->toInt();
+      putVarint(out, val - prev);
+      prev = val;
+    }
+  }
+
+  static bool getAddresses(const char **const pos, const char *const end, Set *const addrs) {
+    std::uint64_t n, val = 0;
+    if (!getVarint(pos, end, &n) || n > std::uint64_t(end - *pos)) {
+      return false;
+    }
+    for (std::uint64_t i = 0; i < n; ++i) {
+      std::uint64_t diff;
+      if (!getVarint(pos, end, &diff) || (i > 0 && diff == 0) || diff >= (1ull << 48) - val) {
+        return false;
+      }
+      val += diff;
+      addrs->insert(addrs->end(), Address::fromInt(val));
+    }
+    return true;
+  }
+
+private:
+  std::string filename_;
+  bool has_header_;
+  Time last_time_;
+  Set last_addrs_;
+  std::size_t n_records_;
+};
+} // namespace mac_time_tracker
+
+#endif
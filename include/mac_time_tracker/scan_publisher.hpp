@@ -0,0 +1,157 @@
+#ifndef MAC_TIME_TRACKER_SCAN_PUBLISHER_HPP
+#define MAC_TIME_TRACKER_SCAN_PUBLISHER_HPP
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio> // for std::remove()
+#include <cstring>
+#include <list>
+#include <stdexcept>
+#include <string>
+
+#include <sys/socket.h> // for socket(), bind(), listen(), accept4(), send()
+#include <sys/stat.h>   // for lstat()
+#include <sys/un.h>     // for sockaddr_un
+#include <unistd.h>     // for close()
+
+namespace mac_time_tracker {
+
+////////////////////////////////////////////////////////////////////////////////////////////
+// Publisher of messages to subscribers connected to a listening unix domain socket.
+// never blocks; each subscriber has a bounded buffer of unsent messages and a message
+// that does not fit in the buffer is dropped as a whole, except that a buffer without unsent
+// bytes takes a message of any size. the number of dropped messages is sent as a line
+// 'dropped,<n>' before the next message that is queued.
+// only a socket file is removed from the path, on both construction and destruction.
+// messages should end with a newline so that subscribers can split them.
+
+class ScanPublisher {
+public:
+  ScanPublisher(const std::string &path, const std::size_t max_buffer_size)
+      : path_(path), max_buffer_size_(max_buffer_size), n_dropped_(0) {
+    sockaddr_un addr = {};
+    if (path_.size() >= sizeof(addr.sun_path)) {
+      throw std::runtime_error("ScanPublisher::ScanPublisher(): Too long path '" + path_ + "'");
+    }
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, path_.c_str(), sizeof(addr.sun_path) - 1);
+    fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    if (fd_ < 0) {
+      throw std::runtime_error("ScanPublisher::ScanPublisher(): Cannot open a socket: " +
+                               std::string(std::strerror(errno)));
+    }
+    // a socket file left by the last run prevents binding.
+    // other files are never removed and make binding fail.
+    struct stat st;
+    if (::lstat(path_.c_str(), &st) == 0 && S_ISSOCK(st.st_mode)) {
+      std::remove(path_.c_str());
+    }
+    if (::bind(fd_, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr)) != 0 ||
+        ::listen(fd_, 16) != 0 || ::lstat(path_.c_str(), &st) != 0) {
+      const std::string error = std::strerror(errno);
+      ::close(fd_);
+      throw std::runtime_error("ScanPublisher::ScanPublisher(): Cannot listen on '" + path_ +
+                               "': " + error);
+    }
+    inode_ = st.st_ino;
+  }
+
+  ~ScanPublisher() {
+    for (const Subscriber &sub : subscribers_) {
+      ::close(sub.fd);
+    }
+    ::close(fd_);
+    // unless replaced by another file
+    struct stat st;
+    if (::lstat(path_.c_str(), &st) == 0 && S_ISSOCK(st.st_mode) && st.st_ino == inode_) {
+      std::remove(path_.c_str());
+    }
+  }
+
+  ScanPublisher(const ScanPublisher &) = delete;
+  ScanPublisher &operator=(const ScanPublisher &) = delete;
+
+  // queue the message to all subscribers including new ones, and send as much as possible
+  void publish(const std::string &message) {
+    accept();
+    for (Subscriber &sub : subscribers_) {
+      std::string dropped;
+      if (sub.n_dropped > 0) {
+        dropped = "dropped," + std::to_string(sub.n_dropped) + "\n";
+      }
+      const std::size_t unsent = sub.buffer.size() - sub.offset;
+      if (unsent > 0 && unsent + dropped.size() + message.size() > max_buffer_size_) {
+        ++sub.n_dropped;
+        ++n_dropped_;
+        continue;
+      }
+      // compact the sent part
+      sub.buffer.erase(0, sub.offset);
+      sub.offset = 0;
+      sub.buffer += dropped;
+      sub.buffer += message;
+      sub.n_dropped = 0;
+    }
+    flush();
+  }
+
+  // accept new subscribers and send buffered messages without blocking
+  void flush() {
+    accept();
+    for (std::list<Subscriber>::iterator sub = subscribers_.begin();
+         sub != subscribers_.end();) {
+      if (send(&*sub)) {
+        ++sub;
+      } else {
+        ::close(sub->fd);
+        sub = subscribers_.erase(sub);
+      }
+    }
+  }
+
+  std::size_t subscribers() const { return subscribers_.size(); }
+  // total number of messages dropped for slow subscribers
+  std::uint64_t dropped() const { return n_dropped_; }
+
+private:
+  struct Subscriber {
+    int fd;
+    std::string buffer;
+    std::size_t offset;      // of unsent bytes in the buffer
+    std::uint64_t n_dropped; // since the last queued message
+  };
+
+  void accept() {
+    while (true) {
+      const int fd = ::accept4(fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+      if (fd < 0) {
+        return; // EAGAIN, or an error of the connection which is just ignored
+      }
+      subscribers_.push_back({fd, std::string(), 0, 0});
+    }
+  }
+
+  // returns false if the subscriber is gone
+  static bool send(Subscriber *const sub) {
+    while (sub->offset < sub->buffer.size()) {
+      const ssize_t n = ::send(sub->fd, sub->buffer.data() + sub->offset,
+                               sub->buffer.size() - sub->offset, MSG_NOSIGNAL | MSG_DONTWAIT);
+      if (n < 0) {
+        return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+      }
+      sub->offset += n;
+    }
+    return true;
+  }
+
+private:
+  int fd_;
+  std::string path_;
+  ino_t inode_; // of the socket file
+  std::size_t max_buffer_size_;
+  std::list<Subscriber> subscribers_;
+  std::uint64_t n_dropped_;
+};
+} // namespace mac_time_tracker
+
+#endif
@@ -0,0 +1,177 @@
+#ifndef MAC_TIME_TRACKER_SCAN_RECORDS_HPP
+#define MAC_TIME_TRACKER_SCAN_RECORDS_HPP
+
+#include <algorithm>
+#include <cctype> // for std::isspace()
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/algorithm/string/trim.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <mac_time_tracker/address.hpp>
+#include <mac_time_tracker/address_scanner.hpp>
+#include <mac_time_tracker/csv.hpp>
+#include <mac_time_tracker/io.hpp>
+#include <mac_time_tracker/set.hpp>
+#include <mac_time_tracker/time.hpp>
+
+namespace mac_time_tracker {
+
+///////////////////////////////////////////////////////////////
+// Map from timestamp to scan result (i.e. addresses present)
+// to record scans and replay them later
+
+class ScanRecords : public std::map<Time, Set>,
+                    public Readable<ScanRecords>,
+                    public Writable<ScanRecords> {
+private:
+  using Base = std::map<Time, Set>;
+
+public:
+  using Base::Base;
+  ScanRecords(const Base &base) : Base(base) {}
+  ScanRecords(Base &&base) : Base(base) {}
+
+  // Create an instance from a CSV, each line is '<timestamp>, <address>, <address>, ...'
+  static ScanRecords fromCSV(const CSV &csv) {
+    ScanRecords records;
+    for (std::size_t i = 0; i < csv.size(); ++i) {
+      Time time;
+      Set set;
+      fromFields(csv[i], i, &time, &set);
+      records.insertRecord(time, set);
+    }
+    return records;
+  }
+
+  // make a CSV, each line is '<timestamp>, <address>, <address>, ...'
+  CSV toCSV(const std::string &time_fmt = Time::defaultFormat(),
+            const char addr_sep = Address::defaultSeparator()) const {
+    CSV csv;
+    for (const value_type &record : *this) {
+      std::vector<std::string> line(1, record.first.toStr(time_fmt));
+      for (const Address &addr : record.second) {
+        line.push_back(addr.toStr(addr_sep));
+      }
+      csv.push_back(line);
+    }
+    return csv;
+  }
+
+  // whether any scan is recorded in [from, to)
+  bool hasRecordIn(const Time &from, const Time &to) const {
+    const const_iterator it = lower_bound(from);
+    return it != end() && it->first < to;
+  }
+
+private:
+  friend class Readable<ScanRecords>;
+  friend class Writable<ScanRecords>;
+
+  // a line is tokenized only if parseLine() cannot read it,
+  // which makes reading a long history several times faster.
+  void read(std::istream &is) {
+    ScanRecords records;
+    std::string str;
+    std::vector<std::string> fields;
+    for (std::size_t i = 0; CSV::readRawLine(is, &str); ++i) {
+      Time time;
+      Set set;
+      const bool parsed = parseLine(str, &time, &set);
+      if (!parsed) {
+        CSV::splitLine(str, &fields);
+      }
+      try {
+        if (!parsed) {
+          fromFields(fields, i, &time, &set);
+        }
+        records.insertRecord(time, set);
+      } catch (const std::runtime_error &) {
+        is.setstate(std::istream::failbit);
+        return;
+      }
+    }
+    swap(records);
+  }
+
+  // parse the i-th line of a CSV. throws if the line is ill-formed.
+  static void fromFields(const std::vector<std::string> &line, const std::size_t i,
+                         Time *const time, Set *const set) {
+    if (line.empty()) {
+      throw std::runtime_error("ScanRecords::fromCSV(): The line " +
+                               boost::lexical_cast<std::string>(i) + " has no timestamp");
+    }
+    for (std::size_t j = 1; j < line.size(); ++j) {
+      set->insert(Address::fromStr(boost::trim_copy(line[j])));
+    }
+    *time = Time::fromStr(boost::trim_copy(line[0]));
+  }
+
+  // parse a line of plain fields without escapes, ex. '"<timestamp>","<address>",...'
+  // written by toCSV(), finding addresses by AddressScanner.
+  // returns false unless the fields are read as same as fromFields() does.
+  static bool parseLine(const std::string &str, Time *const time, Set *const set) {
+    const char *const end = str.data() + str.size();
+    if (str.find('\\') != std::string::npos) {
+      return false;
+    }
+    const char *field = std::find(str.data(), end, ','), *first, *last;
+    if (!unquote(str.data(), field, &first, &last) || !Time::fromChars(first, last, time)) {
+      return false;
+    }
+    std::vector<const char *> matches;
+    AddressScanner::find(field, end, std::back_inserter(matches));
+    // each field is exactly one of the matches
+    for (const char *const match : matches) {
+      if (field == end) {
+        return false;
+      }
+      const char *const next = std::find(field + 1, end, ',');
+      if (!unquote(field + 1, next, &first, &last) || first != match ||
+          last != match + AddressScanner::length()) {
+        return false;
+      }
+      set->insert(set->end(), AddressScanner::decode(match));
+      field = next;
+    }
+    return field == end;
+  }
+
+  // trim spaces of a field and then quotes and spaces again, as tokenizing and trimming do.
+  // returns false if quotes are left.
+  static bool unquote(const char *first, const char *last, const char **const content_first,
+                      const char **const content_last) {
+    for (int i = 0; i < 2; ++i) {
+      while (first != last && std::isspace(static_cast<unsigned char>(*first))) {
+        ++first;
+      }
+      while (first != last && std::isspace(static_cast<unsigned char>(last[-1]))) {
+        --last;
+      }
+      if (i == 0 && last - first >= 2 && *first == '"' && last[-1] == '"') {
+        ++first;
+        --last;
+      }
+    }
+    *content_first = first;
+    *content_last = last;
+    return std::find(first, last, '"') == last;
+  }
+
+  void insertRecord(const Time &time, const Set &set) {
+    if (!insert({time, set}).second) {
+      throw std::runtime_error("ScanRecords::fromCSV(): Cannot insert a record at '" +
+                               time.toStr() + "'. Non-unique timestamp?");
+    }
+  }
+
+  void write(std::ostream &os) const { os << toCSV(); }
+};
+} // namespace mac_time_tracker
+
+#endif
@@ -0,0 +1,150 @@
+#ifndef MAC_TIME_TRACKER_SCAN_SCHEDULER_HPP
+#define MAC_TIME_TRACKER_SCAN_SCHEDULER_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <mac_time_tracker/clock.hpp>
+#include <mac_time_tracker/time.hpp>
+
+namespace mac_time_tracker {
+
+/////////////////////////////////////////////////////////////////////////////////////////
+// Counts of values in buckets [-inf, bounds[0]), [bounds[0], bounds[1]), ..., [bounds.back(), inf)
+
+class Histogram {
+public:
+  explicit Histogram(const std::vector<std::int64_t> &bounds)
+      : bounds_(bounds), counts_(bounds.size() + 1, 0) {
+    if (!std::is_sorted(bounds_.begin(), bounds_.end())) {
+      throw std::runtime_error("Histogram::Histogram(): Bounds must be sorted");
+    }
+  }
+
+  void add(const std::int64_t val) {
+    ++counts_[std::upper_bound(bounds_.begin(), bounds_.end(), val) - bounds_.begin()];
+  }
+
+  std::size_t total() const {
+    std::size_t total = 0;
+    for (const std::size_t count : counts_) {
+      total += count;
+    }
+    return total;
+  }
+
+  const std::vector<std::int64_t> &bounds() const { return bounds_; }
+  const std::vector<std::size_t> &counts() const { return counts_; }
+
+private:
+  std::vector<std::int64_t> bounds_;
+  std::vector<std::size_t> counts_;
+};
+
+/////////////////////////////////////////////////////////////////////////////////////////
+// Scheduler of scanning periods on the grid of (base + n * interval).
+// a cycle is the time from a wake-up to the next sleep, which should fit in its period.
+// if a cycle overruns its period, the periods that started and ended without a scan are
+// counted as missed. then the next scan runs immediately in the present period on catch-up,
+// or waits for the next period so that every scan starts on the grid.
+// lateness of wake-ups (jitter) and durations of cycles relative to the interval are
+// recorded to prove that the scans keep the sampling interval.
+
+class ScanScheduler {
+public:
+  using Period = std::pair<Time, Time>;
+
+  struct Stats {
+    Histogram jitter;               // lateness of wake-ups in microseconds
+    Histogram cycle;                // durations of cycles in percent of the interval
+    std::size_t missed, catch_ups;  // missed periods and scans started late
+
+    Stats()
+        : jitter({100, 1000, 10000, 100000, 1000000}), cycle({10, 25, 50, 75, 100}), missed(0),
+          catch_ups(0) {}
+  };
+
+public:
+  ScanScheduler(Clock *const clock, const Time &base, const Time::duration &interval,
+                const bool catch_up)
+      : clock_(clock), base_(base), interval_(interval), catch_up_(catch_up),
+        cycle_start_(clock->now()) {
+    if (interval_ <= Time::duration::zero()) {
+      throw std::runtime_error("ScanScheduler::ScanScheduler(): Interval must be positive");
+    }
+  }
+
+  // end the cycle of the given scanning period and sleep until the next period.
+  // returns the number of periods missed by an overrun, and whether the next scan
+  // is to catch up with the present period that has already started.
+  std::size_t sleepAfter(const Period &period, bool *const caught_up = nullptr) {
+    const Time now = clock_->now();
+    if (caught_up) {
+      *caught_up = false;
+    }
+    if (now <= period.second) { // ending just on the boundary is in time
+      sleepUntil(period.second);
+      return 0;
+    }
+    // periods between the end of the given one and the present one had no scan
+    const Time present = gridStart(now);
+    std::size_t missed = std::max<std::int64_t>((present - period.second) / interval_, 0);
+    if (catch_up_) {
+      endCycle(now);
+      cycle_start_ = now;
+      ++stats_.catch_ups;
+      if (caught_up) {
+        *caught_up = true;
+      }
+    } else {
+      ++missed; // the present period is also skipped
+      sleepUntil(present + interval_);
+    }
+    stats_.missed += missed;
+    return missed;
+  }
+
+  // end the cycle and sleep until the given time, recording the lateness of the wake-up
+  void sleepUntil(const Time &deadline) {
+    endCycle(clock_->now());
+    clock_->sleepUntil(deadline);
+    cycle_start_ = clock_->now();
+    stats_.jitter.add(std::max<std::int64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(cycle_start_ - deadline).count(),
+        0));
+  }
+
+  // start of the period on the grid that contains the given time
+  Time gridStart(const Time &time) const {
+    const Time::duration offset = time - base_;
+    std::int64_t n = offset / interval_;
+    if (offset < interval_ * n) {
+      --n; // round towards negative infinity
+    }
+    return base_ + interval_ * n;
+  }
+
+  // stats since the construction
+  const Stats &stats() const { return stats_; }
+
+private:
+  void endCycle(const Time &now) {
+    stats_.cycle.add((now - cycle_start_) * 100 / interval_);
+  }
+
+private:
+  Clock *clock_;
+  Time base_;
+  Time::duration interval_;
+  bool catch_up_;
+  Time cycle_start_;
+  Stats stats_;
+};
+} // namespace mac_time_tracker
+
+#endif
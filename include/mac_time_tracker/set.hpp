@@ -2,13 +2,16 @@
 #define MAC_TIME_TRACKER_SET_HPP
 
 #include <cstdio>
+#include <iterator>
 #include <memory>
 #include <set>
 #include <stdexcept>
+#include <string>
 
 #include <stdio.h> // for popen(), pclose()
 
 #include <mac_time_tracker/address.hpp>
+#include <mac_time_tracker/address_scanner.hpp>
 
 namespace mac_time_tracker {
 
@@ -26,25 +29,25 @@ public:
   Set(Base &&base) : Base(base) {}
 
   static Set fromARPScan(const std::string &options = defaultOptions()) {
-    const std::unique_ptr<FILE, int (*)(FILE *)> fp(
-        popen(("arp-scan " + options +
-               R"( | grep '\([0-9a-fA-F]\{2\}[-:]\)\{5\}\([0-9a-fA-F]\{2\}\)' --only-matching)")
-                  .c_str(),
-              "r"),
-        pclose);
+    const std::unique_ptr<FILE, int (*)(FILE *)> fp(popen(("arp-scan " + options).c_str(), "r"),
+                                                    pclose);
     if (!fp) {
       throw std::runtime_error("Set::fromARPScan(): popen");
     }
 
-    Set set;
-    while (true) {
-      char line[256];
-      if (!std::fgets(line, 256, fp.get())) {
-        break; // end of file
-      }
-      set.insert(Address::fromStr(line));
+    // the whole output is scanned at once
+    std::string output;
+    char buf[4096];
+    for (std::size_t n; (n = std::fread(buf, 1, sizeof(buf), fp.get())) > 0;) {
+      output.append(buf, n);
     }
+    return fromText(output.data(), output.data() + output.size());
+  }
 
+  // addresses found anywhere in [first, last) (ex. output of arp-scan)
+  static Set fromText(const char *const first, const char *const last) {
+    Set set;
+    AddressScanner::scan(first, last, std::inserter(set, set.end()));
     return set;
   }
 
@@ -0,0 +1,178 @@
+#ifndef MAC_TIME_TRACKER_SHARDED_SWEEPER_HPP
+#define MAC_TIME_TRACKER_SHARDED_SWEEPER_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility> // for std::pair<>
+
+#include <boost/lexical_cast.hpp>
+
+#include <mac_time_tracker/clock.hpp>
+#include <mac_time_tracker/set.hpp>
+#include <mac_time_tracker/time.hpp>
+
+namespace mac_time_tracker {
+
+/////////////////////////////////////////////////////////////////////////
+// Backend that scans a range of IPv4 addresses (in the host byte order)
+
+class RangeScanner {
+public:
+  virtual ~RangeScanner() {}
+
+  // scan addresses in [first, last] sending at most pps packets per second
+  virtual Set scan(std::uint32_t first, std::uint32_t last, unsigned int pps) = 0;
+};
+
+// runs arp-scan for a range with the interval between packets given by the rate
+class ArpScanRangeScanner : public RangeScanner {
+public:
+  // options must not include targets (ex. --localnet)
+  explicit ArpScanRangeScanner(const std::string &options) : options_(options) {}
+
+  virtual Set scan(const std::uint32_t first, const std::uint32_t last,
+                   const unsigned int pps) override {
+    return Set::fromARPScan(options_ + " --interval=" +
+                            boost::lexical_cast<std::string>(1000000 / std::max(pps, 1u)) + "u " +
+                            ipToStr(first) + "-" + ipToStr(last));
+  }
+
+  static std::string ipToStr(const std::uint32_t ip) {
+    char str[16];
+    std::sprintf(str, "%u.%u.%u.%u", ip >> 24, (ip >> 16) & 0xFF, (ip >> 8) & 0xFF, ip & 0xFF);
+    return str;
+  }
+
+private:
+  std::string options_;
+};
+
+///////////////////////////////////////////////////////////////////////////////////////////
+// Sweeper of a large range that splits it into shards and spreads them over a deadline.
+// shards are scanned one by one at the given rate so that the whole sweep never exceeds
+// the packet budget, and each shard starts no earlier than its slot of the deadline
+// so that the traffic is even. shards that do not fit before the deadline are skipped
+// and the next sweep resumes from them, so every shard is covered in turn.
+// a skipped shard contributes its last result to the sweep, so that devices in it do not
+// appear to leave only because the shard was not scanned this time.
+
+class ShardedSweeper {
+public:
+  struct Stats {
+    Stats() : shards(0), scanned_shards(0), stale_shards(0), hosts(0), scanned_hosts(0),
+              total_latency(0), max_latency(0) {}
+
+    // ratio of hosts scanned in the sweep
+    double coverage() const { return hosts > 0 ? double(scanned_hosts) / hosts : 1.; }
+    Time::duration meanLatency() const {
+      return scanned_shards > 0 ? total_latency / std::int64_t(scanned_shards) : Time::duration(0);
+    }
+
+    std::size_t shards, scanned_shards;
+    std::size_t stale_shards; // skipped shards whose last results are taken
+    std::uint64_t hosts, scanned_hosts;
+    Time::duration total_latency, max_latency; // time taken to scan a shard
+  };
+
+public:
+  // sweep [first, last] in shards of shard_size addresses at pps packets per second
+  ShardedSweeper(RangeScanner *const scanner, Clock *const clock, const std::uint32_t first,
+                 const std::uint32_t last, const std::uint32_t shard_size, const unsigned int pps)
+      : scanner_(scanner), clock_(clock), first_(first), last_(last),
+        shard_size_(std::max(shard_size, 1u)), pps_(std::max(pps, 1u)), next_shard_(0) {
+    if (first_ > last_) {
+      throw std::runtime_error("ShardedSweeper::ShardedSweeper(): Empty range");
+    }
+  }
+
+  // scan shards until the deadline and returns the merged results,
+  // including the last results of skipped shards
+  Set sweep(const Time &deadline, Stats *const stats = nullptr) {
+    Stats local_stats;
+    Stats &st = stats ? *stats : local_stats;
+    st = Stats();
+    st.shards = shards();
+    st.hosts = std::uint64_t(last_) - first_ + 1;
+
+    Set found;
+    const Time start = clock_->now();
+    for (std::size_t i = 0; i < st.shards; ++i) {
+      // the shard must start in its slot and be finished by the deadline at the rate
+      const std::pair<std::uint32_t, std::uint32_t> shard = shardAt(next_shard_);
+      const Time slot = start + (deadline - start) * std::int64_t(i) / std::int64_t(st.shards);
+      clock_->sleepUntil(slot);
+      const Time shard_start = clock_->now();
+      const std::uint64_t n_hosts = std::uint64_t(shard.second) - shard.first + 1;
+      if (shard_start + std::chrono::microseconds(std::int64_t(n_hosts * 1000000 / pps_)) >
+          deadline) {
+        break;
+      }
+      Set shard_found = scanner_->scan(shard.first, shard.second, pps_);
+      found.insert(shard_found.begin(), shard_found.end());
+      if (shard_found.empty()) {
+        last_results_.erase(next_shard_);
+      } else {
+        last_results_[next_shard_] = std::move(shard_found);
+      }
+
+      const Time::duration latency = clock_->now() - shard_start;
+      ++st.scanned_shards;
+      st.scanned_hosts += n_hosts;
+      st.total_latency += latency;
+      st.max_latency = std::max(st.max_latency, latency);
+      next_shard_ = (next_shard_ + 1) % st.shards;
+    }
+    // shards from next_shard_ are skipped unless all are scanned
+    for (std::size_t i = 0; i < st.shards - st.scanned_shards; ++i) {
+      const std::unordered_map<std::size_t, Set>::const_iterator last =
+          last_results_.find((next_shard_ + i) % st.shards);
+      if (last != last_results_.end()) {
+        found.insert(last->second.begin(), last->second.end());
+        ++st.stale_shards;
+      }
+    }
+    return found;
+  }
+
+  std::size_t shards() const {
+    return (std::uint64_t(last_) - first_) / shard_size_ + 1;
+  }
+
+  // [first, last] of a shard
+  std::pair<std::uint32_t, std::uint32_t> shardAt(const std::size_t i) const {
+    const std::uint32_t first = first_ + i * shard_size_;
+    return {first, std::uint32_t(std::min<std::uint64_t>(std::uint64_t(first) + shard_size_ - 1,
+                                                         last_))};
+  }
+
+  // host addresses of a CIDR like '172.16.0.0/16' except the network and broadcast addresses
+  static std::pair<std::uint32_t, std::uint32_t> parseCIDR(const std::string &cidr) {
+    unsigned int octets[4], bits;
+    char trailing;
+    if (std::sscanf(cidr.c_str(), "%u.%u.%u.%u/%u%c", &octets[0], &octets[1], &octets[2],
+                    &octets[3], &bits, &trailing) != 5 ||
+        octets[0] > 255 || octets[1] > 255 || octets[2] > 255 || octets[3] > 255 || bits > 30) {
+      throw std::runtime_error("ShardedSweeper::parseCIDR(): Ill-formed or too small range '" +
+                               cidr + "'");
+    }
+    const std::uint32_t ip = (octets[0] << 24) | (octets[1] << 16) | (octets[2] << 8) | octets[3];
+    const std::uint32_t mask = bits == 0 ? 0 : ~std::uint32_t(0) << (32 - bits);
+    return {(ip & mask) + 1, (ip | ~mask) - 1};
+  }
+
+private:
+  RangeScanner *scanner_;
+  Clock *clock_;
+  std::uint32_t first_, last_, shard_size_;
+  unsigned int pps_;
+  std::size_t next_shard_;                            // the first shard of the next sweep
+  std::unordered_map<std::size_t, Set> last_results_; // non-empty results by shard
+};
+} // namespace mac_time_tracker
+
+#endif
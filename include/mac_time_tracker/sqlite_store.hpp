@@ -0,0 +1,223 @@
+#ifndef MAC_TIME_TRACKER_SQLITE_STORE_HPP
+#define MAC_TIME_TRACKER_SQLITE_STORE_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <string>
+
+#include <sqlite3.h>
+
+#include <mac_time_tracker/address.hpp>
+#include <mac_time_tracker/period_map.hpp>
+#include <mac_time_tracker/time.hpp>
+
+namespace mac_time_tracker {
+
+/////////////////////////////////////////////////////////////////////////////////////////
+// Storage of tracked entries in a SQLite database (in WAL mode) for indexed queries.
+// times are seconds since the epoch and addresses are integers, i.e. Address::toInt().
+// tables;
+//   presence(start, end, address, category, description)
+//     indexed on (address, start) and (category, start)
+//   categories(category)
+//     distinct categories in presence
+//   meta(max_period)
+//     a row of the longest period in presence, which bounds range queries on start
+
+class SQLiteStore {
+public:
+  explicit SQLiteStore(const std::string &filename)
+      : db_(nullptr), insert_(nullptr), insert_category_(nullptr) {
+    if (sqlite3_open(filename.c_str(), &db_) != SQLITE_OK) {
+      const std::string error = db_ ? sqlite3_errmsg(db_) : "out of memory";
+      sqlite3_close(db_);
+      throw std::runtime_error("SQLiteStore::SQLiteStore(): Cannot open '" + filename +
+                               "': " + error);
+    }
+    try {
+      // NORMAL sync is durable enough in WAL mode and does not sync on each commit
+      exec("PRAGMA journal_mode=WAL");
+      exec("PRAGMA synchronous=NORMAL");
+      exec("CREATE TABLE IF NOT EXISTS presence ("
+           "start INTEGER NOT NULL, end INTEGER NOT NULL, address INTEGER NOT NULL,"
+           " category TEXT NOT NULL, description TEXT NOT NULL)");
+      exec("CREATE INDEX IF NOT EXISTS presence_address_start ON presence (address, start)");
+      exec("CREATE INDEX IF NOT EXISTS presence_category_start ON presence (category, start)");
+      // a database made before categories and meta fills them once
+      exec("CREATE TABLE IF NOT EXISTS categories (category TEXT PRIMARY KEY)");
+      exec("INSERT OR IGNORE INTO categories SELECT DISTINCT category FROM presence"
+           " WHERE NOT EXISTS (SELECT 1 FROM categories)");
+      exec("CREATE TABLE IF NOT EXISTS meta (max_period INTEGER NOT NULL)");
+      exec("INSERT INTO meta SELECT COALESCE(MAX(end - start), 0) FROM presence"
+           " WHERE NOT EXISTS (SELECT 1 FROM meta)");
+      insert_ = prepare("INSERT INTO presence VALUES (?1, ?2, ?3, ?4, ?5)");
+      insert_category_ = prepare("INSERT OR IGNORE INTO categories VALUES (?1)");
+    } catch (...) {
+      sqlite3_finalize(insert_);
+      sqlite3_close(db_);
+      throw;
+    }
+  }
+
+  ~SQLiteStore() {
+    sqlite3_finalize(insert_category_);
+    sqlite3_finalize(insert_);
+    sqlite3_close(db_);
+  }
+
+  SQLiteStore(const SQLiteStore &) = delete;
+  SQLiteStore &operator=(const SQLiteStore &) = delete;
+
+  // insert entries in [first, last) of any container like PeriodMap in a transaction
+  template <class Iterator> void insert(const Iterator first, const Iterator last) {
+    exec("BEGIN");
+    try {
+      std::int64_t max_period = 0;
+      std::set<std::string> categories;
+      for (Iterator it = first; it != last; ++it) {
+        const typename std::iterator_traits<Iterator>::value_type &entry = *it;
+        max_period =
+            std::max(max_period, toSeconds(entry.first.second) - toSeconds(entry.first.first));
+        categories.insert(entry.second.category);
+        sqlite3_bind_int64(insert_, 1, toSeconds(entry.first.first));
+        sqlite3_bind_int64(insert_, 2, toSeconds(entry.first.second));
+        sqlite3_bind_int64(insert_, 3, entry.second.address.toInt());
+        sqlite3_bind_text(insert_, 4, entry.second.category.c_str(),
+                          entry.second.category.size(), SQLITE_TRANSIENT);
+        sqlite3_bind_text(insert_, 5, entry.second.description.c_str(),
+                          entry.second.description.size(), SQLITE_TRANSIENT);
+        const int rc = sqlite3_step(insert_);
+        sqlite3_reset(insert_);
+        if (rc != SQLITE_DONE) {
+          throw std::runtime_error("SQLiteStore::insert(): " + std::string(sqlite3_errmsg(db_)));
+        }
+      }
+      for (const std::string &category : categories) {
+        sqlite3_bind_text(insert_category_, 1, category.c_str(), category.size(),
+                          SQLITE_TRANSIENT);
+        const int rc = sqlite3_step(insert_category_);
+        sqlite3_reset(insert_category_);
+        if (rc != SQLITE_DONE) {
+          throw std::runtime_error("SQLiteStore::insert(): " + std::string(sqlite3_errmsg(db_)));
+        }
+      }
+      exec("UPDATE meta SET max_period = MAX(max_period, " + std::to_string(max_period) + ")");
+      exec("COMMIT");
+    } catch (...) {
+      sqlite3_exec(db_, "ROLLBACK", nullptr, nullptr, nullptr);
+      throw;
+    }
+  }
+
+  // the end of the last period in which the address was present. returns false if never.
+  bool lastSeen(const Address &address, Time *const end) const {
+    sqlite3_stmt *const stmt =
+        prepare("SELECT end FROM presence WHERE address = ?1 ORDER BY start DESC LIMIT 1");
+    sqlite3_bind_int64(stmt, 1, address.toInt());
+    const int rc = sqlite3_step(stmt);
+    if (rc == SQLITE_ROW) {
+      *end = fromSeconds(sqlite3_column_int64(stmt, 0));
+    }
+    sqlite3_finalize(stmt);
+    if (rc != SQLITE_ROW && rc != SQLITE_DONE) {
+      throw std::runtime_error("SQLiteStore::lastSeen(): " + std::string(sqlite3_errmsg(db_)));
+    }
+    return rc == SQLITE_ROW;
+  }
+
+  // time in which any address of each category was present in [from, to).
+  // periods of different scans never overlap, so each distinct period is counted once.
+  // for each category, the (category, start) index seeks only entries around the range
+  // because periods overlapping the range start at most max_period before it.
+  std::map<std::string, Time::duration> presenceByCategory(const Time &from,
+                                                          const Time &to) const {
+    sqlite3_stmt *const stmt = prepare(presenceByCategoryQuery());
+    sqlite3_bind_int64(stmt, 1, toSeconds(from));
+    sqlite3_bind_int64(stmt, 2, toSeconds(to));
+    sqlite3_bind_int64(stmt, 3, toSeconds(from) - maxPeriod());
+    std::map<std::string, Time::duration> ret;
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+      ret[reinterpret_cast<const char *>(sqlite3_column_text(stmt, 0))] =
+          std::chrono::seconds(sqlite3_column_int64(stmt, 1));
+    }
+    sqlite3_finalize(stmt);
+    if (rc != SQLITE_DONE) {
+      throw std::runtime_error("SQLiteStore::presenceByCategory(): " +
+                               std::string(sqlite3_errmsg(db_)));
+    }
+    return ret;
+  }
+
+  // the statement of presenceByCategory() on ?1 = from, ?2 = to and ?3 = from - max_period
+  static std::string presenceByCategoryQuery() {
+    return "SELECT category, SUM(e - s) FROM ("
+           " SELECT DISTINCT c.category, MAX(p.start, ?1) AS s, MIN(p.end, ?2) AS e"
+           " FROM categories AS c CROSS JOIN presence AS p ON p.category = c.category"
+           " WHERE p.start >= ?3 AND p.start < ?2 AND p.end > ?1) GROUP BY category";
+  }
+
+  // the query plan of a statement, to check usage of the indexes
+  std::string explain(const std::string &sql) const {
+    sqlite3_stmt *const stmt = prepare("EXPLAIN QUERY PLAN " + sql);
+    std::string plan;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+      plan += reinterpret_cast<const char *>(sqlite3_column_text(stmt, 3));
+      plan += "\n";
+    }
+    sqlite3_finalize(stmt);
+    return plan;
+  }
+
+private:
+  // the longest period in seconds
+  std::int64_t maxPeriod() const {
+    sqlite3_stmt *const stmt = prepare("SELECT max_period FROM meta");
+    const int rc = sqlite3_step(stmt);
+    const std::int64_t max_period = rc == SQLITE_ROW ? sqlite3_column_int64(stmt, 0) : 0;
+    sqlite3_finalize(stmt);
+    if (rc != SQLITE_ROW && rc != SQLITE_DONE) {
+      throw std::runtime_error("SQLiteStore::maxPeriod(): " + std::string(sqlite3_errmsg(db_)));
+    }
+    return max_period;
+  }
+
+  void exec(const std::string &sql) {
+    char *error = nullptr;
+    if (sqlite3_exec(db_, sql.c_str(), nullptr, nullptr, &error) != SQLITE_OK) {
+      const std::string msg = error ? error : "unknown error";
+      sqlite3_free(error);
+      throw std::runtime_error("SQLiteStore::exec(): '" + sql + "': " + msg);
+    }
+  }
+
+  sqlite3_stmt *prepare(const std::string &sql) const {
+    sqlite3_stmt *stmt = nullptr;
+    if (sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+      throw std::runtime_error("SQLiteStore::prepare(): '" + sql +
+                               "': " + sqlite3_errmsg(db_));
+    }
+    return stmt;
+  }
+
+  static std::int64_t toSeconds(const Time &time) {
+    return std::chrono::duration_cast<std::chrono::seconds>(time.time_since_epoch()).count();
+  }
+
+  static Time fromSeconds(const std::int64_t sec) {
+    return Time(std::chrono::duration_cast<Time::duration>(std::chrono::seconds(sec)));
+  }
+
+private:
+  sqlite3 *db_;
+  sqlite3_stmt *insert_;
+  sqlite3_stmt *insert_category_;
+};
+} // namespace mac_time_tracker
+
+#endif
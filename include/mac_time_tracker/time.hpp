@@ -2,18 +2,25 @@
 #define MAC_TIME_TRACKER_TIME_HPP
 
 #include <chrono>
-#include <ctime>   // for std::localtime()
+#include <cstring>
+#include <ctime>   // for std::mktime(), std::strftime()
 #include <iomanip> // for std::put_time()
 #include <iostream>
+#include <sstream>
+#include <stdexcept>
 #include <string>
 
+#include <time.h> // for strptime(), localtime_r()
+
 #include <boost/lexical_cast.hpp>
 
 #include <mac_time_tracker/io.hpp>
 
 namespace mac_time_tracker {
 
-class Time : public std::chrono::system_clock::time_point, public Writable {
+class Time : public std::chrono::system_clock::time_point,
+             public Readable<Time>,
+             public Writable<Time> {
 private:
   using Base = std::chrono::system_clock::time_point;
 
@@ -29,10 +36,73 @@ public:
   // A shortcut to Time::clock::now()
   static Time now() { return clock::now(); }
 
-  using Writable::toStr;
-  std::string toStr(const std::string &fmt) const {
+  // write a local time in the given format to [first, last) by std::strftime(),
+  // which also puts a terminating null after the written chars.
+  // returns the end of the written chars, or nullptr if the chars are too few.
+  char *toChars(char *const first, char *const last,
+                const std::string &fmt = defaultFormat()) const {
+    // localtime_r() instead of std::localtime() as this may run on multiple threads
+    const std::time_t t = clock::to_time_t(*this);
+    std::tm tm;
+    localtime_r(&t, &tm);
+    const std::size_t len =
+        first != last ? std::strftime(first, last - first, fmt.c_str(), &tm) : 0;
+    return len > 0 || (first != last && fmt.empty()) ? first + len : nullptr;
+  }
+
+  std::string toStr(const std::string &fmt = defaultFormat()) const {
+    // a local buffer avoids a string stream per call,
+    // which matters as this runs for every entry of outputs
+    char buf[128];
+    if (char *const end = toChars(buf, buf + sizeof(buf), fmt)) {
+      return std::string(buf, end);
+    }
+    // too long or empty result
     const std::time_t t = clock::to_time_t(*this);
-    return boost::lexical_cast<std::string>(std::put_time(std::localtime(&t), fmt.c_str()));
+    std::tm tm;
+    localtime_r(&t, &tm);
+    return boost::lexical_cast<std::string>(std::put_time(&tm, fmt.c_str()));
+  }
+
+  // parse a local time in the given format from the whole [first, last).
+  // this uses strptime() because std::get_time() of libstdc++ supports neither "%F" nor "%T"
+  // and does not fail on a truncated input. returns last, or nullptr on failure.
+  static const char *fromChars(const char *const first, const char *const last, Time *const val,
+                               const std::string &fmt = defaultFormat()) {
+    // strptime() requires a null-terminated string
+    char buf[64];
+    std::string long_str;
+    const char *str = buf;
+    if (std::size_t(last - first) < sizeof(buf)) {
+      std::memcpy(buf, first, last - first);
+      buf[last - first] = '\0';
+    } else {
+      long_str.assign(first, last);
+      str = long_str.c_str();
+    }
+    std::tm tm = {};
+    const char *rest = strptime(str, fmt.c_str(), &tm);
+    if (!rest) {
+      return nullptr;
+    }
+    // accept trailing spaces only
+    for (; *rest != '\0'; ++rest) {
+      if (*rest != ' ' && *rest != '\t' && *rest != '\n') {
+        return nullptr;
+      }
+    }
+    tm.tm_isdst = -1; // let std::mktime() find if DST is in effect
+    *val = clock::from_time_t(std::mktime(&tm));
+    return last;
+  }
+
+  using Readable<Time>::fromStr;
+  static Time fromStr(const std::string &str, const std::string &fmt) {
+    Time val;
+    if (!fromChars(str.data(), str.data() + str.size(), &val, fmt)) {
+      throw std::runtime_error("Time::fromStr(): Cannot parse '" + str + "' as '" + fmt + "'");
+    }
+    return val;
   }
 
   static std::string defaultFormat() {
@@ -41,7 +111,30 @@ public:
   }
 
 private:
-  virtual void write(std::ostream &os) const override { os << toStr(defaultFormat()); }
+  friend class Readable<Time>;
+  friend class Writable<Time>;
+
+  // read a local time in the default format, i.e. two words of date and time of day,
+  // so that the following values can be read from the stream
+  void read(std::istream &is) {
+    std::string date, time_of_day;
+    if (!(is >> date >> time_of_day)) {
+      return;
+    }
+    const std::string str = date + " " + time_of_day;
+    if (!fromChars(str.data(), str.data() + str.size(), this)) {
+      is.setstate(std::istream::failbit);
+    }
+  }
+
+  void write(std::ostream &os) const {
+    char buf[128];
+    if (char *const end = toChars(buf, buf + sizeof(buf))) {
+      os.write(buf, end - buf);
+    } else {
+      os << toStr();
+    }
+  }
 };
 
 } // namespace mac_time_tracker
@@ -0,0 +1,74 @@
+#ifndef MAC_TIME_TRACKER_TOP_K_HPP
+#define MAC_TIME_TRACKER_TOP_K_HPP
+
+#include <cstdint>
+#include <map>
+#include <set>
+#include <stdexcept>
+#include <utility> // for std::pair<>
+
+namespace mac_time_tracker {
+
+///////////////////////////////////////////////////////////////////////////////
+// Most frequent keys in a stream counted in a fixed capacity (space-saving).
+// a new key replaces the least frequent one when full, inheriting its count as the error.
+// so a key's true count is between (count - error) and count.
+
+template <class Key> class TopK {
+public:
+  struct Counter {
+    std::uint64_t count;
+    std::uint64_t error;
+  };
+  using const_iterator = typename std::map<Key, Counter>::const_iterator;
+
+public:
+  explicit TopK(const std::size_t capacity) : capacity_(capacity) {
+    if (capacity_ == 0) {
+      throw std::runtime_error("TopK::TopK(): Capacity must be positive");
+    }
+  }
+
+  // count the key up and returns its counter
+  const Counter &insert(const Key &key) {
+    typename std::map<Key, Counter>::iterator it = counters_.find(key);
+    if (it != counters_.end()) {
+      by_count_.erase({it->second.count, key});
+      ++it->second.count;
+    } else if (counters_.size() < capacity_) {
+      it = counters_.insert({key, {1, 0}}).first;
+    } else {
+      // evict the least frequent key
+      const std::pair<std::uint64_t, Key> min = *by_count_.begin();
+      by_count_.erase(by_count_.begin());
+      counters_.erase(min.second);
+      it = counters_.insert({key, {min.first + 1, min.first}}).first;
+    }
+    by_count_.insert({it->second.count, key});
+    return it->second;
+  }
+
+  // returns nullptr if the key is not monitored
+  const Counter *find(const Key &key) const {
+    const const_iterator it = counters_.find(key);
+    return it != counters_.end() ? &it->second : nullptr;
+  }
+
+  const_iterator begin() const { return counters_.begin(); }
+  const_iterator end() const { return counters_.end(); }
+  std::size_t size() const { return counters_.size(); }
+  std::size_t capacity() const { return capacity_; }
+
+  void clear() {
+    counters_.clear();
+    by_count_.clear();
+  }
+
+private:
+  std::size_t capacity_;
+  std::map<Key, Counter> counters_;
+  std::set<std::pair<std::uint64_t, Key>> by_count_; // to find the least frequent key
+};
+} // namespace mac_time_tracker
+
+#endif
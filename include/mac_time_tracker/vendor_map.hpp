@@ -0,0 +1,146 @@
+#ifndef MAC_TIME_TRACKER_VENDOR_MAP_HPP
+#define MAC_TIME_TRACKER_VENDOR_MAP_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/algorithm/string/trim.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <mac_time_tracker/address.hpp>
+#include <mac_time_tracker/csv.hpp>
+#include <mac_time_tracker/io.hpp>
+
+namespace mac_time_tracker {
+
+////////////////////////////////////////////////////////////////////////////////
+// Map from MAC address prefix to vendor name based on the IEEE registries
+// (MA-L/OUI: 24 bits, MA-M: 28 bits, MA-S: 36 bits).
+// prefixes are kept in a flat array sorted by (prefix, length) that refers to interned names
+// so that a lookup is a few binary searches without any allocation.
+
+class VendorMap : public Readable<VendorMap> {
+public:
+  struct Entry {
+    std::uint64_t prefix; // masked address in the lower 48 bits
+    std::uint32_t name;   // index of the vendor name
+    std::uint8_t length;  // length of the prefix in bits
+
+    bool operator<(const Entry &other) const {
+      return prefix != other.prefix ? prefix < other.prefix : length < other.length;
+    }
+  };
+
+public:
+  // Create an instance from a CSV, each line is '<registry>, <assignment>, <organization>, ...'
+  // like the files from the IEEE registration authority (oui.csv, mam.csv, oui36.csv).
+  // the length of the prefix is given by the number of hex digits in the assignment.
+  // lines whose registry is 'Registry' (i.e. headers) are ignored.
+  static VendorMap fromCSV(const CSV &csv) {
+    VendorMap map;
+    std::map<std::string, std::uint32_t> name_ids;
+    for (std::size_t i = 0; i < csv.size(); ++i) {
+      const std::vector<std::string> &line = csv[i];
+      if (line.size() < 3) {
+        throw std::runtime_error(
+            "VendorMap::fromCSV(): Each line must have at least 3 elements but the line " +
+            boost::lexical_cast<std::string>(i) + " has " +
+            boost::lexical_cast<std::string>(line.size()));
+      }
+      if (boost::trim_copy(line[0]) == "Registry") {
+        continue;
+      }
+      const std::string assignment = boost::trim_copy(line[1]), name = boost::trim_copy(line[2]);
+      Entry entry;
+      if (!parseAssignment(assignment, &entry.prefix, &entry.length)) {
+        throw std::runtime_error("VendorMap::fromCSV(): Ill-formed assignment '" + assignment +
+                                 "' on the line " + boost::lexical_cast<std::string>(i));
+      }
+      entry.name = name_ids.insert({name, map.names_.size()}).first->second;
+      if (entry.name == map.names_.size()) {
+        map.names_.push_back(name);
+      }
+      map.entries_.push_back(entry);
+    }
+    std::stable_sort(map.entries_.begin(), map.entries_.end());
+    // keep the first one if the registry has duplicated assignments
+    map.entries_.erase(
+        std::unique(map.entries_.begin(), map.entries_.end(),
+                    [](const Entry &a, const Entry &b) { return !(a < b || b < a); }),
+        map.entries_.end());
+    return map;
+  }
+
+  // returns the vendor name of the longest prefix that matches the given address,
+  // or nullptr if no prefixes match
+  const std::string *find(const Address &addr) const {
+    static const std::uint8_t lengths[] = {36, 28, 24};
+    const std::uint64_t val = addr.toInt();
+    for (const std::uint8_t length : lengths) {
+      const Entry key = {val & mask(length), 0, length};
+      const std::vector<Entry>::const_iterator it =
+          std::lower_bound(entries_.begin(), entries_.end(), key);
+      if (it != entries_.end() && it->prefix == key.prefix && it->length == length) {
+        return &names_[it->name];
+      }
+    }
+    return nullptr;
+  }
+
+  std::size_t size() const { return entries_.size(); }
+  bool empty() const { return entries_.empty(); }
+
+private:
+  // 'length' upper bits of a 48-bit address
+  static std::uint64_t mask(const std::uint8_t length) {
+    return ((std::uint64_t(1) << length) - 1) << (48 - length);
+  }
+
+  // parse a hex string like '0050C2' (24 bits) or '70B3D5F2F' (36 bits)
+  static bool parseAssignment(const std::string &str, std::uint64_t *const prefix,
+                              std::uint8_t *const length) {
+    if (str.size() != 6 && str.size() != 7 && str.size() != 9) {
+      return false;
+    }
+    std::uint64_t val = 0;
+    for (const char c : str) {
+      val <<= 4;
+      if (c >= '0' && c <= '9') {
+        val |= c - '0';
+      } else if (c >= 'a' && c <= 'f') {
+        val |= c - 'a' + 10;
+      } else if (c >= 'A' && c <= 'F') {
+        val |= c - 'A' + 10;
+      } else {
+        return false;
+      }
+    }
+    *length = str.size() * 4;
+    *prefix = val << (48 - *length);
+    return true;
+  }
+
+  friend class Readable<VendorMap>;
+
+  void read(std::istream &is) {
+    CSV csv;
+    is >> csv;
+    try {
+      *this = fromCSV(csv);
+    } catch (const std::runtime_error &) {
+      is.setstate(std::istream::failbit);
+    }
+  }
+
+private:
+  std::vector<Entry> entries_;
+  std::vector<std::string> names_;
+};
+} // namespace mac_time_tracker
+
+#endif
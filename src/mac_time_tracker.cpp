@@ -1,10 +1,20 @@
+#include <algorithm>
 #include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <iomanip>
 #include <iostream>
+#include <memory>
+#include <set>
+#include <sstream>
 #include <stdexcept>
 #include <string>
-#include <thread>
+#include <utility>
 #include <vector>
 
+#include <boost/algorithm/string/erase.hpp>
 #include <boost/algorithm/string/join.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/program_options/options_description.hpp>
@@ -12,11 +22,34 @@
 #include <boost/program_options/value_semantic.hpp> // for value<>() and bool_swich()
 #include <boost/program_options/variables_map.hpp>  // for variables_map, store() and notify()
 
+#include <sys/stat.h> // for stat()
+
+#include <mac_time_tracker/adaptive_interval.hpp>
 #include <mac_time_tracker/address.hpp>
 #include <mac_time_tracker/address_map.hpp>
+#include <mac_time_tracker/address_map_snapshot.hpp>
+#include <mac_time_tracker/arp_prober.hpp>
+#include <mac_time_tracker/clock.hpp>
+#include <mac_time_tracker/columnar_period_map.hpp>
+#include <mac_time_tracker/csv.hpp>
+#include <mac_time_tracker/gzip.hpp>
+#include <mac_time_tracker/history_index.hpp>
+#include <mac_time_tracker/hyper_log_log.hpp>
+#include <mac_time_tracker/occupancy.hpp>
+#include <mac_time_tracker/output_sink.hpp>
 #include <mac_time_tracker/period_map.hpp>
+#include <mac_time_tracker/scan_publisher.hpp>
+#include <mac_time_tracker/scan_log.hpp>
+#include <mac_time_tracker/scan_records.hpp>
+#include <mac_time_tracker/scan_scheduler.hpp>
 #include <mac_time_tracker/set.hpp>
+#include <mac_time_tracker/sharded_sweeper.hpp>
+#ifdef MAC_TIME_TRACKER_WITH_SQLITE
+#include <mac_time_tracker/sqlite_store.hpp>
+#endif
 #include <mac_time_tracker/time.hpp>
+#include <mac_time_tracker/top_k.hpp>
+#include <mac_time_tracker/vendor_map.hpp>
 
 namespace mtt = mac_time_tracker;
 
@@ -24,11 +57,16 @@ namespace mtt = mac_time_tracker;
 // Command line options
 
 struct Parameters {
-  std::string known_addr_csv, tracked_addr_html_in;
+  std::string known_addr_csv, known_addr_cache, vendor_csv, tracked_addr_html_in;
   std::vector<std::string> tracked_addr_csv_fmts, tracked_addr_html_fmts;
-  std::string arp_scan_options;
-  std::chrono::minutes scan_interval, track_interval, max_fill;
-  bool verbose;
+  std::vector<std::string> occupancy_csv_fmts, occupancy_json_fmts;
+  std::string arp_scan_options, probe_interface, sweep_range, record_scans, replay, publish_socket;
+  std::string scan_log, replay_from, replay_to, sqlite_db, history_index;
+  unsigned int max_unknown_addrs, threads, sweep_shard_size, sweep_pps, publish_buffer;
+  std::chrono::minutes scan_interval, max_scan_interval, track_interval, max_fill, sweep_interval;
+  std::chrono::minutes occupancy_slot;
+  std::chrono::milliseconds probe_deadline;
+  bool rematch, compress_rotated, catch_up, verbose;
 
   // Get parameters from command line args.
   // If help is requested via command line, non-empty help_msg is also provided.
@@ -54,6 +92,18 @@ struct Parameters {
          "     ex.: 00:11:22:33:44:55, John Doe, PC\n"
          "          66:77:88:99:AA:BB, John Doe, Phone\n"
          "          CC:DD:EE:FF:00:11, Jane Smith, Tablet") //
+        ("known-addr-cache", bpo::value(&params.known_addr_cache)->default_value(""),
+         "path to binary snapshot of --known-addr-csv. if given, known addresses are loaded"
+         " from the snapshot unless --known-addr-csv has been modified since it was written,"
+         " in which case the snapshot is rewritten.") //
+        ("vendor-csv", bpo::value(&params.vendor_csv)->default_value(""),
+         "path to input .csv file(s) from the IEEE registration authority"
+         " (oui.csv, mam.csv and/or oui36.csv concatenated)."
+         " if given, unknown addresses are tracked as '<vendor>' > 'unknown'.") //
+        ("max-unknown-addrs", bpo::value(&params.max_unknown_addrs)->default_value(0),
+         "if positive, track unknown addresses (incl. randomized ones) that were seen"
+         " in 2+ scans among this number of the most frequent ones in a tracking period."
+         " the number of distinct addresses is also estimated.") //
         ("tracked-addr-csv",
          bpo::value(&params.tracked_addr_csv_fmts)
              ->default_value(std::vector<std::string>(1, default_tracked_addr_csv_fmt),
@@ -61,7 +111,8 @@ struct Parameters {
              ->multitoken()
              ->zero_tokens(),
          "path(s) to output .csv file that contains tracked MAC addresses."
-         " will be formatted by std::put_time().") //
+         " will be formatted by std::put_time(). '-' means the stdout and 'unix:<path>'"
+         " sends to a listening unix domain socket. outputs are written only if changed.") //
         ("tracked-addr-html-in",
          bpo::value(&params.tracked_addr_html_in)->default_value("tracked_addresses.html.in"),
          "path to input .html file that will be used as a template") //
@@ -71,15 +122,107 @@ struct Parameters {
                              default_tracked_addr_html_fmt)
              ->multitoken()
              ->zero_tokens(),
-         "path(s) to output .html file. will be formatted by std::put_time().") //
+         "path(s) to output .html file. will be formatted by std::put_time()."
+         " destinations are same as --tracked-addr-csv.") //
+        ("occupancy-csv",
+         bpo::value(&params.occupancy_csv_fmts)
+             ->default_value(std::vector<std::string>(), "none")
+             ->multitoken()
+             ->zero_tokens(),
+         "path(s) to output .csv file of the number of tracked devices per category"
+         " in each --occupancy-slot, i.e. '<start>, <end>, <category>, <devices>'."
+         " names and destinations are same as --tracked-addr-csv.") //
+        ("occupancy-json",
+         bpo::value(&params.occupancy_json_fmts)
+             ->default_value(std::vector<std::string>(), "none")
+             ->multitoken()
+             ->zero_tokens(),
+         "path(s) to output .json file of the same numbers as --occupancy-csv"
+         " and ones of the latest scan") //
+        ("occupancy-slot",
+         bpo::value<unsigned int>()->default_value(60)->notifier([&params](const unsigned int val) {
+           params.occupancy_slot = std::chrono::minutes(val);
+         }),
+         "length of slots of occupancy in minutes, which also fills '@OCCUPANCY_ENTRIES@'"
+         " in --tracked-addr-html-in") //
+#ifdef MAC_TIME_TRACKER_WITH_SQLITE
+        ("sqlite-db", bpo::value(&params.sqlite_db)->default_value(""),
+         "if given, also insert tracked addresses of each scan into this SQLite database"
+         " (table 'presence' indexed on (address, start) and (category, start))") //
+#endif
+        ("history-index", bpo::value(&params.history_index)->default_value(""),
+         "if given, add tracked addresses to this index when each tracking period ends."
+         " mac_time_tracker_index queries it.") //
+        ("compress-rotated", bpo::bool_switch(&params.compress_rotated),
+         "compress output .csv and .html files to .gz in background"
+         " when their tracking period ends") //
         ("arp-scan-options",
          bpo::value(&params.arp_scan_options)->default_value(mtt::Set::defaultOptions()),
          "options for arp-scan") //
+        ("probe-interface", bpo::value(&params.probe_interface)->default_value(""),
+         "if given, send ARP requests from this interface over a raw socket instead of"
+         " running arp-scan. only the last IPs of known addresses are probed except sweeps"
+         " of the whole subnet every --sweep-interval.") //
+        ("probe-deadline",
+         bpo::value<unsigned int>()->default_value(2000)->notifier(
+             [&params](const unsigned int val) {
+               params.probe_deadline = std::chrono::milliseconds(val);
+             }),
+         "maximum time for a scan with --probe-interface in milliseconds") //
+        ("sweep-interval",
+         bpo::value<unsigned int>()->default_value(60)->notifier([&params](const unsigned int val) {
+           params.sweep_interval = std::chrono::minutes(val);
+         }),
+         "interval between sweeps of the subnet with --probe-interface in minutes") //
+        ("sweep-range", bpo::value(&params.sweep_range)->default_value(""),
+         "if given, scan this range in CIDR (ex. 10.0.0.0/16) instead of --localnet by arp-scan"
+         " in shards spread over each scan interval. shards that do not fit in the interval"
+         " are scanned in the next one and give their last results meanwhile.") //
+        ("sweep-shard-size", bpo::value(&params.sweep_shard_size)->default_value(256),
+         "number of addresses per arp-scan call with --sweep-range") //
+        ("sweep-pps", bpo::value(&params.sweep_pps)->default_value(500),
+         "maximum packets per second over all shards with --sweep-range") //
+        ("publish-socket", bpo::value(&params.publish_socket)->default_value(""),
+         "if given, listen on this unix domain socket and publish events of each scan"
+         " to connected subscribers as CSV lines (present, arrive, leave and scan)") //
+        ("publish-buffer", bpo::value(&params.publish_buffer)->default_value(1024),
+         "maximum unsent events per subscriber of --publish-socket in KiB."
+         " events of a scan that do not fit are dropped and counted,"
+         " but a subscriber without unsent events receives events of any size.") //
+        ("record-scans", bpo::value(&params.record_scans)->default_value(""),
+         "path to .csv file to which results of arp-scan are appended for --replay\n"
+         "  format: <timestamp>, <addr>, <addr>, ...") //
+        ("scan-log", bpo::value(&params.scan_log)->default_value(""),
+         "path to binary log to which results of arp-scan are appended for --replay."
+         " each scan is stored as changes from the previous one, which is much smaller"
+         " than --record-scans.") //
+        ("replay", bpo::value(&params.replay)->default_value(""),
+         "path to .csv file recorded by --record-scans or log by --scan-log. if given, replay"
+         " the recorded scans instead of running arp-scan as fast as possible, and report"
+         " throughput of each stage on completion.") //
+        ("replay-from", bpo::value(&params.replay_from)->default_value(""),
+         "if given, replay only scans at or after this time (ex. 2021-03-11 00:00:00)") //
+        ("replay-to", bpo::value(&params.replay_to)->default_value(""),
+         "if given, replay only scans before this time") //
+        ("rematch", bpo::bool_switch(&params.rematch),
+         "with --replay, write outputs only when each tracking period ends"
+         " instead of after every scan. this regenerates outputs of past periods"
+         " against the current --known-addr-csv without rescanning.") //
         ("scan-interval",
          bpo::value<unsigned int>()->default_value(5)->notifier([&params](const unsigned int val) {
            params.scan_interval = std::chrono::minutes(val);
          }),
          "interval between MAC address scans in minutes") //
+        ("max-scan-interval",
+         bpo::value<unsigned int>()->default_value(0)->notifier([&params](const unsigned int val) {
+           params.max_scan_interval = std::chrono::minutes(val);
+         }),
+         "if greater than --scan-interval, double the interval up to this value in minutes"
+         " while scan results are unchanged. it returns to --scan-interval on any change.") //
+        ("catch-up", bpo::bool_switch(&params.catch_up),
+         "if a scan overruns its interval, start the next one immediately"
+         " instead of waiting for the next scanning period on the grid."
+         " periods without a scan are reported either way.") //
         ("track-interval",
          bpo::value<unsigned int>()
              ->default_value(60 * 24, "60 * 24")
@@ -91,6 +234,9 @@ struct Parameters {
          bpo::value<unsigned int>()->default_value(60)->notifier(
              [&params](const unsigned int val) { params.max_fill = std::chrono::minutes(val); }),
          "fill empty slots on .html equal to or less than this value in minutes")  //
+        ("threads", bpo::value(&params.threads)->default_value(1),
+         "number of threads to fill empty slots and format .html. 0 means the number of"
+         " hardware threads. outputs do not depend on this.") //
         ("verbose,v", bpo::bool_switch(&params.verbose), "verbose console output") //
         ("help,h", bpo::bool_switch(&help), "print help message");
     // parse command line args
@@ -108,32 +254,136 @@ struct Parameters {
 
 void printKnownAddresses(std::ostream &os, const std::string &filename,
                          const mtt::AddressMap &known_addrs) {
-  if (!known_addrs.empty()) {
+  if (!known_addrs.empty() || !known_addrs.patterns().empty()) {
     os << "Known addresses from '" << filename << "'" << std::endl;
     for (const mtt::AddressMap::value_type &entry : known_addrs) {
       os << "    " << entry.first << " ('" << entry.second.category << "' > '"
          << entry.second.description << "')" << std::endl;
     }
+    for (const mtt::AddressMap::Patterns::Rule &rule : known_addrs.patterns()) {
+      os << "    " << rule.value << "/" << rule.mask << " ('" << rule.item.category << "' > '"
+         << rule.item.description << "')" << std::endl;
+    }
   } else {
     os << "No known addresses from '" << filename << "'" << std::endl;
   }
 }
 
-void printTrackedAddresses(std::ostream &os, const mtt::PeriodMap &tracked_addrs,
+void printTrackedAddresses(std::ostream &os, const mtt::ColumnarPeriodMap &tracked_addrs,
                            const mtt::PeriodMap::Period &period) {
-  const std::pair<mtt::PeriodMap::const_iterator, mtt::PeriodMap::const_iterator> range =
-      tracked_addrs.equal_range(period);
+  const std::pair<mtt::ColumnarPeriodMap::const_iterator,
+                  mtt::ColumnarPeriodMap::const_iterator>
+      range = tracked_addrs.equal_range(period);
   if (range.first != range.second) {
     os << "Tracked addresses" << std::endl;
-    for (mtt::PeriodMap::const_iterator it = range.first; it != range.second; ++it) {
-      os << "    " << it->second.address << " ('" << it->second.category << "' > '"
-         << it->second.description << "')" << std::endl;
+    for (mtt::ColumnarPeriodMap::const_iterator it = range.first; it != range.second; ++it) {
+      const mtt::PeriodMap::Info info = it.info();
+      os << "    " << info.address << " ('" << info.category << "' > '" << info.description
+         << "')" << std::endl;
     }
   } else {
     os << "No tracked addresses" << std::endl;
   }
 }
 
+// events of a scan for subscribers as CSV lines;
+//   "present","<start>","<end>","<address>","<category>","<description>" for tracked entries,
+//   "arrive","<time>","<address>" and "leave","<time>","<address>" for changes of the scan
+//   from the last one, and "scan","<start>","<end>","<# of present addresses>" at last
+std::string formatScanEvents(const mtt::ColumnarPeriodMap &tracked_addrs,
+                             const mtt::PeriodMap::Period &period, const mtt::Set &present_addrs,
+                             const mtt::Set &last_present_addrs) {
+  std::ostringstream oss;
+  const std::pair<mtt::ColumnarPeriodMap::const_iterator,
+                  mtt::ColumnarPeriodMap::const_iterator>
+      range = tracked_addrs.equal_range(period);
+  for (mtt::ColumnarPeriodMap::const_iterator it = range.first; it != range.second; ++it) {
+    std::vector<std::string> line = mtt::PeriodMap::entryToCSV(period, it.info());
+    line.insert(line.begin(), "present");
+    mtt::CSV::writeLine(oss, line);
+  }
+  const std::string time = period.first.toStr();
+  for (const mtt::Address &addr : present_addrs) {
+    if (last_present_addrs.count(addr) == 0) {
+      mtt::CSV::writeLine(oss, {"arrive", time, addr.toStr()});
+    }
+  }
+  for (const mtt::Address &addr : last_present_addrs) {
+    if (present_addrs.count(addr) == 0) {
+      mtt::CSV::writeLine(oss, {"leave", time, addr.toStr()});
+    }
+  }
+  mtt::CSV::writeLine(oss, {"scan", period.first.toStr(), period.second.toStr(),
+                            std::to_string(present_addrs.size())});
+  return oss.str();
+}
+
+//////////////////////
+// Stage statistics
+
+// accumulated processing time and items of a stage in the scanning loop
+struct StageStats {
+  StageStats() : elapsed(0), calls(0), items(0) {}
+
+  // account a call that started at the given time
+  void add(const std::chrono::steady_clock::time_point &start, const std::size_t n_items) {
+    elapsed += std::chrono::steady_clock::now() - start;
+    ++calls;
+    items += n_items;
+  }
+
+  std::chrono::steady_clock::duration elapsed;
+  std::size_t calls, items;
+};
+
+struct PipelineStats {
+  StageStats scan, match, csv, fill, html;
+};
+
+void printPipelineStats(std::ostream &os, const PipelineStats &stats) {
+  namespace sc = std::chrono;
+  const std::pair<const char *, const StageStats *> stages[] = {{"scan", &stats.scan},
+                                                                {"match", &stats.match},
+                                                                {"csv", &stats.csv},
+                                                                {"fill", &stats.fill},
+                                                                {"html", &stats.html}};
+  os << "Throughput per stage" << std::endl;
+  for (const std::pair<const char *, const StageStats *> &stage : stages) {
+    const double sec = sc::duration_cast<sc::duration<double>>(stage.second->elapsed).count();
+    os << "    " << std::left << std::setw(6) << stage.first << std::right << stage.second->calls
+       << " calls, " << stage.second->items << " items in " << sec << " s ("
+       << (sec > 0. ? stage.second->calls / sec : 0.) << " calls/s, "
+       << (sec > 0. ? stage.second->items / sec : 0.) << " items/s)" << std::endl;
+  }
+}
+
+// print buckets of a histogram like "<100us: 3, <1000us: 1, >=1000us: 0"
+void printHistogram(std::ostream &os, const mtt::Histogram &hist, const std::string &unit) {
+  for (std::size_t i = 0; i < hist.counts().size(); ++i) {
+    os << (i > 0 ? ", " : "")
+       << (i < hist.bounds().size() ? "<" + boost::lexical_cast<std::string>(hist.bounds()[i])
+                                    : ">=" + boost::lexical_cast<std::string>(hist.bounds()[i - 1]))
+       << unit << ": " << hist.counts()[i];
+  }
+  os << std::endl;
+}
+
+// print stats of all scans since the start, which are not reset by tracking periods
+void printScheduleStats(std::ostream &os, const mtt::ScanScheduler::Stats &stats) {
+  os << "Schedule of scans in total (" << stats.cycle.total() << " cycles, " << stats.missed
+     << " missed period(s), " << stats.catch_ups << " catch-up(s))\n"
+     << "    wake-up jitter: ";
+  printHistogram(os, stats.jitter, "us");
+  os << "    cycle / --scan-interval: ";
+  printHistogram(os, stats.cycle, "%");
+}
+
+///////////
+// Address
+
+// randomized addresses (ex. from phones) have the locally administered bit
+bool isLocallyAdministered(const mtt::Address &addr) { return (addr[0] & 0x02) != 0; }
+
 //////////
 // String
 
@@ -145,6 +395,47 @@ std::string readFile(const std::string &filename) {
   return std::string(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
 }
 
+////////
+// Files
+
+bool fileExists(const std::string &filename) {
+  struct stat st;
+  return ::stat(filename.c_str(), &st) == 0;
+}
+
+// content of a file that is reloaded only when the modification time or size changes
+template <class T> class FileCache {
+public:
+  using Loader = std::function<T(const std::string &)>;
+
+  FileCache(const std::string &filename, const Loader loader)
+      : filename_(filename), loader_(loader), loaded_(false) {}
+
+  // returns true if (re)loaded. throws if failed to load.
+  bool update() {
+    struct stat st = {};
+    const bool exists = (::stat(filename_.c_str(), &st) == 0);
+    if (loaded_ && exists && st.st_mtim.tv_sec == stamp_.st_mtim.tv_sec &&
+        st.st_mtim.tv_nsec == stamp_.st_mtim.tv_nsec && st.st_size == stamp_.st_size) {
+      return false;
+    }
+    loaded_ = false;
+    value_ = loader_(filename_);
+    loaded_ = true;
+    stamp_ = st;
+    return true;
+  }
+
+  const T &get() const { return value_; }
+
+private:
+  std::string filename_;
+  Loader loader_;
+  bool loaded_;
+  struct stat stamp_;
+  T value_;
+};
+
 std::vector<std::string> format(const mtt::Time &formatter, const std::vector<std::string> &exprs) {
   std::vector<std::string> formatted;
   for (const std::string &expr : exprs) {
@@ -153,13 +444,24 @@ std::vector<std::string> format(const mtt::Time &formatter, const std::vector<st
   return formatted;
 }
 
+// write the content to the outputs by OutputFanOut::write(), reporting failed sinks.
+// returns false if the content is unchanged.
+bool writeOutputs(mtt::OutputFanOut *const outputs, const std::string &content,
+                  const std::string &key) {
+  const bool changed = outputs->write(content, key);
+  for (const std::string &error : outputs->errors()) {
+    std::cerr << error << std::endl;
+  }
+  return changed;
+}
+
 ///////////////
 // Time period
 
-// returns a time point representing today's 0:00 am
+// returns a time point representing 0:00 am of the day of now
 // that can be used as a reasonable base time for findPresentPeriod()
-mtt::Time getLocal0AMToday() {
-  const std::time_t ut_now = std::time(NULL);      // now in the universal time
+mtt::Time getLocal0AMToday(const mtt::Time &now) {
+  const std::time_t ut_now = mtt::Time::clock::to_time_t(now); // now in the universal time
   std::tm *const lt_0am = std::localtime(&ut_now); // 0:00 am in the local time
   lt_0am->tm_hour = lt_0am->tm_min = lt_0am->tm_sec = 0;
   return mtt::Time(std::chrono::seconds(std::mktime(lt_0am)));
@@ -169,9 +471,8 @@ mtt::Time getLocal0AMToday() {
 // where (p.first = base + n * interval) and (p.second = p.first + interval).
 // i.e. returns {5:00, 6:00} if now is 5:10 and interval is 60 minutes,
 //           or {10:20, 10:30} if now is 10:21 and interval is 10 minutes.
-mtt::PeriodMap::Period findPresentPeriod(const mtt::Time &base,
+mtt::PeriodMap::Period findPresentPeriod(const mtt::Time &now, const mtt::Time &base,
                                          const std::chrono::minutes &interval) {
-  const mtt::Time now = mtt::Time::now();
   const int n = (now - base) / interval;
   if (now >= base) {
     //                       <---- period ---->
@@ -186,6 +487,53 @@ mtt::PeriodMap::Period findPresentPeriod(const mtt::Time &base,
   }
 }
 
+////////////////////
+// Background tasks
+
+// report errors of finished tasks and forget them. also wait unfinished ones if wait_all.
+void collectTasks(std::vector<std::future<void>> *const tasks, const bool wait_all) {
+  std::vector<std::future<void>> unfinished;
+  for (std::future<void> &task : *tasks) {
+    if (wait_all || task.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+      try {
+        task.get();
+      } catch (const std::exception &err) {
+        std::cerr << err.what() << std::endl;
+      }
+    } else {
+      unfinished.push_back(std::move(task));
+    }
+  }
+  tasks->swap(unfinished);
+}
+
+// merge intervals of a period into the index file, which rewrites the whole file
+void updateHistoryIndex(const std::string &filename, const mtt::HistoryIndex &period_index) {
+  mtt::HistoryIndex index = mtt::HistoryIndex::fromFile(filename);
+  index.add(period_index);
+  index.toFile(filename);
+}
+
+/////////
+// Scans
+
+// returns the first recorded scan in the given period, or an empty set if nothing
+mtt::Set findRecordedScan(const mtt::ScanRecords &records, const mtt::PeriodMap::Period &period) {
+  const mtt::ScanRecords::const_iterator it = records.lower_bound(period.first);
+  return it != records.end() && it->first < period.second ? it->second : mtt::Set();
+}
+
+void appendScanRecord(const std::string &filename, const mtt::Time &time, const mtt::Set &addrs) {
+  std::ofstream ofs(filename, std::ios::app);
+  if (!ofs) {
+    throw std::runtime_error("Cannot open '" + filename + "' to append");
+  }
+  ofs << mtt::ScanRecords{{time, addrs}};
+  if (!ofs) {
+    throw std::runtime_error("Cannot append to '" + filename + "'");
+  }
+}
+
 ////////
 // Main
 
@@ -198,16 +546,146 @@ int main(int argc, char *argv[]) {
     return 0;
   }
 
-  // Tracking loop (never returns)
-  const mtt::Time base_time = getLocal0AMToday();
-  for (int i_track = 0;; ++i_track) {
+  // Clock that is driven by the recorded scans on replay, or the wall clock
+  std::unique_ptr<mtt::Clock> clock;
+  mtt::ScanRecords replay_records;
+  if (!params.replay.empty()) {
+    try {
+      replay_records = mtt::ScanLog::isLog(params.replay)
+                           ? mtt::ScanLog::fromFile(params.replay)
+                           : mtt::ScanRecords::fromFile(params.replay);
+      if (!params.replay_from.empty()) {
+        replay_records.erase(replay_records.begin(),
+                             replay_records.lower_bound(mtt::Time::fromStr(params.replay_from)));
+      }
+      if (!params.replay_to.empty()) {
+        replay_records.erase(replay_records.lower_bound(mtt::Time::fromStr(params.replay_to)),
+                             replay_records.end());
+      }
+    } catch (const std::exception &err) {
+      std::cerr << err.what() << std::endl;
+      return 1;
+    }
+    clock.reset(new mtt::ManualClock(
+        replay_records.empty() ? mtt::Time::now() : replay_records.begin()->first));
+  } else {
+    try {
+      clock.reset(new mtt::TimerFDClock());
+    } catch (const std::exception &err) {
+      std::cerr << err.what() << std::endl;
+      return 1;
+    }
+  }
+  bool replay_done = !params.replay.empty() && replay_records.empty();
+
+  // Prober instead of arp-scan
+  std::unique_ptr<mtt::ArpProber> prober;
+  if (!params.probe_interface.empty() && params.replay.empty()) {
+    try {
+      prober.reset(
+          new mtt::ArpProber(params.probe_interface, params.probe_deadline, params.sweep_interval));
+    } catch (const std::exception &err) {
+      std::cerr << err.what() << std::endl;
+      return 1;
+    }
+  }
+  // Sharded sweeper of a large range instead of arp-scan on the local network
+  std::unique_ptr<mtt::ArpScanRangeScanner> range_scanner;
+  std::unique_ptr<mtt::ShardedSweeper> sweeper;
+  if (!params.sweep_range.empty() && params.replay.empty() && !prober) {
+    try {
+      const std::pair<std::uint32_t, std::uint32_t> range =
+          mtt::ShardedSweeper::parseCIDR(params.sweep_range);
+      // the range replaces --localnet as targets
+      range_scanner.reset(new mtt::ArpScanRangeScanner(
+          boost::algorithm::erase_all_copy(params.arp_scan_options, "--localnet")));
+      sweeper.reset(new mtt::ShardedSweeper(range_scanner.get(), clock.get(), range.first,
+                                            range.second, params.sweep_shard_size,
+                                            params.sweep_pps));
+    } catch (const std::exception &err) {
+      std::cerr << err.what() << std::endl;
+      return 1;
+    }
+  }
+  // Log of raw scan results
+  std::unique_ptr<mtt::ScanLog> scan_log;
+  if (!params.scan_log.empty()) {
+    try {
+      scan_log.reset(new mtt::ScanLog(params.scan_log));
+    } catch (const std::exception &err) {
+      std::cerr << err.what() << std::endl;
+      return 1;
+    }
+  }
+  // Publisher of scan events
+  std::unique_ptr<mtt::ScanPublisher> publisher;
+  if (!params.publish_socket.empty()) {
+    try {
+      publisher.reset(
+          new mtt::ScanPublisher(params.publish_socket, params.publish_buffer * std::size_t(1024)));
+    } catch (const std::exception &err) {
+      std::cerr << err.what() << std::endl;
+      return 1;
+    }
+  }
+#ifdef MAC_TIME_TRACKER_WITH_SQLITE
+  // Database of all tracked addresses
+  std::unique_ptr<mtt::SQLiteStore> store;
+  if (!params.sqlite_db.empty()) {
+    try {
+      store.reset(new mtt::SQLiteStore(params.sqlite_db));
+    } catch (const std::exception &err) {
+      std::cerr << err.what() << std::endl;
+      return 1;
+    }
+  }
+#endif
+  PipelineStats stats;
+
+  // Tracking loop (never returns unless replaying)
+  const mtt::Time base_time = getLocal0AMToday(clock->now());
+  mtt::AdaptiveInterval scan_interval(params.scan_interval, params.max_scan_interval);
+  mtt::ScanScheduler scheduler(clock.get(), base_time, params.scan_interval, params.catch_up);
+  mtt::Set last_present_addrs;
+  std::vector<std::future<void>> compressions;
+  std::vector<std::future<void>> indexings; // update of the history index, one at a time
+  FileCache<mtt::AddressMap> known_addrs_file(
+      params.known_addr_csv, [&params](const std::string &filename) -> mtt::AddressMap {
+        if (params.known_addr_cache.empty()) {
+          return mtt::AddressMap::fromFile(filename);
+        }
+        // the map is still usable without the snapshot
+        std::string save_error;
+        mtt::AddressMap map =
+            mtt::AddressMapSnapshot::fromFile(filename, params.known_addr_cache, &save_error);
+        if (!save_error.empty()) {
+          std::cerr << save_error << std::endl;
+        }
+        return map;
+      });
+  FileCache<mtt::VendorMap> vendors_file(params.vendor_csv, &mtt::VendorMap::fromFile);
+  FileCache<std::string> html_in_file(params.tracked_addr_html_in, &readFile);
+  mtt::ColumnarPeriodMap last_tracked_addrs; // storage of the last tracking period
+  for (int i_track = 0; !replay_done; ++i_track) {
     // Constants and storage for this tracking period
-    const mtt::PeriodMap::Period track_period = findPresentPeriod(base_time, params.track_interval);
+    const mtt::PeriodMap::Period track_period =
+        findPresentPeriod(clock->now(), base_time, params.track_interval);
     const std::vector<std::string> tracked_addr_csvs =
         format(track_period.first, params.tracked_addr_csv_fmts); // output .csv filenames
     const std::vector<std::string> tracked_addr_htmls =
         format(track_period.first, params.tracked_addr_html_fmts); // output .html filenames
-    mtt::PeriodMap tracked_addrs;                                  // storage
+    mtt::ColumnarPeriodMap tracked_addrs(track_period.first);      // storage
+    mtt::OutputFanOut csv_outputs(tracked_addr_csvs), html_outputs(tracked_addr_htmls);
+    // per-category rollups of the storage and their outputs
+    mtt::Occupancy occupancy(track_period.first, params.occupancy_slot);
+    const std::vector<std::string> occupancy_csvs =
+        format(track_period.first, params.occupancy_csv_fmts);
+    const std::vector<std::string> occupancy_jsons =
+        format(track_period.first, params.occupancy_json_fmts);
+    mtt::OutputFanOut occupancy_csv_outputs(occupancy_csvs),
+        occupancy_json_outputs(occupancy_jsons);
+    tracked_addrs.carryOver(last_tracked_addrs, params.max_fill);  // to fill over the boundary
+    last_tracked_addrs = mtt::ColumnarPeriodMap(); // only the carried entries are kept
     if (params.verbose) {
       std::cout << "Tracking period #" << i_track << "\n"
                 << "     start: " << track_period.first << "\n"
@@ -217,27 +695,45 @@ int main(int argc, char *argv[]) {
                 << std::endl;
     }
 
-    // Step 1: Load known addresses and a template of output .html from files
-    mtt::AddressMap known_addrs;
-    std::string tracked_addr_html_in;
+    // Bounded storage for unknown addresses in this tracking period
+    mtt::TopK<mtt::Address> unknown_addrs(std::max(params.max_unknown_addrs, 1u));
+    mtt::HyperLogLog distinct_addrs;
+
+    // Step 1: Load known addresses, vendors and a template of output .html from files
+    //         unless they are unchanged since the last tracking period
     try {
-      known_addrs = mtt::AddressMap::fromFile(params.known_addr_csv);
-      if (params.verbose) {
-        printKnownAddresses(std::cout, params.known_addr_csv, known_addrs);
+      if (known_addrs_file.update() && params.verbose) {
+        printKnownAddresses(std::cout, params.known_addr_csv, known_addrs_file.get());
+      }
+      if (!params.vendor_csv.empty() && vendors_file.update() && params.verbose) {
+        std::cout << vendors_file.get().size() << " vendor prefixes from '" << params.vendor_csv
+                  << "'" << std::endl;
       }
       if (!tracked_addr_htmls.empty()) {
-        tracked_addr_html_in = readFile(params.tracked_addr_html_in);
+        html_in_file.update();
       }
     } catch (const std::exception &err) {
       std::cerr << err.what() << std::endl;
-      std::this_thread::sleep_for(std::chrono::seconds(1));
+      if (!params.replay.empty()) {
+        return 1;
+      }
+      last_tracked_addrs = std::move(tracked_addrs); // to carry over the same entries on retry
+      clock->sleepUntil(clock->now() + std::chrono::seconds(1));
       continue;
     }
+    const mtt::AddressMap &known_addrs = known_addrs_file.get();
+    const mtt::VendorMap &vendors = vendors_file.get();
+    const std::string &tracked_addr_html_in = html_in_file.get();
 
     // Scanning loop that will repeat until the end of this tracking period
-    for (int i_scan = 0; mtt::Time::now() < track_period.second; ++i_scan) {
-      // Constants for this scanning period
-      const mtt::PeriodMap::Period scan_period = findPresentPeriod(base_time, params.scan_interval);
+    for (int i_scan = 0; !replay_done && clock->now() < track_period.second; ++i_scan) {
+      // Constants for this scanning period.
+      // the period may be stretched but still starts and ends on the grid of --scan-interval.
+      const mtt::Time scan_start =
+          findPresentPeriod(clock->now(), base_time, params.scan_interval).first;
+      const mtt::PeriodMap::Period scan_period = {
+          scan_start,
+          std::min(mtt::Time(scan_start + scan_interval.current()), track_period.second)};
       if (params.verbose) {
         std::cout << "Scanning period #" << i_track << "." << i_scan << "\n"
                   << "    start: " << scan_period.first << "\n"
@@ -245,35 +741,234 @@ int main(int argc, char *argv[]) {
       }
 
       try {
-        // Step 2: Scan addresses in network and match them to the known addresses
-        const mtt::Set present_addrs = mtt::Set::fromARPScan(params.arp_scan_options);
+        // Step 2: Scan addresses in network (or take the recorded ones)
+        //         and match them to the known addresses
+        std::chrono::steady_clock::time_point stage_start = std::chrono::steady_clock::now();
+        // a sweep leaves 10% of the period to process the results
+        const mtt::Time sweep_deadline =
+            scan_period.first + (scan_period.second - scan_period.first) * 9 / 10;
+        mtt::ShardedSweeper::Stats sweep_stats;
+        const mtt::Set present_addrs =
+            !params.replay.empty() ? findRecordedScan(replay_records, scan_period)
+            : prober               ? prober->scan(known_addrs, clock->now())
+            : sweeper              ? sweeper->sweep(sweep_deadline, &sweep_stats)
+                                   : mtt::Set::fromARPScan(params.arp_scan_options);
+        if (sweeper && params.verbose) {
+          namespace sc = std::chrono;
+          std::cout << "Swept " << sweep_stats.scanned_shards << " of " << sweep_stats.shards
+                    << " shards, " << sweep_stats.stale_shards << " taken from the last sweeps"
+                    << " (coverage: " << sweep_stats.coverage() * 100 << "%, latency: "
+                    << sc::duration_cast<sc::milliseconds>(sweep_stats.meanLatency()).count()
+                    << " ms on average, "
+                    << sc::duration_cast<sc::milliseconds>(sweep_stats.max_latency).count()
+                    << " ms at most)" << std::endl;
+        }
+        stats.scan.add(stage_start, present_addrs.size());
+        if (!params.record_scans.empty()) {
+          appendScanRecord(params.record_scans, clock->now(), present_addrs);
+        }
+        if (scan_log) {
+          scan_log->append(clock->now(), present_addrs);
+        }
+        stage_start = std::chrono::steady_clock::now();
+        // occupancy is updated along with the storage
+        occupancy.beginPeriod(scan_period);
+        const std::function<void(const mtt::PeriodMap::Info &)> track =
+            [&](const mtt::PeriodMap::Info &info) {
+              tracked_addrs.insert({scan_period, info});
+              occupancy.insert(scan_period, info);
+            };
         for (const mtt::Address &addr : present_addrs) {
-          const mtt::AddressMap::const_iterator it = known_addrs.find(addr);
-          if (it != known_addrs.end()) {
-            tracked_addrs.insert(
-                {scan_period, {addr, it->second.category, it->second.description}});
+          if (const mtt::AddressMap::Info *const info = known_addrs.match(addr)) {
+            track({addr, info->category, info->description});
+          } else if (params.max_unknown_addrs > 0) {
+            // track only addresses that are surely not one-off
+            const mtt::TopK<mtt::Address>::Counter &counter = unknown_addrs.insert(addr);
+            if (counter.count - counter.error >= 2) {
+              const std::string *const vendor = vendors.find(addr);
+              track({addr, vendor ? *vendor : "unknown",
+                     isLocallyAdministered(addr) ? "randomized" : "unknown"});
+            }
+          } else if (const std::string *const vendor = vendors.find(addr)) {
+            track({addr, *vendor, "unknown"});
+          }
+        }
+        stats.match.add(stage_start, present_addrs.size());
+        if (publisher) {
+          publisher->publish(
+              formatScanEvents(tracked_addrs, scan_period, present_addrs, last_present_addrs));
+          if (params.verbose) {
+            std::cout << "Published to " << publisher->subscribers() << " subscriber(s) ("
+                      << publisher->dropped() << " scan(s) dropped in total)" << std::endl;
+          }
+        }
+        scan_interval.update(present_addrs != last_present_addrs);
+        last_present_addrs = present_addrs;
+        if (params.max_unknown_addrs > 0) {
+          mtt::HyperLogLog scan_distinct_addrs;
+          for (const mtt::Address &addr : present_addrs) {
+            scan_distinct_addrs.insert(addr);
+          }
+          distinct_addrs.merge(scan_distinct_addrs);
+          if (params.verbose) {
+            std::cout << "Distinct addresses (estimated)\n"
+                      << "    in this scan: " << scan_distinct_addrs.estimate() << "\n"
+                      << "    in this tracking period: " << distinct_addrs.estimate() << std::endl;
           }
         }
         if (params.verbose) {
           printTrackedAddresses(std::cout, tracked_addrs, scan_period);
         }
 
-        // Step 3: Save scan results
-        for (const std::string &csv : tracked_addr_csvs) {
-          tracked_addrs.toFile(csv);
+        // Step 3: Save scan results.
+        //         each format is serialized once for all destinations and is written only
+        //         if changed. unchanged entries need neither filling nor formatting .html.
+        //         on rematch, only the last recorded scan of each tracking period is saved,
+        //         which may end before the period if the records stop early.
+        //         a failed destination stops neither the others nor the other formats.
+        const bool save =
+            !params.rematch || !replay_records.hasRecordIn(scan_period.second, track_period.second);
+#ifdef MAC_TIME_TRACKER_WITH_SQLITE
+        // the database takes entries of this scan in a transaction before other outputs
+        // so that it does not depend on them
+        if (store) {
+          try {
+            const std::pair<mtt::ColumnarPeriodMap::const_iterator,
+                            mtt::ColumnarPeriodMap::const_iterator>
+                scan_entries = tracked_addrs.equal_range(scan_period);
+            store->insert(scan_entries.first, scan_entries.second);
+          } catch (const std::exception &err) {
+            std::cerr << err.what() << std::endl;
+          }
         }
-        const mtt::PeriodMap filled = tracked_addrs.filled(params.max_fill);
-        for (const std::string &html : tracked_addr_htmls) {
-          filled.toHTML(html, tracked_addr_html_in);
+#endif
+        stage_start = std::chrono::steady_clock::now();
+        bool csv_changed = false;
+        if (save) {
+          const std::string csv_str = tracked_addrs.toStr();
+          csv_changed = writeOutputs(&csv_outputs, csv_str, csv_str);
+          stats.csv.add(stage_start, tracked_addrs.size());
+          if (occupancy_csv_outputs.size() > 0) {
+            const std::string occupancy_csv_str = occupancy.toStr();
+            writeOutputs(&occupancy_csv_outputs, occupancy_csv_str, occupancy_csv_str);
+          }
+          if (occupancy_json_outputs.size() > 0) {
+            const std::string occupancy_json_str = occupancy.toJSON();
+            writeOutputs(&occupancy_json_outputs, occupancy_json_str, occupancy_json_str);
+          }
+        }
+        if (save && (csv_changed || !html_outputs.written())) {
+          stage_start = std::chrono::steady_clock::now();
+          const mtt::PeriodMap filled =
+              tracked_addrs.filled(params.max_fill, "*", params.threads);
+          stats.fill.add(stage_start, tracked_addrs.size());
+          stage_start = std::chrono::steady_clock::now();
+          if (html_outputs.size() > 0) {
+            const std::string entries_str = mtt::PeriodMap::rangeToHTMLEntries(
+                filled.begin(), filled.end(), mtt::Time::defaultFormat(),
+                mtt::Address::defaultSeparator(), params.threads);
+            const std::string occupancy_str = occupancy.toHTMLEntries();
+            writeOutputs(&html_outputs,
+                         mtt::PeriodMap::fillHTMLTemplate(tracked_addr_html_in, entries_str,
+                                                          clock->now(),
+                                                          mtt::Time::defaultFormat(),
+                                                          occupancy_str),
+                         entries_str + occupancy_str);
+          }
+          stats.html.add(stage_start, filled.size());
+        } else if (save && params.verbose) {
+          std::cout << "Outputs are unchanged" << std::endl;
+        }
+
+        // prepare outputs of the next tracking period ahead of the rotation
+        if (scan_period.second == track_period.second) {
+          const mtt::ColumnarPeriodMap next_tracked_addrs(track_period.second);
+          for (const std::string &csv : format(track_period.second, params.tracked_addr_csv_fmts)) {
+            if (mtt::OutputSink::isFile(csv) && !fileExists(csv)) {
+              next_tracked_addrs.toFile(csv);
+            }
+          }
+          for (const std::string &html :
+               format(track_period.second, params.tracked_addr_html_fmts)) {
+            if (mtt::OutputSink::isFile(html) && !fileExists(html)) {
+              next_tracked_addrs.toHTML(html, tracked_addr_html_in, mtt::Time::defaultFormat(),
+                                        mtt::Address::defaultSeparator(), clock->now());
+            }
+          }
         }
       } catch (const std::exception &err) {
         std::cerr << err.what() << std::endl;
+        scan_interval.update(true);
       }
 
-      // Step 4: Sleep until the next scanning period
-      std::this_thread::sleep_until(scan_period.second);
+      // Step 4: Sleep until the next scanning period.
+      //         on replay, periods without records are skipped.
+      //         otherwise, periods missed by an overrun are reported.
+      if (!params.replay.empty()) {
+        const mtt::ScanRecords::const_iterator next =
+            replay_records.lower_bound(scan_period.second);
+        if (next == replay_records.end()) {
+          replay_done = true;
+          break;
+        }
+        scheduler.sleepUntil(std::max(scan_period.second, next->first));
+      } else {
+        bool caught_up;
+        if (const std::size_t missed = scheduler.sleepAfter(scan_period, &caught_up)) {
+          std::cerr << "Missed " << missed << " scanning period(s) after " << scan_period.second
+                    << " as the scan overran"
+                    << (caught_up ? ". catching up from " + clock->now().toStr() : "")
+                    << std::endl;
+        } else if (caught_up && params.verbose) {
+          std::cout << "Catching up from " << clock->now() << std::endl;
+        }
+      }
     }
+    if (params.verbose) {
+      printScheduleStats(std::cout, scheduler.stats());
+    }
+
+    // Step 5: Index the finished tracking period and compress its outputs in background.
+    //         only intervals of this period are made here, and the index file is updated
+    //         after the update by the last period.
+    if (!params.history_index.empty()) {
+      mtt::HistoryIndex period_index;
+      period_index.add(tracked_addrs.begin(), tracked_addrs.end());
+      collectTasks(&indexings, /* wait_all = */ true);
+      indexings.push_back(std::async(std::launch::async, &updateHistoryIndex,
+                                     params.history_index, std::move(period_index)));
+    }
+    if (params.compress_rotated && !replay_done) {
+      collectTasks(&compressions, /* wait_all = */ false);
+      std::vector<std::string> outputs = tracked_addr_csvs;
+      outputs.insert(outputs.end(), tracked_addr_htmls.begin(), tracked_addr_htmls.end());
+      outputs.insert(outputs.end(), occupancy_csvs.begin(), occupancy_csvs.end());
+      outputs.insert(outputs.end(), occupancy_jsons.begin(), occupancy_jsons.end());
+      // a file whose name does not change by the period (ex. 'out.csv') is still in use
+      std::set<std::string> next_outputs;
+      for (const std::vector<std::string> *const fmts :
+           {&params.tracked_addr_csv_fmts, &params.tracked_addr_html_fmts,
+            &params.occupancy_csv_fmts, &params.occupancy_json_fmts}) {
+        const std::vector<std::string> names = format(track_period.second, *fmts);
+        next_outputs.insert(names.begin(), names.end());
+      }
+      for (const std::string &output : outputs) {
+        if (!mtt::OutputSink::isFile(output) || next_outputs.count(output) > 0) {
+          continue;
+        }
+        compressions.push_back(
+            std::async(std::launch::async, &mtt::gzipFile, output, output + ".gz"));
+      }
+    }
+
+    // the last entries of this period will be carried to the next one
+    last_tracked_addrs = std::move(tracked_addrs);
   }
 
+  // Only reachable on replay
+  collectTasks(&compressions, /* wait_all = */ true);
+  collectTasks(&indexings, /* wait_all = */ true);
+  printPipelineStats(std::cout, stats);
+  printScheduleStats(std::cout, scheduler.stats());
   return 0;
 }
\ No newline at end of file
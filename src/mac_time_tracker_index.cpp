@@ -0,0 +1,129 @@
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/lexical_cast.hpp>
+#include <boost/program_options/options_description.hpp>
+#include <boost/program_options/parsers.hpp> // for command_line_parser
+#include <boost/program_options/positional_options.hpp>
+#include <boost/program_options/value_semantic.hpp> // for value<>() and bool_swich()
+#include <boost/program_options/variables_map.hpp>  // for variables_map, store() and notify()
+
+#include <mac_time_tracker/address.hpp>
+#include <mac_time_tracker/history_index.hpp>
+#include <mac_time_tracker/period_map.hpp>
+#include <mac_time_tracker/time.hpp>
+
+namespace mtt = mac_time_tracker;
+
+////////////////////////
+// Command line options
+
+struct Parameters {
+  std::string index;
+  std::vector<std::string> input_csvs, last_seen;
+  std::string presence, from, to;
+  bool verbose;
+
+  // Get parameters from command line args.
+  // If help is requested via command line, non-empty help_msg is also provided.
+  static Parameters fromCommandLine(const int argc, const char *const argv[],
+                                    std::string *const help_msg) {
+    namespace bpo = boost::program_options;
+    Parameters params;
+    bool help;
+    // define command line options
+    bpo::options_description arg_desc(
+        "mac_time_tracker_index [options] <input .csv> ...",
+        /* line length in help msg = */ bpo::options_description::m_default_line_length,
+        /* desc length in help msg = */ bpo::options_description::m_default_line_length * 6 / 10);
+    arg_desc.add_options()
+        // key, correspinding variable, description
+        ("index", bpo::value(&params.index)->default_value("tracked_addresses.idx"),
+         "path to index file made by this or mac_time_tracker --history-index") //
+        ("input-csv",
+         bpo::value(&params.input_csvs)->multitoken()->default_value({}, "none"),
+         "path(s) to input .csv files (or .csv.gz) made by mac_time_tracker"
+         " to add to the index. the index is created if it does not exist.") //
+        ("last-seen", bpo::value(&params.last_seen)->multitoken()->default_value({}, "none"),
+         "print the last time when each of these addresses was present") //
+        ("presence", bpo::value(&params.presence)->default_value(""),
+         "print periods in which this address was present in [--from, --to)") //
+        ("from", bpo::value(&params.from)->default_value("1970-01-01 00:00:00"),
+         "start time of --presence") //
+        ("to", bpo::value(&params.to)->default_value("2200-01-01 00:00:00"),
+         "end time of --presence")                                                   //
+        ("verbose,v", bpo::bool_switch(&params.verbose), "verbose console output") //
+        ("help,h", bpo::bool_switch(&help), "print help message");
+    bpo::positional_options_description pos_desc;
+    pos_desc.add("input-csv", -1);
+    // parse command line args
+    bpo::variables_map arg_map;
+    bpo::store(bpo::command_line_parser(argc, argv).options(arg_desc).positional(pos_desc).run(),
+               arg_map);
+    bpo::notify(arg_map);
+    // return results
+    *help_msg = help ? boost::lexical_cast<std::string>(arg_desc) : std::string("");
+    return params;
+  }
+};
+
+////////
+// Main
+
+int main(int argc, char *argv[]) {
+  // Parse command line args
+  std::string help_msg;
+  const Parameters params = Parameters::fromCommandLine(argc, argv, &help_msg);
+  if (!help_msg.empty()) {
+    std::cout << help_msg << std::endl;
+    return 0;
+  }
+
+  try {
+    // Add inputs to the index
+    if (!params.input_csvs.empty()) {
+      mtt::HistoryIndex index = mtt::HistoryIndex::fromFile(params.index);
+      for (const std::string &filename : params.input_csvs) {
+        const mtt::PeriodMap entries = mtt::PeriodMap::fromFile(filename);
+        index.add(entries.begin(), entries.end());
+        if (params.verbose) {
+          std::cerr << "Added " << entries.size() << " entries from '" << filename << "'"
+                    << std::endl;
+        }
+      }
+      index.toFile(params.index);
+      if (params.verbose) {
+        std::cerr << index.size() << " addresses in '" << params.index << "'" << std::endl;
+      }
+    }
+
+    // Query the index without loading it
+    if (!params.last_seen.empty() || !params.presence.empty()) {
+      const mtt::HistoryIndex::File index(params.index);
+      for (const std::string &addr_str : params.last_seen) {
+        const mtt::Address addr = mtt::Address::fromStr(addr_str);
+        mtt::Time end;
+        std::cout << addr << ", ";
+        if (index.lastSeen(addr, &end)) {
+          std::cout << end << std::endl;
+        } else {
+          std::cout << "never" << std::endl;
+        }
+      }
+      if (!params.presence.empty()) {
+        const mtt::Address addr = mtt::Address::fromStr(params.presence);
+        for (const mtt::PeriodMap::Period &period : index.presence(
+                 addr, mtt::Time::fromStr(params.from), mtt::Time::fromStr(params.to))) {
+          std::cout << period.first << ", " << period.second << std::endl;
+        }
+      }
+    }
+  } catch (const std::exception &err) {
+    std::cerr << err.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,202 @@
+#include <chrono>
+#include <ctime> // for std::mktime()
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/algorithm/string/replace.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/program_options/options_description.hpp>
+#include <boost/program_options/parsers.hpp> // for command_line_parser
+#include <boost/program_options/positional_options.hpp>
+#include <boost/program_options/value_semantic.hpp> // for value<>() and bool_swich()
+#include <boost/program_options/variables_map.hpp>  // for variables_map, store() and notify()
+
+#include <time.h> // for localtime_r()
+
+#include <mac_time_tracker/csv.hpp>
+#include <mac_time_tracker/gzip.hpp>
+#include <mac_time_tracker/occupancy.hpp>
+#include <mac_time_tracker/period_map.hpp>
+#include <mac_time_tracker/period_merger.hpp>
+#include <mac_time_tracker/time.hpp>
+
+namespace mtt = mac_time_tracker;
+
+////////////////////////
+// Command line options
+
+struct Parameters {
+  std::vector<std::string> input_csvs;
+  std::string output_csv, output_html, output_html_in;
+  bool verbose;
+
+  // Get parameters from command line args.
+  // If help is requested via command line, non-empty help_msg is also provided.
+  static Parameters fromCommandLine(const int argc, const char *const argv[],
+                                    std::string *const help_msg) {
+    namespace bpo = boost::program_options;
+    Parameters params;
+    bool help;
+    // define command line options
+    bpo::options_description arg_desc(
+        "mac_time_tracker_merge [options] <input .csv> ...",
+        /* line length in help msg = */ bpo::options_description::m_default_line_length,
+        /* desc length in help msg = */ bpo::options_description::m_default_line_length * 6 / 10);
+    arg_desc.add_options()
+        // key, correspinding variable, description
+        ("input-csv",
+         bpo::value(&params.input_csvs)->multitoken()->default_value({}, "none"),
+         "path(s) to input .csv files (or .csv.gz) made by mac_time_tracker."
+         " entries in each file must be sorted by period as mac_time_tracker does.") //
+        ("output-csv", bpo::value(&params.output_csv)->default_value("-"),
+         "path to output .csv file that contains merged entries without duplicates."
+         " '-' means stdout and empty means no output.") //
+        ("output-html-in",
+         bpo::value(&params.output_html_in)->default_value("tracked_addresses.html.in"),
+         "path to input .html file that will be used as a template") //
+        ("output-html", bpo::value(&params.output_html)->default_value(""),
+         "path to output .html file. empty means no output."
+         " its occupancy is counted per hour from the local 0 AM of the merged entries.") //
+        ("verbose,v", bpo::bool_switch(&params.verbose), "verbose console output") //
+        ("help,h", bpo::bool_switch(&help), "print help message");
+    bpo::positional_options_description pos_desc;
+    pos_desc.add("input-csv", -1);
+    // parse command line args
+    bpo::variables_map arg_map;
+    bpo::store(bpo::command_line_parser(argc, argv).options(arg_desc).positional(pos_desc).run(),
+               arg_map);
+    bpo::notify(arg_map);
+    // return results
+    *help_msg = help ? boost::lexical_cast<std::string>(arg_desc) : std::string("");
+    return params;
+  }
+};
+
+//////////
+// String
+
+std::string readFile(const std::string &filename) {
+  std::ifstream ifs(filename);
+  if (!ifs) {
+    throw std::runtime_error("Cannot open '" + filename + "' to read");
+  }
+  return std::string(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+}
+
+///////////////
+// Time period
+
+// returns 0:00 am of the local day of the given time, on which the tracker aligns periods
+mtt::Time getLocal0AM(const mtt::Time &time) {
+  const std::time_t ut = mtt::Time::clock::to_time_t(time);
+  std::tm lt;
+  localtime_r(&ut, &lt);
+  lt.tm_hour = lt.tm_min = lt.tm_sec = 0;
+  lt.tm_isdst = -1;
+  return mtt::Time::clock::from_time_t(std::mktime(&lt));
+}
+
+////////
+// Main
+
+int main(int argc, char *argv[]) {
+  // Parse command line args
+  std::string help_msg;
+  const Parameters params = Parameters::fromCommandLine(argc, argv, &help_msg);
+  if (!help_msg.empty()) {
+    std::cout << help_msg << std::endl;
+    return 0;
+  }
+
+  try {
+    // Open inputs that will be read line by line
+    std::vector<std::unique_ptr<mtt::GzipIFStream>> input_files;
+    std::vector<std::istream *> inputs;
+    for (const std::string &filename : params.input_csvs) {
+      input_files.emplace_back(new mtt::GzipIFStream(filename));
+      if (!*input_files.back()) {
+        throw std::runtime_error("Cannot open '" + filename + "' to read");
+      }
+      inputs.push_back(input_files.back().get());
+    }
+
+    // Open outputs
+    std::ofstream csv_file;
+    std::ostream *csv = nullptr;
+    if (params.output_csv == "-") {
+      csv = &std::cout;
+    } else if (!params.output_csv.empty()) {
+      csv_file.open(params.output_csv);
+      if (!csv_file) {
+        throw std::runtime_error("Cannot open '" + params.output_csv + "' to write");
+      }
+      csv = &csv_file;
+    }
+    std::ofstream html;
+    std::string html_head, html_tail; // template before and after data entries
+    if (!params.output_html.empty()) {
+      std::string html_in = readFile(params.output_html_in);
+      boost::replace_all(html_in, "@DATE@", mtt::Time::now().toStr());
+      const std::string::size_type pos = html_in.find("@DATA_ENTRIES@");
+      html_head = html_in.substr(0, pos);
+      if (pos != std::string::npos) {
+        html_tail = html_in.substr(pos + std::string("@DATA_ENTRIES@").size());
+      }
+      // occupancy is known after all the entries
+      boost::replace_all(html_head, "@OCCUPANCY_ENTRIES@", "");
+      html.open(params.output_html);
+      if (!html) {
+        throw std::runtime_error("Cannot open '" + params.output_html + "' to write");
+      }
+      html << html_head;
+    }
+
+    // Merge entries period by period
+    mtt::PeriodMerger merger(inputs);
+    std::unique_ptr<mtt::Occupancy> occupancy; // on the hours from the first local 0 AM
+    std::vector<mtt::PeriodMerger::Entry> group;
+    std::size_t n_entries = 0, n_periods = 0;
+    while (merger.next(&group)) {
+      for (const mtt::PeriodMerger::Entry &entry : group) {
+        if (csv) {
+          mtt::CSV::writeLine(*csv, mtt::PeriodMap::entryToCSV(entry.first, entry.second));
+        }
+        if (html.is_open()) {
+          if (n_entries > 0) {
+            html << "," << std::endl;
+          }
+          mtt::PeriodMap::writeHTMLEntry(html, entry.first, entry.second);
+          if (!occupancy) {
+            occupancy.reset(
+                new mtt::Occupancy(getLocal0AM(entry.first.first), std::chrono::hours(1)));
+          }
+          occupancy->insert(entry.first, entry.second);
+        }
+        ++n_entries;
+      }
+      ++n_periods;
+    }
+    if (html.is_open()) {
+      boost::replace_all(html_tail, "@OCCUPANCY_ENTRIES@",
+                         occupancy ? occupancy->toHTMLEntries() : std::string());
+      html << html_tail;
+    }
+
+    if ((csv && !*csv) || (html.is_open() && !html)) {
+      throw std::runtime_error("Cannot write merged entries");
+    }
+    if (params.verbose) {
+      std::cerr << "Merged " << n_entries << " entries in " << n_periods << " periods from "
+                << inputs.size() << " files" << std::endl;
+    }
+  } catch (const std::exception &err) {
+    std::cerr << err.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
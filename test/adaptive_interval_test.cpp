@@ -0,0 +1,35 @@
+#include <chrono>
+#include <stdexcept>
+
+#include <gtest/gtest.h>
+
+#include <mac_time_tracker/adaptive_interval.hpp>
+
+namespace mtt = mac_time_tracker;
+
+TEST(AdaptiveInterval, update) {
+  namespace sc = std::chrono;
+  ASSERT_THROW(mtt::AdaptiveInterval(sc::minutes(0), sc::minutes(10)), std::runtime_error);
+
+  mtt::AdaptiveInterval interval(sc::minutes(5), sc::minutes(45));
+  ASSERT_EQ(sc::minutes(5), interval.current());
+  // stretch while stable, keeping a multiple of the min
+  interval.update(false);
+  ASSERT_EQ(sc::minutes(10), interval.current());
+  interval.update(false);
+  ASSERT_EQ(sc::minutes(20), interval.current());
+  interval.update(false);
+  ASSERT_EQ(sc::minutes(40), interval.current());
+  interval.update(false);
+  ASSERT_EQ(sc::minutes(45), interval.current());
+  interval.update(false);
+  ASSERT_EQ(sc::minutes(45), interval.current());
+  // shorten on change
+  interval.update(true);
+  ASSERT_EQ(sc::minutes(5), interval.current());
+
+  // the max less than the min disables stretching
+  mtt::AdaptiveInterval fixed(sc::minutes(5), sc::minutes(0));
+  fixed.update(false);
+  ASSERT_EQ(sc::minutes(5), fixed.current());
+}
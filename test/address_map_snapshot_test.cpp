@@ -0,0 +1,85 @@
+#include <fstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <mac_time_tracker/address.hpp>
+#include <mac_time_tracker/address_map.hpp>
+#include <mac_time_tracker/address_map_snapshot.hpp>
+
+#include "make_temp_file.hpp"
+
+namespace mtt = mac_time_tracker;
+
+TEST(AddressMapSnapshot, fromFile) {
+  const std::string csv_file = makeTempFile("00:11:22:33:44:55, Tom, Phone\n"
+                                            "66:77:88:99:AA:BB, Tom,\n"
+                                            "02:00:00:00:00:00/02:00:00:00:00:00, Guest, Random\n"
+                                            "66:77:88:*, Dick, Laptop\n"
+                                            "CC:DD:EE:FF:00:11, Harry, PC");
+  const std::string snapshot_file = makeTempFile();
+
+  // no snapshot yet
+  mtt::AddressMap addr_map;
+  ASSERT_FALSE(mtt::AddressMapSnapshot::load(snapshot_file, csv_file, &addr_map));
+
+  // make a snapshot via the CSV path, then load it
+  const mtt::AddressMap src_map = mtt::AddressMapSnapshot::fromFile(csv_file, snapshot_file);
+  ASSERT_TRUE(mtt::AddressMapSnapshot::load(snapshot_file, csv_file, &addr_map));
+  ASSERT_EQ(src_map.size(), addr_map.size());
+  ASSERT_EQ(src_map.patterns().size(), addr_map.patterns().size());
+  for (const char *const str : {"00:11:22:33:44:55", "66:77:88:99:AA:BB", "66:77:88:00:00:00",
+                                "06:00:00:00:00:00", "CC:DD:EE:FF:00:11"}) {
+    const mtt::Address addr = mtt::Address::fromStr(str);
+    ASSERT_NE(nullptr, addr_map.match(addr));
+    ASSERT_EQ(src_map.match(addr)->category, addr_map.match(addr)->category);
+    ASSERT_EQ(src_map.match(addr)->description, addr_map.match(addr)->description);
+  }
+  ASSERT_EQ(nullptr, addr_map.match(mtt::Address::fromStr("00:00:00:00:00:00")));
+
+  // the snapshot is stale once the CSV is modified
+  {
+    std::ofstream ofs(csv_file, std::ios::app);
+    ofs << "\n00:00:00:00:00:00, Sally, Tablet";
+  }
+  ASSERT_FALSE(mtt::AddressMapSnapshot::load(snapshot_file, csv_file, &addr_map));
+  ASSERT_EQ(4, mtt::AddressMapSnapshot::fromFile(csv_file, snapshot_file).size());
+  ASSERT_TRUE(mtt::AddressMapSnapshot::load(snapshot_file, csv_file, &addr_map));
+  ASSERT_EQ(4, addr_map.size());
+
+  // a broken snapshot is ignored
+  {
+    std::ofstream ofs(snapshot_file, std::ios::in | std::ios::out);
+    ofs.seekp(8);
+    ofs << "broken";
+  }
+  ASSERT_FALSE(mtt::AddressMapSnapshot::load(snapshot_file, csv_file, &addr_map));
+  ASSERT_EQ(4, mtt::AddressMapSnapshot::fromFile(csv_file, snapshot_file).size());
+
+  // the map is returned even if the snapshot cannot be written
+  std::string save_error;
+  ASSERT_EQ(4, mtt::AddressMapSnapshot::fromFile(csv_file, "/nonexistent/dir/known.snap",
+                                                 &save_error)
+                   .size());
+  ASSERT_FALSE(save_error.empty());
+  ASSERT_EQ(4, mtt::AddressMapSnapshot::fromFile(csv_file, snapshot_file, &save_error).size());
+  ASSERT_TRUE(save_error.empty());
+}
+
+TEST(AddressMapSnapshot, source) {
+  // the same contents have the same hash
+  const std::string csv_file[] = {makeTempFile("00:11:22:33:44:55, Tom, Phone"),
+                                  makeTempFile("00:11:22:33:44:55, Tom, Phone"),
+                                  makeTempFile("00:11:22:33:44:55, Tom, PHONE")};
+  ASSERT_EQ(mtt::AddressMapSnapshot::sourceOf(csv_file[0]).hash,
+            mtt::AddressMapSnapshot::sourceOf(csv_file[1]).hash);
+  ASSERT_NE(mtt::AddressMapSnapshot::sourceOf(csv_file[0]).hash,
+            mtt::AddressMapSnapshot::sourceOf(csv_file[2]).hash);
+
+  // a snapshot of a file is valid for a copy of the file but not for another file of the same size
+  const std::string snapshot_file = makeTempFile();
+  mtt::AddressMapSnapshot::fromFile(csv_file[0], snapshot_file);
+  mtt::AddressMap addr_map;
+  ASSERT_TRUE(mtt::AddressMapSnapshot::load(snapshot_file, csv_file[1], &addr_map));
+  ASSERT_FALSE(mtt::AddressMapSnapshot::load(snapshot_file, csv_file[2], &addr_map));
+}
@@ -46,4 +46,46 @@ TEST(AddressMap, fromFile) {
     ASSERT_STREQ("Harry", addr_map.find(key)->second.category.c_str());
     ASSERT_STREQ("", addr_map.find(key)->second.description.c_str());
   }
-}
\ No newline at end of file
+}
+
+TEST(AddressMap, match) {
+  // [NG]
+  // - too long prefix
+  ASSERT_THROW(mtt::AddressMap::fromFile(makeTempFile("00:11:22:33:44:55/49, John, Phone")),
+               std::runtime_error);
+  // - bits out of the mask
+  ASSERT_THROW(mtt::AddressMap::fromFile(makeTempFile("00:11:22:33:44:55/24, John, Phone")),
+               std::runtime_error);
+  // - ill-formed wildcards
+  ASSERT_THROW(mtt::AddressMap::fromFile(makeTempFile("00:11:2*, John, Phone")),
+               std::runtime_error);
+  ASSERT_THROW(mtt::AddressMap::fromFile(makeTempFile("00:11:22:33:44:55:*, John, Phone")),
+               std::runtime_error);
+  // - non-unique pattern
+  ASSERT_THROW(mtt::AddressMap::fromFile(makeTempFile("00:11:22:*, John, Phones\n"
+                                                      "00:11:22:00:00:00/24, John, Phones")),
+               std::runtime_error);
+  // [Data]
+  const mtt::AddressMap addr_map =
+      mtt::AddressMap::fromFile(makeTempFile("00:11:22:33:44:55, Tom, Phone\n"
+                                             "00:11:22:*, Tom, Fleet\n"
+                                             "00-11-22-33-40-00/36, Dick, Fleet\n"
+                                             "02:00:00:00:00:00/02:00:00:00:00:00, Harry, Random"));
+  ASSERT_EQ(1, addr_map.size());
+  ASSERT_EQ(3, addr_map.patterns().size());
+  // exact address first, then the most specific pattern
+  const mtt::AddressMap::Info *info = addr_map.match(mtt::Address::fromStr("00:11:22:33:44:55"));
+  ASSERT_NE(nullptr, info);
+  ASSERT_STREQ("Phone", info->description.c_str());
+  info = addr_map.match(mtt::Address::fromStr("00:11:22:33:4F:FF"));
+  ASSERT_NE(nullptr, info);
+  ASSERT_STREQ("Dick", info->category.c_str());
+  info = addr_map.match(mtt::Address::fromStr("00:11:22:33:50:00"));
+  ASSERT_NE(nullptr, info);
+  ASSERT_STREQ("Tom", info->category.c_str());
+  ASSERT_STREQ("Fleet", info->description.c_str());
+  info = addr_map.match(mtt::Address::fromStr("AA:BB:CC:DD:EE:FF"));
+  ASSERT_NE(nullptr, info);
+  ASSERT_STREQ("Harry", info->category.c_str());
+  ASSERT_EQ(nullptr, addr_map.match(mtt::Address::fromStr("A8:BB:CC:DD:EE:FF")));
+}
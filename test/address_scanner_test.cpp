@@ -0,0 +1,100 @@
+#include <iterator>
+#include <random>
+#include <regex>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <mac_time_tracker/address.hpp>
+#include <mac_time_tracker/address_scanner.hpp>
+#include <mac_time_tracker/bit_kernels.hpp>
+
+namespace mtt = mac_time_tracker;
+
+// addresses found by a regex like grep --only-matching
+static std::vector<mtt::Address> reference(const std::string &text) {
+  static const std::regex pattern("([0-9a-fA-F]{2}[-:]){5}[0-9a-fA-F]{2}");
+  std::vector<mtt::Address> addrs;
+  for (std::sregex_iterator it(text.begin(), text.end(), pattern), end; it != end; ++it) {
+    addrs.push_back(mtt::Address::fromStr(it->str()));
+  }
+  return addrs;
+}
+
+static std::vector<mtt::Address> scan(const std::string &text, const bool simd) {
+  std::vector<mtt::Address> addrs;
+  mtt::AddressScanner::scan(text.data(), text.data() + text.size(), std::back_inserter(addrs),
+                            simd);
+  return addrs;
+}
+
+static std::vector<bool> simds() {
+  std::vector<bool> simds(1, false);
+  if (mtt::BitKernels::hasAVX2()) {
+    simds.push_back(true);
+  }
+  return simds;
+}
+
+TEST(AddressScanner, arpScan) {
+  const std::string text =
+      "Interface: eth0, type: EN10MB, MAC: 02:42:ac:11:00:02, IPv4: 172.17.0.2\n"
+      "Starting arp-scan 1.9.7 with 65536 hosts (https://github.com/royhills/arp-scan)\n"
+      "172.17.0.1\t02:42:9b:5f:4e:3d\t(Unknown: locally administered)\n"
+      "172.17.0.3\t00-1A-2b-3C-4d-5E\tSome Vendor, Inc.\n"
+      "\n"
+      "3 packets received by filter, 0 packets dropped by kernel\n";
+  for (const bool simd : simds()) {
+    const std::vector<mtt::Address> addrs = scan(text, simd);
+    ASSERT_EQ(3u, addrs.size());
+    ASSERT_EQ(mtt::Address::fromStr("02:42:ac:11:00:02"), addrs[0]);
+    ASSERT_EQ(mtt::Address::fromStr("02:42:9b:5f:4e:3d"), addrs[1]);
+    ASSERT_EQ(mtt::Address::fromStr("00:1a:2b:3c:4d:5e"), addrs[2]);
+    ASSERT_TRUE(scan("", simd).empty());
+  }
+}
+
+TEST(AddressScanner, sameAsRegex) {
+  // fixed cases of overlaps and near misses
+  std::vector<std::string> texts = {
+      "00:11:22:33:44:55:66:77:88:99:aa:bb:cc:dd:ee:ff",
+      "000:11:22:33:44:55",
+      "00:11:22:33:44:5",
+      "0g:11:22:33:44:55 00:11:22:33:44:55",
+      "00::11:22:33:44:55",
+      "\xff\xaa:11:22:33:44:55 \x80\x30\x30-11-22-33-44-55"};
+  // random texts of chars likely to make addresses, crossing windows of the scanner
+  std::mt19937 rng(1);
+  static const char chars[] = "0123456789abcdefABCDEFgG:-: \n\x80";
+  for (int i = 0; i < 1000; ++i) {
+    std::string text(rng() % 300, ' ');
+    for (char &c : text) {
+      c = chars[rng() % (sizeof(chars) - 1)];
+    }
+    // plant some addresses
+    for (int j = rng() % 4; j > 0; --j) {
+      const std::string addr =
+          mtt::Address::fromInt((std::uint64_t(rng()) << 16) ^ rng()).toStr(rng() % 2 ? ':' : '-');
+      text.insert(rng() % (text.size() + 1), addr);
+    }
+    texts.push_back(text);
+  }
+  for (const std::string &text : texts) {
+    const std::vector<mtt::Address> expected = reference(text);
+    for (const bool simd : simds()) {
+      ASSERT_EQ(expected, scan(text, simd)) << "text='" << text << "', simd=" << simd;
+    }
+  }
+}
+
+TEST(AddressScanner, find) {
+  const std::string text = "a 00:11:22:33:44:55,66-77-88-99-AA-BB";
+  std::vector<const char *> matches;
+  mtt::AddressScanner::find(text.data(), text.data() + text.size(), std::back_inserter(matches));
+  ASSERT_EQ(2u, matches.size());
+  ASSERT_EQ(text.data() + 2, matches[0]);
+  ASSERT_EQ(text.data() + 20, matches[1]);
+  ASSERT_EQ(mtt::Address(0x66, 0x77, 0x88, 0x99, 0xAA, 0xBB),
+            mtt::AddressScanner::decode(matches[1]));
+}
@@ -1,4 +1,5 @@
 #include <stdexcept>
+#include <string>
 
 #include <gtest/gtest.h>
 
@@ -62,4 +63,29 @@ TEST(Address, toStr) {
   const mtt::Address a = {0x00, 0xAA, 0x11, 0xBB, 0x22, 0xCC};
   ASSERT_STREQ(a.toStr().c_str(), "00:AA:11:BB:22:CC");
   ASSERT_STREQ(a.toStr('-').c_str(), "00-AA-11-BB-22-CC");
-}
\ No newline at end of file
+}
+
+TEST(Address, chars) {
+  const std::string str = "  00:aa-11:BB:22:cc foo";
+  mtt::Address a;
+  // the address and preceding spaces are parsed
+  ASSERT_EQ(str.data() + 19, mtt::Address::fromChars(str.data(), str.data() + str.size(), &a));
+  ASSERT_EQ(mtt::Address(0x00, 0xAA, 0x11, 0xBB, 0x22, 0xCC), a);
+  ASSERT_EQ(nullptr, mtt::Address::fromChars(str.data(), str.data() + 18, &a));
+  ASSERT_EQ(nullptr, mtt::Address::fromChars(str.data() + 3, str.data() + str.size(), &a));
+  // 17 chars are written
+  char buf[17];
+  ASSERT_EQ(buf + 17, a.toChars(buf, buf + 17, '-'));
+  ASSERT_EQ("00-AA-11-BB-22-CC", std::string(buf, buf + 17));
+  ASSERT_EQ(nullptr, a.toChars(buf, buf + 16));
+  // no room for a vtable pointer
+  ASSERT_EQ(6u, sizeof(mtt::Address));
+}
+
+TEST(Address, toInt) {
+  const mtt::Address a = {0x00, 0xAA, 0x11, 0xBB, 0x22, 0xCC};
+  ASSERT_EQ(0x00AA11BB22CCull, a.toInt());
+  ASSERT_EQ(a, mtt::Address::fromInt(0x00AA11BB22CCull));
+  // bits above 48 are ignored
+  ASSERT_EQ(a, mtt::Address::fromInt(0xFF00AA11BB22CCull));
+}
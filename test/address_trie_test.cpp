@@ -0,0 +1,40 @@
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <mac_time_tracker/address.hpp>
+#include <mac_time_tracker/address_trie.hpp>
+
+namespace mtt = mac_time_tracker;
+
+TEST(AddressTrie, find) {
+  mtt::AddressTrie<std::string> trie;
+  const mtt::Address any = mtt::Address::fromStr("00:00:00:00:00:00"),
+                     oui = mtt::Address::fromStr("FF:FF:FF:00:00:00"),
+                     local = mtt::Address::fromStr("02:00:00:00:00:00");
+  ASSERT_TRUE(trie.empty());
+  ASSERT_EQ(nullptr, trie.find(mtt::Address::fromStr("00:11:22:33:44:55")));
+  // insert patterns
+  ASSERT_TRUE(trie.insert(mtt::Address::fromStr("00:11:22:00:00:00"), oui, "oui"));
+  ASSERT_TRUE(trie.insert(mtt::Address::fromStr("00:11:22:33:00:00"),
+                          mtt::Address::fromStr("FF:FF:FF:F0:00:00"), "oui28"));
+  ASSERT_TRUE(trie.insert(local, local, "local"));
+  ASSERT_TRUE(trie.insert(mtt::Address::fromStr("02:11:22:00:00:00"), oui, "local oui"));
+  ASSERT_FALSE(trie.insert(mtt::Address::fromStr("00:11:22:00:00:00"), oui, "duplicated"));
+  ASSERT_EQ(4, trie.size());
+  // the most specific pattern wins
+  ASSERT_EQ("oui", *trie.find(mtt::Address::fromStr("00:11:22:FF:44:55")));
+  ASSERT_EQ("oui28", *trie.find(mtt::Address::fromStr("00:11:22:3F:44:55")));
+  ASSERT_EQ("local", *trie.find(mtt::Address::fromStr("FE:11:22:33:44:55")));
+  ASSERT_EQ("local oui", *trie.find(mtt::Address::fromStr("02:11:22:33:44:55")));
+  ASSERT_EQ(nullptr, trie.find(mtt::Address::fromStr("00:11:23:33:44:55")));
+  // the pattern matching everything
+  ASSERT_TRUE(trie.insert(any, any, "any"));
+  ASSERT_EQ("any", *trie.find(mtt::Address::fromStr("00:11:23:33:44:55")));
+  ASSERT_EQ("oui", *trie.find(mtt::Address::fromStr("00:11:22:FF:44:55")));
+  // the earlier one wins between equally specific patterns
+  ASSERT_TRUE(trie.insert(mtt::Address::fromStr("00:00:00:00:00:01"),
+                          mtt::Address::fromStr("00:00:00:00:00:01"), "odd"));
+  ASSERT_EQ("local", *trie.find(mtt::Address::fromStr("02:00:00:00:00:01")));
+  ASSERT_EQ("odd", *trie.find(mtt::Address::fromStr("00:00:00:00:00:01")));
+}
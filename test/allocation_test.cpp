@@ -0,0 +1,139 @@
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <mac_time_tracker/address.hpp>
+#include <mac_time_tracker/address_map.hpp>
+#include <mac_time_tracker/columnar_period_map.hpp>
+#include <mac_time_tracker/period_map.hpp>
+#include <mac_time_tracker/set.hpp>
+#include <mac_time_tracker/time.hpp>
+
+namespace mtt = mac_time_tracker;
+
+////////////////////////////////////////////////////////////////////////////////
+// Counting hooks of the global allocation, which apply to the whole unit_tests
+
+static std::atomic<std::size_t> n_allocs(0), n_alloc_bytes(0);
+
+void *operator new(const std::size_t size) {
+  ++n_allocs;
+  n_alloc_bytes += size;
+  if (void *const ptr = std::malloc(size > 0 ? size : 1)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+// not inlined, so that the compiler does not pair std::free() with operator new at call sites
+// (-Wmismatched-new-delete)
+__attribute__((noinline)) void operator delete(void *const ptr) noexcept { std::free(ptr); }
+__attribute__((noinline)) void operator delete(void *const ptr, std::size_t) noexcept {
+  std::free(ptr);
+}
+
+// allocations since construction
+struct AllocationCounter {
+  AllocationCounter() : allocs(n_allocs), bytes(n_alloc_bytes) {}
+  std::size_t count() const { return n_allocs - allocs; }
+  std::size_t size() const { return n_alloc_bytes - bytes; }
+
+  const std::size_t allocs, bytes;
+};
+
+// one scan cycle of main() on n_devices known devices.
+// the bounds are about twice the measured values so that only regressions fail.
+TEST(Allocation, scanCycle) {
+  namespace sc = std::chrono;
+  const std::size_t n_devices = 10000;
+  const mtt::Time base_time = mtt::Time::fromStr("2021-03-11 00:00:00");
+  const std::string html_in = "<html>@DATE@ [@DATA_ENTRIES@]</html>";
+  mtt::AddressMap known_addrs;
+  for (std::size_t i = 0; i < n_devices; ++i) {
+    known_addrs.insert(
+        {mtt::Address::fromInt(i * 7919), {"person" + std::to_string(i % 500), "device"}});
+  }
+  mtt::ColumnarPeriodMap tracked_addrs(base_time);
+
+  // some scans on which the devices come and go
+  int n_scans = 0;
+  const auto scan = [&](const mtt::Set &present_addrs) {
+    const mtt::PeriodMap::Period period = {base_time + n_scans * sc::minutes(5),
+                                           base_time + (n_scans + 1) * sc::minutes(5)};
+    ++n_scans;
+    for (const mtt::Address &addr : present_addrs) {
+      if (const mtt::AddressMap::Info *const info = known_addrs.match(addr)) {
+        tracked_addrs.insert({period, {addr, info->category, info->description}});
+      }
+    }
+  };
+  const auto presentAt = [n_devices](const std::size_t i_scan) {
+    mtt::Set present_addrs;
+    for (std::size_t i = 0; i < n_devices; ++i) {
+      if ((i + i_scan) % 4 != 0) {
+        present_addrs.insert(present_addrs.end(), mtt::Address::fromInt(i * 7919));
+      }
+    }
+    return present_addrs;
+  };
+  for (std::size_t i = 0; i < 10; ++i) {
+    scan(presentAt(i));
+  }
+  const std::size_t n_present = n_devices * 3 / 4;
+
+  // Set construction: a node per address
+  {
+    const AllocationCounter counter;
+    const mtt::Set present_addrs = presentAt(10);
+    ASSERT_LE(counter.count(), n_present + 10) << "Set: " << counter.size() << " bytes";
+  }
+
+  // lookups never allocate
+  const mtt::Set present_addrs = presentAt(10);
+  {
+    const AllocationCounter counter;
+    std::size_t n_matches = 0;
+    for (const mtt::Address &addr : present_addrs) {
+      n_matches += known_addrs.match(addr) ? 1 : 0;
+    }
+    ASSERT_EQ(n_present, n_matches);
+    ASSERT_EQ(0u, counter.count());
+  }
+
+  // insertion of a scan to the columnar map: amortized growth of the columns only
+  {
+    const AllocationCounter counter;
+    scan(present_addrs);
+    ASSERT_LE(counter.count(), 10u) << "insert: " << counter.size() << " bytes";
+    ASSERT_LE(counter.size(), 24 * n_present) << "insert: " << counter.count() << " allocs";
+  }
+
+  // serialization, filling and formatting of the whole period
+  const std::size_t n_entries = tracked_addrs.size();
+  {
+    const AllocationCounter counter;
+    const std::string csv = tracked_addrs.toStr();
+    ASSERT_LE(counter.count(), 8 * n_entries) << "toCSV: " << counter.size() << " bytes";
+    ASSERT_LE(counter.size(), 800 * n_entries) << "toCSV: " << counter.count() << " allocs";
+  }
+  {
+    const AllocationCounter counter;
+    const mtt::PeriodMap filled = tracked_addrs.filled(sc::minutes(60));
+    ASSERT_LE(counter.count(), 5 * n_entries) << "filled: " << counter.size() << " bytes";
+    ASSERT_LE(counter.size(), 600 * n_entries) << "filled: " << counter.count() << " allocs";
+
+    const AllocationCounter html_counter;
+    const std::string html = mtt::PeriodMap::fillHTMLTemplate(
+        html_in, mtt::PeriodMap::rangeToHTMLEntries(filled.begin(), filled.end()),
+        base_time + n_scans * sc::minutes(5));
+    ASSERT_LE(html_counter.count(), 6 * filled.size())
+        << "toHTML: " << html_counter.size() << " bytes";
+    ASSERT_LE(html_counter.size(), 1400 * filled.size())
+        << "toHTML: " << html_counter.count() << " allocs";
+  }
+}
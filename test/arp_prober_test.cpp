@@ -0,0 +1,55 @@
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <mac_time_tracker/address.hpp>
+#include <mac_time_tracker/arp_prober.hpp>
+
+namespace mtt = mac_time_tracker;
+
+TEST(ArpProber, packet) {
+  const mtt::Address mac = mtt::Address::fromStr("00:11:22:33:44:55");
+  const mtt::ArpProber::Frame request = mtt::ArpProber::makeRequest(mac, 0xC0A80001, 0xC0A80002);
+  const std::uint8_t expected[] = {
+      0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x11, 0x22, 0x33, 0x44, 0x55, // ethernet
+      0x08, 0x06,                                                             // ARP
+      0x00, 0x01, 0x08, 0x00, 0x06, 0x04, 0x00, 0x01,                         // request
+      0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0xC0, 0xA8, 0x00, 0x01,             // sender
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xC0, 0xA8, 0x00, 0x02};            // target
+  ASSERT_EQ(sizeof(expected), request.size());
+  ASSERT_TRUE(std::equal(request.begin(), request.end(), expected));
+
+  // a request is not a reply
+  mtt::Address sender_mac;
+  std::uint32_t sender_ip;
+  ASSERT_FALSE(
+      mtt::ArpProber::parseReply(request.data(), request.size(), &sender_mac, &sender_ip));
+
+  // a reply from 192.168.0.2 (with padding to the minimum ethernet frame)
+  std::vector<std::uint8_t> reply(request.begin(), request.end());
+  reply.resize(60, 0);
+  reply[21] = 2;
+  const std::uint8_t replier[] = {0x66, 0x77, 0x88, 0x99, 0xAA, 0xBB, 0xC0, 0xA8, 0x00, 0x02};
+  std::copy(replier, replier + 10, reply.begin() + 22);
+  ASSERT_TRUE(mtt::ArpProber::parseReply(reply.data(), reply.size(), &sender_mac, &sender_ip));
+  ASSERT_EQ(mtt::Address::fromStr("66:77:88:99:AA:BB"), sender_mac);
+  ASSERT_EQ(0xC0A80002, sender_ip);
+  // truncated
+  ASSERT_FALSE(mtt::ArpProber::parseReply(reply.data(), 41, &sender_mac, &sender_ip));
+}
+
+TEST(ArpProber, hostsOf) {
+  // 192.168.0.1-254 in 192.168.0.0/24
+  const std::vector<std::uint32_t> hosts = mtt::ArpProber::hostsOf(0xC0A80064, 0xFFFFFF00);
+  ASSERT_EQ(254, hosts.size());
+  ASSERT_EQ(0xC0A80001, hosts.front());
+  ASSERT_EQ(0xC0A800FE, hosts.back());
+  // /16 is the largest
+  ASSERT_EQ(65534, mtt::ArpProber::hostsOf(0xAC100001, 0xFFFF0000).size());
+  ASSERT_THROW(mtt::ArpProber::hostsOf(0x0A000001, 0xFF000000), std::runtime_error);
+  // point-to-point
+  ASSERT_EQ(std::vector<std::uint32_t>(1, 0x0A000001),
+            mtt::ArpProber::hostsOf(0x0A000001, 0xFFFFFFFF));
+}
@@ -0,0 +1,57 @@
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <mac_time_tracker/bit_kernels.hpp>
+
+namespace mtt = mac_time_tracker;
+
+static bool bitAt(const std::vector<std::uint64_t> &words, const std::int64_t i) {
+  return i >= 0 && i < std::int64_t(words.size() * 64) && ((words[i / 64] >> (i % 64)) & 1);
+}
+
+static std::vector<std::uint64_t> randomWords(const std::size_t n, std::mt19937_64 *const rng) {
+  std::vector<std::uint64_t> words(n);
+  for (std::uint64_t &word : words) {
+    // sparse and dense words
+    word = (*rng)() & (*rng)() & ((*rng)() % 2 == 0 ? (*rng)() : ~std::uint64_t(0));
+  }
+  return words;
+}
+
+// the scalar and AVX2 versions are same as bitwise references
+TEST(BitKernels, sameAsReference) {
+  std::mt19937_64 rng(1);
+  std::vector<bool> simds(1, false);
+  if (mtt::BitKernels::hasAVX2()) {
+    simds.push_back(true);
+  }
+  for (const std::size_t n : {0, 1, 3, 4, 5, 8, 13, 32}) {
+    const std::vector<std::uint64_t> a = randomWords(n, &rng), b = randomWords(n, &rng);
+    std::size_t count = 0, count_and = 0;
+    for (std::size_t i = 0; i < n * 64; ++i) {
+      count += bitAt(a, i) ? 1 : 0;
+      count_and += bitAt(a, i) && bitAt(b, i) ? 1 : 0;
+    }
+    for (const bool simd : simds) {
+      ASSERT_EQ(count, mtt::BitKernels::popcount(a.data(), n, simd));
+      ASSERT_EQ(count_and, mtt::BitKernels::popcountAnd(a.data(), b.data(), n, simd));
+      for (const std::size_t shift : {0, 1, 7, 63, 64, 65, 130, 300}) {
+        // outputs are overwritten
+        std::vector<std::uint64_t> ored = b, anded = b;
+        mtt::BitKernels::orShiftedUp(ored.data(), a.data(), n, shift, simd);
+        mtt::BitKernels::andShiftedDown(anded.data(), a.data(), n, shift, simd);
+        for (std::size_t i = 0; i < n * 64; ++i) {
+          ASSERT_EQ(bitAt(a, i) || bitAt(a, std::int64_t(i) - std::int64_t(shift)),
+                    bitAt(ored, i))
+              << "n=" << n << ", shift=" << shift << ", bit=" << i << ", simd=" << simd;
+          ASSERT_EQ(bitAt(a, i) && bitAt(a, i + shift), bitAt(anded, i))
+              << "n=" << n << ", shift=" << shift << ", bit=" << i << ", simd=" << simd;
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,37 @@
+#include <chrono>
+
+#include <gtest/gtest.h>
+
+#include <mac_time_tracker/clock.hpp>
+#include <mac_time_tracker/time.hpp>
+
+namespace mtt = mac_time_tracker;
+
+TEST(Clock, system) {
+  mtt::SystemClock clock;
+  const mtt::Time start = clock.now();
+  clock.sleepUntil(start + std::chrono::milliseconds(10));
+  ASSERT_GE(clock.now() - start, std::chrono::milliseconds(10));
+}
+
+TEST(Clock, manual) {
+  const mtt::Time start = mtt::Time::fromStr("2021-03-11 10:00:00");
+  mtt::ManualClock clock(start);
+  ASSERT_EQ(start, clock.now());
+  // moves forward immediately
+  clock.sleepUntil(start + std::chrono::hours(24));
+  ASSERT_EQ(start + std::chrono::hours(24), clock.now());
+  // never goes back
+  clock.sleepUntil(start);
+  ASSERT_EQ(start + std::chrono::hours(24), clock.now());
+}
+
+TEST(Clock, timerfd) {
+  mtt::TimerFDClock clock;
+  const mtt::Time start = clock.now();
+  clock.sleepUntil(start + std::chrono::milliseconds(10));
+  ASSERT_GE(clock.now() - start, std::chrono::milliseconds(10));
+  // returns immediately for a past time
+  clock.sleepUntil(start);
+  ASSERT_LT(clock.now() - start, std::chrono::seconds(1));
+}
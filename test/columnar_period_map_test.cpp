@@ -0,0 +1,188 @@
+#include <chrono>
+#include <iterator> // for std::distance()
+#include <stdexcept>
+#include <string>
+
+#include <boost/lexical_cast.hpp>
+
+#include <gtest/gtest.h>
+
+#include <mac_time_tracker/address.hpp>
+#include <mac_time_tracker/columnar_period_map.hpp>
+#include <mac_time_tracker/period_map.hpp>
+#include <mac_time_tracker/time.hpp>
+
+namespace mtt = mac_time_tracker;
+
+TEST(ColumnarPeriodMap, sameAsPeriodMap) {
+  namespace sc = std::chrono;
+
+  const mtt::Time base_time = mtt::Time::fromStr("2021-03-11 00:00:00");
+  const mtt::PeriodMap::Info info[] = {
+      {mtt::Address::fromStr("00:11:22:33:44:55"), "Category0", "Description0"},
+      {mtt::Address::fromStr("66:77:88:99:AA:BB"), "Category1", "Description1"},
+      {mtt::Address::fromStr("CC:DD:EE:FF:00:11"), "Category1", ""}};
+  mtt::PeriodMap period_map;
+  mtt::ColumnarPeriodMap columnar_map(base_time);
+
+  // scans every 5 mins where addresses come and go
+  for (int i_scan = 0; i_scan < 100; ++i_scan) {
+    const mtt::PeriodMap::Period period = {base_time + i_scan * sc::minutes(5),
+                                           base_time + (i_scan + 1) * sc::minutes(5)};
+    for (int i_info = 0; i_info < 3; ++i_info) {
+      if ((i_scan / (i_info + 2)) % 3 != 0) {
+        period_map.insert({period, info[i_info]});
+        columnar_map.insert({period, info[i_info]});
+      }
+    }
+  }
+
+  // same entries in the same order
+  ASSERT_EQ(period_map.size(), columnar_map.size());
+  ASSERT_EQ(period_map.size(), std::distance(columnar_map.begin(), columnar_map.end()));
+  ASSERT_STREQ(period_map.toStr().c_str(), columnar_map.toStr().c_str());
+  ASSERT_STREQ(period_map.filled(sc::minutes(10)).toStr().c_str(),
+               columnar_map.filled(sc::minutes(10)).toStr().c_str());
+  ASSERT_STREQ(period_map.filled(sc::hours(1), "-filled").toStr().c_str(),
+               columnar_map.filled(sc::hours(1), "-filled").toStr().c_str());
+  // the result does not depend on the number of threads
+  for (const unsigned int n_threads : {2u, 3u, 0u}) {
+    ASSERT_STREQ(period_map.filled(sc::hours(1)).toStr().c_str(),
+                 columnar_map.filled(sc::hours(1), "*", n_threads).toStr().c_str());
+  }
+
+  // equal_range()
+  for (const mtt::PeriodMap::value_type &entry : period_map) {
+    const std::pair<mtt::PeriodMap::const_iterator, mtt::PeriodMap::const_iterator> range =
+        period_map.equal_range(entry.first);
+    const std::pair<mtt::ColumnarPeriodMap::const_iterator,
+                    mtt::ColumnarPeriodMap::const_iterator>
+        columnar_range = columnar_map.equal_range(entry.first);
+    ASSERT_EQ(std::distance(range.first, range.second),
+              std::distance(columnar_range.first, columnar_range.second));
+    ASSERT_EQ(range.first->second.address, columnar_range.first->second.address);
+    ASSERT_EQ(entry.first, columnar_range.first.period());
+  }
+  const std::pair<mtt::ColumnarPeriodMap::const_iterator, mtt::ColumnarPeriodMap::const_iterator>
+      missing = columnar_map.equal_range({base_time, base_time + sc::minutes(1)});
+  ASSERT_TRUE(missing.first == missing.second);
+}
+
+TEST(ColumnarPeriodMap, memoryUsage) {
+  namespace sc = std::chrono;
+
+  // a day of 5-minute scans where 3/4 of 200 devices are present
+  const mtt::Time base_time = mtt::Time::fromStr("2021-03-11 00:00:00");
+  mtt::PeriodMap period_map;
+  mtt::ColumnarPeriodMap columnar_map(base_time);
+  for (int i_scan = 0; i_scan < 288; ++i_scan) {
+    const mtt::PeriodMap::Period period = {base_time + i_scan * sc::minutes(5),
+                                           base_time + (i_scan + 1) * sc::minutes(5)};
+    for (int i = 0; i < 200; ++i) {
+      if ((i + i_scan) % 4 != 0) {
+        const std::string person = "person" + boost::lexical_cast<std::string>(i / 2);
+        const mtt::PeriodMap::Info info = {mtt::Address::fromInt(i * 7919), person,
+                                           "phone of " + person};
+        period_map.insert(period_map.end(), {period, info});
+        columnar_map.insert({period, info});
+      }
+    }
+  }
+
+  // the multimap has a node of the entry and 4 pointers per entry,
+  // plus heap blocks of strings out of the small string buffer
+  std::size_t period_map_bytes = 0;
+  for (const mtt::PeriodMap::value_type &entry : period_map) {
+    period_map_bytes += sizeof(entry) + 4 * sizeof(void *);
+    for (const std::string *const str : {&entry.second.category, &entry.second.description}) {
+      if (str->data() < reinterpret_cast<const char *>(str) ||
+          str->data() >= reinterpret_cast<const char *>(str + 1)) {
+        period_map_bytes += str->capacity() + 1;
+      }
+    }
+  }
+  // at least 10x smaller (about 20x as measured with libstdc++ on x86_64)
+  ASSERT_LT(columnar_map.memoryUsage() * 10, period_map_bytes);
+}
+
+TEST(ColumnarPeriodMap, insert) {
+  namespace sc = std::chrono;
+
+  const mtt::Time base_time = mtt::Time::fromStr("2021-03-11 00:00:00");
+  const mtt::PeriodMap::Info info = {mtt::Address::fromStr("00:11:22:33:44:55"), "Category0",
+                                     "Description0"};
+  mtt::ColumnarPeriodMap columnar_map(base_time);
+  columnar_map.insert({{base_time + sc::minutes(5), base_time + sc::minutes(10)}, info});
+  // the same period is ok
+  columnar_map.insert({{base_time + sc::minutes(5), base_time + sc::minutes(10)}, info});
+  // out of order
+  ASSERT_THROW(columnar_map.insert({{base_time, base_time + sc::minutes(5)}, info}),
+               std::runtime_error);
+  ASSERT_THROW(
+      columnar_map.insert({{base_time + sc::minutes(5), base_time + sc::minutes(6)}, info}),
+      std::runtime_error);
+  // not whole seconds
+  ASSERT_THROW(columnar_map.insert({{base_time + sc::minutes(10),
+                                     base_time + sc::minutes(15) + sc::milliseconds(1)},
+                                    info}),
+               std::runtime_error);
+  ASSERT_EQ(2, columnar_map.size());
+
+  // before the base time
+  mtt::ColumnarPeriodMap later_map(base_time + sc::hours(1));
+  ASSERT_THROW(later_map.insert({{base_time, base_time + sc::minutes(5)}, info}),
+               std::runtime_error);
+  ASSERT_TRUE(later_map.empty());
+  ASSERT_TRUE(later_map.begin() == later_map.end());
+}
+
+TEST(ColumnarPeriodMap, carryOver) {
+  namespace sc = std::chrono;
+
+  const mtt::Time base_time = mtt::Time::fromStr("2021-03-12 00:00:00");
+  const mtt::PeriodMap::Info info[] = {
+      {mtt::Address::fromStr("00:11:22:33:44:55"), "Category0", "Description0"},
+      {mtt::Address::fromStr("66:77:88:99:AA:BB"), "Category1", "Description1"},
+      {mtt::Address::fromStr("CC:DD:EE:FF:00:11"), "Category2", "Description2"}};
+
+  // the previous tracking period
+  mtt::ColumnarPeriodMap prev_map(base_time - sc::hours(24));
+  prev_map.insert({{base_time - sc::hours(2), base_time - sc::minutes(115)}, info[1]});
+  prev_map.insert({{base_time - sc::minutes(10), base_time - sc::minutes(5)}, info[0]});
+  prev_map.insert({{base_time - sc::minutes(5), base_time}, info[2]});
+
+  // this tracking period
+  mtt::ColumnarPeriodMap columnar_map(base_time);
+  columnar_map.carryOver(prev_map, sc::hours(1));
+  columnar_map.insert({{base_time + sc::minutes(5), base_time + sc::minutes(10)}, info[1]});
+  columnar_map.insert({{base_time + sc::minutes(5), base_time + sc::minutes(10)}, info[2]});
+  columnar_map.insert({{base_time + sc::minutes(10), base_time + sc::minutes(15)}, info[0]});
+  ASSERT_EQ(3, columnar_map.size());
+
+  // gaps over the base time are filled from the base time
+  // except the one of info[1] that is longer than 1 hour
+  for (const unsigned int n_threads : {1u, 3u}) {
+    const mtt::PeriodMap filled_map = columnar_map.filled(sc::hours(1), "-filled", n_threads);
+    ASSERT_EQ(5, filled_map.size());
+    const mtt::PeriodMap::const_iterator filled_entry[] = {
+        filled_map.find({base_time, base_time + sc::minutes(10)}),
+        filled_map.find({base_time, base_time + sc::minutes(5)})};
+    ASSERT_NE(filled_map.end(), filled_entry[0]);
+    ASSERT_EQ(info[0].address, filled_entry[0]->second.address);
+    ASSERT_EQ(info[0].description + "-filled", filled_entry[0]->second.description);
+    ASSERT_NE(filled_map.end(), filled_entry[1]);
+    ASSERT_EQ(info[2].address, filled_entry[1]->second.address);
+    ASSERT_EQ(1, filled_map.count({base_time, base_time + sc::minutes(5)}));
+  }
+
+  // entries carried to the previous map are carried again if they are new enough
+  mtt::ColumnarPeriodMap empty_map(base_time);
+  empty_map.carryOver(prev_map, sc::hours(1));
+  mtt::ColumnarPeriodMap next_map(base_time + sc::minutes(20));
+  next_map.carryOver(empty_map, sc::hours(1));
+  next_map.insert({{base_time + sc::minutes(30), base_time + sc::minutes(35)}, info[0]});
+  const mtt::PeriodMap next_filled_map = next_map.filled(sc::hours(1));
+  ASSERT_EQ(2, next_filled_map.size());
+  ASSERT_EQ(base_time + sc::minutes(20), next_filled_map.begin()->first.first);
+  ASSERT_EQ("Description0*", next_filled_map.begin()->second.description);
+}
@@ -0,0 +1,52 @@
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <mac_time_tracker/csv.hpp>
+#include <mac_time_tracker/gzip.hpp>
+
+#include "make_temp_file.hpp"
+
+namespace mtt = mac_time_tracker;
+
+TEST(Gzip, gzipFile) {
+  std::string contents;
+  for (int i = 0; i < 10000; ++i) {
+    contents += R"("2021-03-11 10:00:00","2021-03-11 10:05:00","00:11:22:33:44:55","Tom","")"
+                "\n";
+  }
+  const std::string src_file = makeTempFile(contents), dst_file = src_file + ".gz";
+  ASSERT_NO_THROW(mtt::gzipFile(src_file, dst_file));
+  // the source is removed and the destination is much smaller
+  ASSERT_FALSE(std::ifstream(src_file));
+  std::ifstream dst(dst_file, std::ios::binary | std::ios::ate);
+  ASSERT_TRUE(dst);
+  ASSERT_LT(dst.tellg(), contents.size() / 10);
+  // missing source
+  ASSERT_THROW(mtt::gzipFile(src_file, dst_file), std::runtime_error);
+}
+
+TEST(Gzip, GzipIFStream) {
+  const std::string contents = "Field 0,Field 1\nField 2\n";
+  // plain file
+  {
+    mtt::GzipIFStream ifs(makeTempFile(contents));
+    ASSERT_TRUE(ifs);
+    ASSERT_EQ(contents, std::string(std::istreambuf_iterator<char>(ifs), {}));
+  }
+  // compressed file, which is transparently read by Readable::fromFile()
+  {
+    const std::string src_file = makeTempFile(contents), dst_file = src_file + ".gz";
+    mtt::gzipFile(src_file, dst_file);
+    mtt::GzipIFStream ifs(dst_file);
+    ASSERT_TRUE(ifs);
+    ASSERT_EQ(contents, std::string(std::istreambuf_iterator<char>(ifs), {}));
+    const mtt::CSV csv = mtt::CSV::fromFile(dst_file);
+    ASSERT_EQ(2, csv.size());
+    ASSERT_EQ("Field 1", csv[0][1]);
+  }
+  // missing file
+  ASSERT_FALSE(mtt::GzipIFStream("/path/that/does/not/exist"));
+}
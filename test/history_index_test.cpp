@@ -0,0 +1,96 @@
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <mac_time_tracker/address.hpp>
+#include <mac_time_tracker/history_index.hpp>
+#include <mac_time_tracker/period_map.hpp>
+#include <mac_time_tracker/time.hpp>
+
+#include "make_temp_file.hpp"
+
+namespace mtt = mac_time_tracker;
+
+TEST(HistoryIndex, add) {
+  const mtt::Time t0 = mtt::Time::fromStr("2021-03-11 10:00:00");
+  const std::chrono::minutes five(5);
+  const mtt::Address addr = mtt::Address::fromStr("00:11:22:33:44:55");
+  mtt::HistoryIndex index;
+  // contiguous periods are coalesced
+  index.add(addr, {t0, t0 + five});
+  index.add(addr, {t0 + five, t0 + 2 * five});
+  index.add(addr, {t0 + 4 * five, t0 + 5 * five});
+  ASSERT_EQ(2u, index.intervals().at(addr.toInt()).size());
+  // an earlier period that bridges the gap
+  index.add(addr, {t0 + 2 * five, t0 + 4 * five});
+  ASSERT_EQ(1u, index.intervals().at(addr.toInt()).size());
+  // an earlier disjoint period, and the same period again
+  index.add(addr, {t0 - 3 * five, t0 - 2 * five});
+  index.add(addr, {t0 - 3 * five, t0 - 2 * five});
+  ASSERT_EQ(2u, index.intervals().at(addr.toInt()).size());
+
+  mtt::Time last;
+  ASSERT_TRUE(index.lastSeen(addr, &last));
+  ASSERT_EQ(t0 + 5 * five, last);
+  ASSERT_FALSE(index.lastSeen(mtt::Address::fromInt(0), &last));
+  const std::vector<mtt::PeriodMap::Period> presence =
+      index.presence(addr, t0 - 2 * five, t0 + five);
+  ASSERT_EQ(1u, presence.size());
+  ASSERT_EQ(t0, presence[0].first);
+  ASSERT_EQ(t0 + five, presence[0].second);
+
+  // merge another index
+  mtt::HistoryIndex other;
+  other.add(addr, {t0 + 5 * five, t0 + 6 * five});
+  other.add(mtt::Address::fromInt(0), {t0, t0 + five});
+  index.add(other);
+  ASSERT_EQ(2u, index.size());
+  ASSERT_EQ(2u, index.intervals().at(addr.toInt()).size());
+  ASSERT_TRUE(index.lastSeen(addr, &last));
+  ASSERT_EQ(t0 + 6 * five, last);
+}
+
+TEST(HistoryIndex, file) {
+  const mtt::Time t0 = mtt::Time::fromStr("2021-03-11 10:00:00");
+  const std::chrono::minutes five(5);
+  mtt::PeriodMap entries;
+  for (int i = 0; i < 100; ++i) {
+    // each address is present in every i+1 periods
+    for (int j = 0; j < 100; j += i + 1) {
+      entries.insert({{t0 + j * five, t0 + (j + 1) * five}, {mtt::Address::fromInt(i), "", ""}});
+    }
+  }
+  const std::string filename = makeTempFile();
+  std::remove(filename.c_str());
+  mtt::HistoryIndex index = mtt::HistoryIndex::fromFile(filename); // missing file
+  ASSERT_EQ(0u, index.size());
+  index.add(entries.begin(), entries.end());
+  index.toFile(filename);
+
+  const mtt::HistoryIndex::File file(filename);
+  ASSERT_EQ(100u, file.size());
+  for (int i = 0; i < 100; ++i) {
+    const mtt::Address addr = mtt::Address::fromInt(i);
+    mtt::Time expected, actual;
+    ASSERT_EQ(index.lastSeen(addr, &expected), file.lastSeen(addr, &actual));
+    ASSERT_EQ(expected, actual);
+    ASSERT_EQ(index.presence(addr, t0 + 7 * five, t0 + 50 * five),
+              file.presence(addr, t0 + 7 * five, t0 + 50 * five));
+  }
+  mtt::Time last;
+  ASSERT_FALSE(file.lastSeen(mtt::Address::fromInt(100), &last));
+  ASSERT_EQ(1u, file.presence(mtt::Address::fromInt(0), t0, t0 + 1000 * five).size());
+
+  // loaded back
+  const mtt::HistoryIndex loaded = mtt::HistoryIndex::fromFile(filename);
+  ASSERT_EQ(index.size(), loaded.size());
+
+  // broken
+  std::ofstream(filename) << "broken";
+  ASSERT_THROW(mtt::HistoryIndex::File file(filename), std::runtime_error);
+}
@@ -0,0 +1,47 @@
+#include <cstdint>
+#include <stdexcept>
+
+#include <gtest/gtest.h>
+
+#include <mac_time_tracker/address.hpp>
+#include <mac_time_tracker/hyper_log_log.hpp>
+
+namespace mtt = mac_time_tracker;
+
+TEST(HyperLogLog, estimate) {
+  mtt::HyperLogLog hll;
+  ASSERT_DOUBLE_EQ(0., hll.estimate());
+  // small cardinality is almost exact thanks to linear counting
+  for (std::uint64_t i = 0; i < 100; ++i) {
+    hll.insert(mtt::Address::fromInt(i));
+    hll.insert(mtt::Address::fromInt(i)); // duplicates are not counted
+  }
+  ASSERT_NEAR(100., hll.estimate(), 2.);
+  // large cardinality is within a few percent
+  for (std::uint64_t i = 0; i < 100000; ++i) {
+    hll.insert(mtt::Address::fromInt(0x020000000000ull + i * 7919));
+  }
+  ASSERT_NEAR(100100., hll.estimate(), 100100. * 0.05);
+  // clear
+  hll.clear();
+  ASSERT_DOUBLE_EQ(0., hll.estimate());
+}
+
+TEST(HyperLogLog, merge) {
+  mtt::HyperLogLog a, b;
+  for (std::uint64_t i = 0; i < 1000; ++i) {
+    a.insert(mtt::Address::fromInt(i));
+    b.insert(mtt::Address::fromInt(i + 500));
+  }
+  a.merge(b);
+  ASSERT_NEAR(1500., a.estimate(), 1500. * 0.05);
+}
+
+TEST(HyperLogLog, precision) {
+  ASSERT_THROW(mtt::HyperLogLog(0), std::runtime_error);
+  ASSERT_THROW(mtt::HyperLogLog(3), std::runtime_error);
+  ASSERT_THROW(mtt::HyperLogLog(19), std::runtime_error);
+  mtt::HyperLogLog hll(4);
+  hll.insert(mtt::Address::fromInt(1));
+  ASSERT_NEAR(1., hll.estimate(), 0.1);
+}
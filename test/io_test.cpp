@@ -13,7 +13,9 @@
 namespace mtt = mac_time_tracker;
 
 template <class T0, class T1>
-class Pair : public std::pair<T0, T1>, public mtt::Readable<Pair<T0, T1>>, public mtt::Writable {
+class Pair : public std::pair<T0, T1>,
+             public mtt::Readable<Pair<T0, T1>>,
+             public mtt::Writable<Pair<T0, T1>> {
 private:
   using Base = std::pair<T0, T1>;
 
@@ -21,9 +23,12 @@ public:
   using Base::Base;
 
 private:
-  virtual void read(std::istream &is) override { is >> Base::first >> Base::second; }
+  friend class mtt::Readable<Pair<T0, T1>>;
+  friend class mtt::Writable<Pair<T0, T1>>;
 
-  virtual void write(std::ostream &os) const override {
+  void read(std::istream &is) { is >> Base::first >> Base::second; }
+
+  void write(std::ostream &os) const {
     os << "{" << Base::first << ", " << Base::second << "}";
   }
 };
@@ -71,6 +76,19 @@ TEST(Readable, fromStr) {
   ASSERT_EQ(3, p.second);
 }
 
+TEST(Readable, fromChars) {
+  using P = Pair<int, int>;
+  const std::string str = " 12 34 56";
+  P p;
+  // parsed chars only
+  const char *const end = P::fromChars(str.data(), str.data() + str.size(), &p);
+  ASSERT_EQ(str.data() + 6, end);
+  ASSERT_EQ(12, p.first);
+  ASSERT_EQ(34, p.second);
+  // the end of the range ends the input
+  ASSERT_EQ(nullptr, P::fromChars(str.data(), str.data() + 4, &p));
+}
+
 TEST(Readable, fromFile) {
   using P = Pair<Pair<Pair<int, int>, std::string>, std::string>;
   P p;
@@ -98,4 +116,19 @@ TEST(Writable, toStreamAndStr) {
     ASSERT_STREQ("{{12, 34}, foo}", oss.str().c_str());
     ASSERT_STREQ("{{12, 34}, foo}", p.toStr().c_str());
   }
-}
\ No newline at end of file
+}
+
+TEST(Writable, toChars) {
+  const Pair<int, int> p = {12, 34};
+  char buf[8];
+  char *const end = p.toChars(buf, buf + sizeof(buf));
+  ASSERT_EQ(buf + 8, end);
+  ASSERT_EQ("{12, 34}", std::string(buf, end));
+  // too few chars
+  ASSERT_EQ(nullptr, p.toChars(buf, buf + 7));
+}
+
+TEST(Writable, noOverhead) {
+  // the I/O bases add neither a vtable pointer nor a byte
+  ASSERT_EQ(sizeof(std::pair<int, int>), sizeof(Pair<int, int>));
+}
@@ -0,0 +1,61 @@
+#include <chrono>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <mac_time_tracker/address.hpp>
+#include <mac_time_tracker/csv.hpp>
+#include <mac_time_tracker/occupancy.hpp>
+#include <mac_time_tracker/period_map.hpp>
+#include <mac_time_tracker/time.hpp>
+
+namespace mtt = mac_time_tracker;
+namespace sc = std::chrono;
+
+TEST(Occupancy, insert) {
+  const mtt::Time base = mtt::Time::fromStr("2021-03-11 00:00:00");
+  const mtt::Address a = mtt::Address::fromInt(1), b = mtt::Address::fromInt(2),
+                     c = mtt::Address::fromInt(3);
+  mtt::Occupancy occupancy(base, sc::hours(1));
+  // scans every 30 minutes. the last one overlaps two slots.
+  const mtt::PeriodMap::Period periods[] = {{base, base + sc::minutes(30)},
+                                            {base + sc::minutes(30), base + sc::minutes(60)},
+                                            {base + sc::minutes(60), base + sc::minutes(90)},
+                                            {base + sc::minutes(90), base + sc::minutes(150)}};
+  occupancy.insert(periods[0], {a, "Alice", "Phone"});
+  occupancy.insert(periods[0], {b, "Bob", "Phone"});
+  occupancy.insert(periods[1], {a, "Alice", "Phone"});
+  occupancy.insert(periods[1], {c, "Alice", "PC"});
+  ASSERT_EQ(periods[1], occupancy.latestPeriod());
+  ASSERT_EQ(mtt::Occupancy::Counts({{"Alice", 2}}), occupancy.latest());
+  // an empty scan
+  occupancy.beginPeriod(periods[2]);
+  ASSERT_TRUE(occupancy.latest().empty());
+  occupancy.insert(periods[3], {a, "Alice", "Phone"});
+  ASSERT_EQ(mtt::Occupancy::Counts({{"Alice", 1}}), occupancy.latest());
+  // a device is counted once per slot
+  const std::map<mtt::Time, mtt::Occupancy::Counts> expected = {
+      {base, {{"Alice", 2}, {"Bob", 1}}},
+      {base + sc::hours(1), {{"Alice", 1}}},
+      {base + sc::hours(2), {{"Alice", 1}}}};
+  ASSERT_EQ(expected, occupancy.slots());
+  ASSERT_EQ(base - sc::hours(1), occupancy.slotStart(base - sc::minutes(1)));
+}
+
+TEST(Occupancy, outputs) {
+  const mtt::Time base = mtt::Time::fromStr("2021-03-11 00:00:00");
+  mtt::Occupancy occupancy(base, sc::hours(1));
+  occupancy.insert({base, base + sc::minutes(5)}, {mtt::Address::fromInt(1), "A\"B", "Phone"});
+  const mtt::CSV csv = mtt::CSV::fromStr(occupancy.toStr());
+  ASSERT_EQ(1u, csv.size());
+  ASSERT_EQ(std::vector<std::string>({"2021-03-11 00:00:00", "2021-03-11 01:00:00", "A\"B", "1"}),
+            csv[0]);
+  ASSERT_EQ("{\"latest\": {\"start\": \"2021-03-11 00:00:00\", \"end\": \"2021-03-11 00:05:00\","
+            " \"devices\": {\"A\\\"B\": 1}},\n"
+            " \"slots\": [\n"
+            "   {\"start\": \"2021-03-11 00:00:00\", \"end\": \"2021-03-11 01:00:00\","
+            " \"devices\": {\"A\\\"B\": 1}}]}\n",
+            occupancy.toJSON());
+  const std::string entries = occupancy.toHTMLEntries();
+  ASSERT_EQ(0u, entries.find("['A\"B', new Date("));
+}
@@ -0,0 +1,111 @@
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <mac_time_tracker/output_sink.hpp>
+
+#include "make_temp_file.hpp"
+
+namespace mtt = mac_time_tracker;
+
+static std::string readAll(const std::string &filename) {
+  std::ifstream ifs(filename);
+  std::ostringstream oss;
+  oss << ifs.rdbuf();
+  return oss.str();
+}
+
+TEST(OutputFanOut, files) {
+  const std::vector<std::string> files = {makeTempFile(), makeTempFile()};
+  mtt::OutputFanOut outputs(files);
+  ASSERT_EQ(2u, outputs.size());
+  ASSERT_FALSE(outputs.written());
+
+  ASSERT_TRUE(outputs.write("foo"));
+  ASSERT_TRUE(outputs.written());
+  ASSERT_EQ("foo", readAll(files[0]));
+  ASSERT_EQ("foo", readAll(files[1]));
+
+  // unchanged contents are not written again
+  std::remove(files[1].c_str());
+  ASSERT_FALSE(outputs.write("foo"));
+  ASSERT_FALSE(std::ifstream(files[1]));
+
+  // changes are detected by the key if given
+  ASSERT_FALSE(outputs.write("bar", "foo"));
+  ASSERT_TRUE(outputs.write("bar", "bar"));
+  ASSERT_EQ("bar", readAll(files[0]));
+  ASSERT_EQ("bar", readAll(files[1]));
+
+  // a failed sink does not stop the others and is retried alone
+  mtt::OutputFanOut broken({files[0], "/nonexistent/dir/file"});
+  ASSERT_TRUE(broken.write("baz"));
+  ASSERT_EQ(1u, broken.errors().size());
+  ASSERT_FALSE(broken.written());
+  ASSERT_EQ("baz", readAll(files[0]));
+  std::remove(files[0].c_str());
+  ASSERT_FALSE(broken.write("baz"));
+  ASSERT_EQ(1u, broken.errors().size());
+  ASSERT_FALSE(std::ifstream(files[0]));
+  ASSERT_TRUE(broken.write("qux"));
+  ASSERT_EQ("qux", readAll(files[0]));
+}
+
+TEST(OutputFanOut, unixSocket) {
+  const std::string path = makeTempFile() + ".sock";
+  const int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  ASSERT_GE(listener, 0);
+  sockaddr_un addr = {};
+  addr.sun_family = AF_UNIX;
+  path.copy(addr.sun_path, sizeof(addr.sun_path) - 1);
+  ASSERT_EQ(0, ::bind(listener, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr)));
+  ASSERT_EQ(0, ::listen(listener, 1));
+
+  // receive until EOF
+  std::string received;
+  std::thread receiver([listener, &received]() {
+    const int fd = ::accept(listener, nullptr, nullptr);
+    char buf[256];
+    ssize_t n;
+    while ((n = ::read(fd, buf, sizeof(buf))) > 0) {
+      received.append(buf, n);
+    }
+    ::close(fd);
+  });
+  const std::string contents(10000, 'x');
+  mtt::OutputFanOut outputs({"unix:" + path});
+  ASSERT_TRUE(outputs.write(contents));
+  receiver.join();
+  ASSERT_EQ(contents, received);
+  ::close(listener);
+  std::remove(path.c_str());
+
+  // a listener that never reads does not block the writer beyond the timeout
+  const int stuck = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  ASSERT_GE(stuck, 0);
+  ASSERT_EQ(0, ::bind(stuck, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr)));
+  ASSERT_EQ(0, ::listen(stuck, 1));
+  mtt::UnixSocketSink slow_sink(path, std::chrono::milliseconds(100));
+  const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  ASSERT_THROW(slow_sink.write(std::string(16 << 20, 'x')), std::runtime_error);
+  ASSERT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+  ::close(stuck);
+  std::remove(path.c_str());
+
+  // nobody listens
+  mtt::OutputFanOut missing({"unix:" + path});
+  ASSERT_TRUE(missing.write(contents));
+  ASSERT_EQ(1u, missing.errors().size());
+  ASSERT_FALSE(missing.written());
+}
@@ -0,0 +1,35 @@
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <mac_time_tracker/parallel.hpp>
+
+namespace mtt = mac_time_tracker;
+
+TEST(Parallel, parallelFor) {
+  std::vector<int> results(8, 0);
+  mtt::parallelFor(results.size(), [&results](const unsigned int i) { results[i] = i * i; });
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    ASSERT_EQ(int(i * i), results[i]);
+  }
+
+  // nothing to do
+  mtt::parallelFor(0, [](const unsigned int) { throw std::runtime_error("never"); });
+
+  // all calls finish even if some throw
+  std::vector<int> finished(4, 0);
+  ASSERT_THROW(mtt::parallelFor(finished.size(),
+                                [&finished](const unsigned int i) {
+                                  finished[i] = 1;
+                                  if (i % 2 == 1) {
+                                    throw std::runtime_error("odd");
+                                  }
+                                }),
+               std::runtime_error);
+  ASSERT_EQ(std::vector<int>(4, 1), finished);
+
+  ASSERT_EQ(3, mtt::resolveThreads(3));
+  ASSERT_LE(1, mtt::resolveThreads(0));
+}
@@ -1,5 +1,8 @@
+#include <algorithm> // for std::count()
 #include <chrono>
+#include <fstream>
 #include <iterator> // for std::distance()
+#include <stdexcept>
 #include <string>
 
 #include <boost/lexical_cast.hpp>
@@ -10,6 +13,8 @@
 #include <mac_time_tracker/period_map.hpp>
 #include <mac_time_tracker/time.hpp>
 
+#include "make_temp_file.hpp"
+
 namespace mtt = mac_time_tracker;
 
 TEST(PeriodMap, generalUse) {
@@ -98,4 +103,58 @@ TEST(PeriodMap, filled) {
   ASSERT_EQ(info[0].address, filled_entry[1]->second.address);
   ASSERT_EQ(info[0].category, filled_entry[1]->second.category);
   ASSERT_EQ(info[0].description + "-filled", filled_entry[1]->second.description);
-}
\ No newline at end of file
+}
+TEST(PeriodMap, fromFile) {
+  namespace sc = std::chrono;
+
+  const mtt::Time base_time = mtt::Time::fromStr("2021-03-11 10:00:00");
+  mtt::PeriodMap src_map;
+  src_map.insert({{base_time, base_time + sc::minutes(5)},
+                  {mtt::Address::fromStr("00:11:22:33:44:55"), "Category0", "Description0"}});
+  src_map.insert({{base_time + sc::minutes(5), base_time + sc::minutes(10)},
+                  {mtt::Address::fromStr("66:77:88:99:AA:BB"), "Category1", ""}});
+
+  // round trip via a file
+  const std::string temp_file = makeTempFile();
+  src_map.toFile(temp_file);
+  const mtt::PeriodMap dst_map = mtt::PeriodMap::fromFile(temp_file);
+  ASSERT_EQ(src_map.size(), dst_map.size());
+  ASSERT_STREQ(src_map.toStr().c_str(), dst_map.toStr().c_str());
+
+  // ill-formed files
+  ASSERT_THROW(mtt::PeriodMap::fromFile(makeTempFile("2021-03-11 10:00:00, 2021-03-11 10:05:00")),
+               std::runtime_error);
+  ASSERT_THROW(mtt::PeriodMap::fromFile(makeTempFile(
+                   "2021-03-11 10:00:00, 10:05, 00:11:22:33:44:55, Category0, Description0")),
+               std::runtime_error);
+}
+
+TEST(PeriodMap, toHTML) {
+  namespace sc = std::chrono;
+
+  const mtt::Time base_time = mtt::Time::fromStr("2021-03-11 10:00:00");
+  mtt::PeriodMap period_map;
+  for (int i = 0; i < 10; ++i) {
+    period_map.insert(
+        {{base_time + i * sc::minutes(5), base_time + (i + 1) * sc::minutes(5)},
+         {mtt::Address::fromStr("00:11:22:33:44:55"), "Category0", "Description0"}});
+  }
+
+  // the result does not depend on the number of threads
+  std::string expected;
+  for (const unsigned int n_threads : {1u, 3u, 16u}) {
+    const std::string temp_file = makeTempFile();
+    period_map.toHTML(temp_file, "@DATE@\n@DATA_ENTRIES@\n", mtt::Time::defaultFormat(),
+                      mtt::Address::defaultSeparator(), base_time, n_threads);
+    std::ifstream ifs(temp_file);
+    const std::string actual((std::istreambuf_iterator<char>(ifs)),
+                             std::istreambuf_iterator<char>());
+    if (n_threads == 1) {
+      // a line of the date and 10 lines of the entries
+      ASSERT_EQ(1 + 10, std::count(actual.begin(), actual.end(), '\n'));
+      expected = actual;
+    } else {
+      ASSERT_EQ(expected, actual);
+    }
+  }
+}
@@ -0,0 +1,51 @@
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <mac_time_tracker/period_map.hpp>
+#include <mac_time_tracker/period_merger.hpp>
+
+namespace mtt = mac_time_tracker;
+
+TEST(PeriodMerger, next) {
+  std::istringstream inputs[] = {
+      std::istringstream("2021-03-11 10:00:00,2021-03-11 10:05:00,00:11:22:33:44:55,Tom,PC\n"
+                         "2021-03-11 10:05:00,2021-03-11 10:10:00,00:11:22:33:44:55,Tom,PC\n"
+                         "2021-03-11 10:05:00,2021-03-11 10:10:00,66:77:88:99:AA:BB,Dick,"),
+      std::istringstream(""),
+      std::istringstream("2021-03-11 10:05:00,2021-03-11 10:10:00,00:11:22:33:44:55,Tom,PC\n"
+                         "2021-03-11 10:05:00,2021-03-11 10:10:00,22:33:44:55:66:77,Harry,\n"
+                         "2021-03-11 10:15:00,2021-03-11 10:20:00,22:33:44:55:66:77,Harry,")};
+  mtt::PeriodMerger merger({&inputs[0], &inputs[1], &inputs[2]});
+  std::vector<mtt::PeriodMerger::Entry> group;
+  // 10:00 from the input 0
+  ASSERT_TRUE(merger.next(&group));
+  ASSERT_EQ(1, group.size());
+  ASSERT_EQ(mtt::Time::fromStr("2021-03-11 10:00:00"), group[0].first.first);
+  // 10:05 from the inputs 0 and 2 without the duplicate, sorted by address
+  ASSERT_TRUE(merger.next(&group));
+  ASSERT_EQ(3, group.size());
+  ASSERT_EQ(mtt::Time::fromStr("2021-03-11 10:05:00"), group[0].first.first);
+  ASSERT_STREQ("Tom", group[0].second.category.c_str());
+  ASSERT_STREQ("Harry", group[1].second.category.c_str());
+  ASSERT_STREQ("Dick", group[2].second.category.c_str());
+  // 10:15 from the input 2
+  ASSERT_TRUE(merger.next(&group));
+  ASSERT_EQ(1, group.size());
+  ASSERT_EQ(mtt::Time::fromStr("2021-03-11 10:15:00"), group[0].first.first);
+  // end
+  ASSERT_FALSE(merger.next(&group));
+  ASSERT_TRUE(group.empty());
+}
+
+TEST(PeriodMerger, unsorted) {
+  std::istringstream input(
+      "2021-03-11 10:05:00,2021-03-11 10:10:00,00:11:22:33:44:55,Tom,PC\n"
+      "2021-03-11 10:00:00,2021-03-11 10:05:00,00:11:22:33:44:55,Tom,PC");
+  mtt::PeriodMerger merger({&input});
+  std::vector<mtt::PeriodMerger::Entry> group;
+  ASSERT_THROW(merger.next(&group), std::runtime_error);
+}
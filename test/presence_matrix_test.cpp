@@ -0,0 +1,116 @@
+#include <chrono>
+#include <cstddef>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <mac_time_tracker/address.hpp>
+#include <mac_time_tracker/bit_kernels.hpp>
+#include <mac_time_tracker/period_map.hpp>
+#include <mac_time_tracker/presence_matrix.hpp>
+#include <mac_time_tracker/time.hpp>
+
+namespace mtt = mac_time_tracker;
+
+static void assertSameBits(const mtt::PresenceMatrix &a, const mtt::PresenceMatrix &b) {
+  ASSERT_EQ(a.rows(), b.rows());
+  ASSERT_EQ(a.slots(), b.slots());
+  for (std::size_t row = 0; row < a.rows(); ++row) {
+    ASSERT_EQ(a.device(row).address, b.device(row).address);
+    for (std::size_t slot = 0; slot < a.slots(); ++slot) {
+      ASSERT_EQ(a.test(row, slot), b.test(row, slot)) << "row=" << row << ", slot=" << slot;
+    }
+  }
+}
+
+TEST(PresenceMatrix, insert) {
+  namespace sc = std::chrono;
+  const mtt::Time start = mtt::Time::fromStr("2021-03-11 00:00:00");
+  const mtt::PeriodMap::Info info0 = {mtt::Address::fromStr("00:11:22:33:44:55"), "A", "PC"},
+                             info1 = {mtt::Address::fromStr("66:77:88:99:AA:BB"), "B", "Phone"};
+  mtt::PresenceMatrix matrix(start, sc::minutes(5), 12);
+  matrix.insert({start + sc::minutes(5), start + sc::minutes(15)}, info0);
+  // slots overlapping the period, clipped by the matrix
+  matrix.insert({start + sc::minutes(52), start + sc::minutes(70)}, info1);
+  matrix.insert({start - sc::minutes(10), start + sc::minutes(1)}, info1);
+  ASSERT_EQ(2u, matrix.rows());
+  ASSERT_EQ("A", matrix.device(0).category);
+  ASSERT_EQ("B", matrix.device(1).category);
+  const std::vector<bool> expected0 = {0, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0},
+                          expected1 = {1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1};
+  for (std::size_t slot = 0; slot < 12; ++slot) {
+    ASSERT_EQ(expected0[slot], matrix.test(0, slot));
+    ASSERT_EQ(expected1[slot], matrix.test(1, slot));
+  }
+  ASSERT_EQ(2u, matrix.presentSlots(0));
+  ASSERT_EQ(5u, matrix.totalPresentSlots());
+  ASSERT_EQ(sc::minutes(15), matrix.presence()[1]);
+
+  // back to entries
+  const mtt::PeriodMap map = matrix.toPeriodMap();
+  ASSERT_EQ(3u, map.size());
+  ASSERT_EQ(mtt::PresenceMatrix::fromRange(map.begin(), map.end(), start, sc::minutes(5), 12)
+                .toPeriodMap()
+                .toStr(),
+            map.toStr());
+}
+
+// filling is same as PeriodMap::filled() on any slots and max_fill
+TEST(PresenceMatrix, filled) {
+  namespace sc = std::chrono;
+  const mtt::Time start = mtt::Time::fromStr("2021-03-11 00:00:00");
+  std::mt19937 rng(1);
+  std::vector<bool> simds(1, false);
+  if (mtt::BitKernels::hasAVX2()) {
+    simds.push_back(true);
+  }
+  for (const std::size_t n_slots : {1, 7, 64, 100, 288}) {
+    mtt::PeriodMap map;
+    for (std::size_t slot = 0; slot < n_slots; ++slot) {
+      for (std::uint64_t i = 0; i < 20; ++i) {
+        // devices with various densities
+        if (std::uniform_int_distribution<std::uint64_t>(0, 19)(rng) < i) {
+          map.insert({{start + sc::minutes(5 * slot), start + sc::minutes(5 * (slot + 1))},
+                      {mtt::Address::fromInt(i), "Category" + std::to_string(i % 3), ""}});
+        }
+      }
+    }
+    const mtt::PresenceMatrix matrix =
+        mtt::PresenceMatrix::fromRange(map.begin(), map.end(), start, sc::minutes(5), n_slots);
+    for (const int max_fill : {0, 4, 5, 14, 60, 24 * 60}) {
+      const mtt::PeriodMap filled_map = map.filled(sc::minutes(max_fill));
+      const mtt::PresenceMatrix expected = mtt::PresenceMatrix::fromRange(
+          filled_map.begin(), filled_map.end(), start, sc::minutes(5), n_slots);
+      for (const bool simd : simds) {
+        assertSameBits(expected, matrix.filled(sc::minutes(max_fill), simd));
+        ASSERT_EQ(expected.totalPresentSlots(false),
+                  matrix.filled(sc::minutes(max_fill), simd).totalPresentSlots(simd));
+      }
+    }
+  }
+}
+
+TEST(PresenceMatrix, coPresence) {
+  namespace sc = std::chrono;
+  const mtt::Time start = mtt::Time::fromStr("2021-03-11 00:00:00");
+  mtt::PresenceMatrix matrix(start, sc::minutes(5), 300);
+  const auto insert = [&](const std::uint64_t addr, const std::string &category,
+                          const int first_slot, const int last_slot) {
+    matrix.insert({start + sc::minutes(5 * first_slot), start + sc::minutes(5 * last_slot)},
+                  {mtt::Address::fromInt(addr), category, ""});
+  };
+  insert(0, "A", 0, 100);
+  insert(1, "A", 50, 150); // A is present in [0, 150)
+  insert(2, "B", 120, 200);
+  insert(3, "C", 280, 300);
+  for (const bool simd : {false, mtt::BitKernels::hasAVX2()}) {
+    std::vector<std::string> categories;
+    const std::vector<std::vector<std::size_t>> counts = matrix.coPresence(&categories, simd);
+    ASSERT_EQ(std::vector<std::string>({"A", "B", "C"}), categories);
+    ASSERT_EQ(std::vector<std::size_t>({150, 30, 0}), counts[0]);
+    ASSERT_EQ(std::vector<std::size_t>({30, 80, 0}), counts[1]);
+    ASSERT_EQ(std::vector<std::size_t>({0, 0, 20}), counts[2]);
+  }
+}
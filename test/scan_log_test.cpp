@@ -0,0 +1,85 @@
+#include <chrono>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <mac_time_tracker/address.hpp>
+#include <mac_time_tracker/scan_log.hpp>
+#include <mac_time_tracker/scan_records.hpp>
+#include <mac_time_tracker/set.hpp>
+#include <mac_time_tracker/time.hpp>
+
+#include "make_temp_file.hpp"
+
+namespace mtt = mac_time_tracker;
+
+static std::size_t fileSize(const std::string &filename) {
+  std::ifstream ifs(filename, std::ios::binary | std::ios::ate);
+  return ifs.tellg();
+}
+
+// scans of many stable addresses where a few come and go
+static mtt::ScanRecords makeRecords() {
+  const mtt::Time time = mtt::Time::fromStr("2021-03-11 10:00:03");
+  mtt::ScanRecords records;
+  for (int i_scan = 0; i_scan < 10; ++i_scan) {
+    mtt::Set &addrs = records[time + i_scan * std::chrono::minutes(5)];
+    for (std::uint64_t i = 0; i < 200; ++i) {
+      if (i >= 5 || (i + i_scan) % 3 != 0) {
+        addrs.insert(mtt::Address::fromInt(0x001122000000ull + i * 977));
+      }
+    }
+  }
+  records[time + std::chrono::minutes(50)]; // an empty scan
+  return records;
+}
+
+TEST(ScanLog, roundTrip) {
+  const mtt::ScanRecords src_records = makeRecords();
+  const std::string filename = makeTempFile();
+  {
+    mtt::ScanLog log(filename);
+    for (const mtt::ScanRecords::value_type &record : src_records) {
+      log.append(record.first, record.second);
+    }
+    ASSERT_EQ(src_records.size(), log.size());
+  }
+  ASSERT_TRUE(mtt::ScanLog::isLog(filename));
+  ASSERT_EQ(src_records, mtt::ScanLog::fromFile(filename));
+  // much smaller than the CSV as most scans are stored as a few changes
+  ASSERT_LT(fileSize(filename) * 10, src_records.toStr().size());
+
+  // the CSV is not a log
+  const std::string csv_filename = makeTempFile(src_records.toStr());
+  ASSERT_FALSE(mtt::ScanLog::isLog(csv_filename));
+  ASSERT_THROW(mtt::ScanLog::fromFile(csv_filename), std::runtime_error);
+  ASSERT_THROW(mtt::ScanLog log(csv_filename), std::runtime_error);
+  ASSERT_THROW(mtt::ScanLog::fromFile("/path/that/does/not/exist"), std::runtime_error);
+}
+
+TEST(ScanLog, reopen) {
+  const mtt::ScanRecords src_records = makeRecords();
+  const std::string filename = makeTempFile();
+  mtt::ScanRecords::const_iterator it = src_records.begin();
+  for (int i = 0; i < 3; ++i) {
+    mtt::ScanLog log(filename);
+    log.append(it->first, it->second);
+    ++it;
+  }
+  // a record broken by a crash is ignored, and is cut before the next one
+  {
+    std::ofstream ofs(filename, std::ios::binary | std::ios::app);
+    ofs << "\x20\x01\x02";
+  }
+  ASSERT_EQ(3u, mtt::ScanLog::fromFile(filename).size());
+  {
+    mtt::ScanLog log(filename);
+    ASSERT_EQ(3u, log.size());
+    for (; it != src_records.end(); ++it) {
+      log.append(it->first, it->second);
+    }
+  }
+  ASSERT_EQ(src_records, mtt::ScanLog::fromFile(filename));
+}
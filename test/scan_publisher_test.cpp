@@ -0,0 +1,113 @@
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <mac_time_tracker/scan_publisher.hpp>
+
+#include "make_temp_file.hpp"
+
+namespace mtt = mac_time_tracker;
+
+static int connectTo(const std::string &path) {
+  const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  sockaddr_un addr = {};
+  addr.sun_family = AF_UNIX;
+  path.copy(addr.sun_path, sizeof(addr.sun_path) - 1);
+  if (::connect(fd, reinterpret_cast<const sockaddr *>(&addr), sizeof(addr)) != 0) {
+    ::close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+// read what is available without blocking
+static std::string readAvailable(const int fd) {
+  std::string str;
+  char buf[4096];
+  ssize_t n;
+  while ((n = ::recv(fd, buf, sizeof(buf), MSG_DONTWAIT)) > 0) {
+    str.append(buf, n);
+  }
+  return str;
+}
+
+TEST(ScanPublisher, publish) {
+  const std::string path = makeTempFile() + ".sock";
+  mtt::ScanPublisher publisher(path, 64);
+  ASSERT_EQ(0u, publisher.subscribers());
+  // nobody receives
+  publisher.publish("a\n");
+
+  const int fast = connectTo(path), slow = connectTo(path);
+  ASSERT_GE(fast, 0);
+  ASSERT_GE(slow, 0);
+  // shrink the buffers so that the slow subscriber fills the publisher's one
+  const int bufsize = 1;
+  ::setsockopt(slow, SOL_SOCKET, SO_RCVBUF, &bufsize, sizeof(bufsize));
+
+  const std::string message(20, 'x');
+  std::string received;
+  for (int i = 0; i < 1000; ++i) {
+    publisher.publish(message + "\n");
+    received += readAvailable(fast);
+  }
+  ASSERT_EQ(2u, publisher.subscribers());
+  ASSERT_EQ(1000u * 21, received.size());
+  ASSERT_GT(publisher.dropped(), 0u);
+
+  // the slow subscriber is told the number of dropped messages when it catches up
+  std::string slow_received;
+  for (int i = 0; i < 100; ++i) {
+    slow_received += readAvailable(slow);
+    publisher.flush();
+  }
+  publisher.publish("last\n");
+  slow_received += readAvailable(slow);
+  ASSERT_NE(std::string::npos, slow_received.find("dropped,"));
+  ASSERT_EQ("last\n", slow_received.substr(slow_received.size() - 5));
+
+  // disconnected subscribers are removed
+  ::close(fast);
+  ::close(slow);
+  publisher.publish("gone\n");
+  publisher.publish("gone\n");
+  ASSERT_EQ(0u, publisher.subscribers());
+}
+
+TEST(ScanPublisher, oversizeMessage) {
+  const std::string path = makeTempFile() + ".sock";
+  mtt::ScanPublisher publisher(path, 16);
+  const int sub = connectTo(path);
+  ASSERT_GE(sub, 0);
+  // a message larger than the buffer is still sent if nothing is unsent
+  const std::string message = std::string(100, 'x') + "\n";
+  publisher.publish(message);
+  ASSERT_EQ(message, readAvailable(sub));
+  ASSERT_EQ(0u, publisher.dropped());
+  ::close(sub);
+}
+
+TEST(ScanPublisher, path) {
+  // a file which is not a socket is never removed
+  const std::string path = makeTempFile();
+  std::ofstream(path) << "data";
+  ASSERT_THROW(mtt::ScanPublisher(path, 16), std::runtime_error);
+  ASSERT_TRUE(std::ifstream(path));
+  std::remove(path.c_str());
+  // a socket is removed on destruction
+  struct stat st;
+  {
+    mtt::ScanPublisher publisher(path, 16);
+    ASSERT_EQ(0, ::lstat(path.c_str(), &st));
+    ASSERT_TRUE(S_ISSOCK(st.st_mode));
+  }
+  ASSERT_NE(0, ::lstat(path.c_str(), &st));
+}
@@ -0,0 +1,90 @@
+#include <chrono>
+#include <stdexcept>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <mac_time_tracker/address.hpp>
+#include <mac_time_tracker/csv.hpp>
+#include <mac_time_tracker/scan_records.hpp>
+#include <mac_time_tracker/time.hpp>
+
+#include "make_temp_file.hpp"
+
+namespace mtt = mac_time_tracker;
+
+TEST(ScanRecords, fromFile) {
+  // [OK]
+  // - timestamps followed by any number of addresses are OK
+  ASSERT_NO_THROW(mtt::ScanRecords::fromFile(
+      makeTempFile("2021-03-11 10:00:00, 00:11:22:33:44:55, 66:77:88:99:AA:BB\n"
+                   "2021-03-11 10:05:00\n"
+                   "2021-03-11 10:10:00, 00-11-22-33-44-55")));
+  // [NG]
+  // - ill-formed timestamp
+  ASSERT_THROW(mtt::ScanRecords::fromFile(makeTempFile("10:00, 00:11:22:33:44:55")),
+               std::runtime_error);
+  // - ill-formed address
+  ASSERT_THROW(mtt::ScanRecords::fromFile(makeTempFile("2021-03-11 10:00:00, 192.168.0.1")),
+               std::runtime_error);
+  // - non-unique timestamp
+  ASSERT_THROW(mtt::ScanRecords::fromFile(makeTempFile("2021-03-11 10:00:00\n"
+                                                       "2021-03-11 10:00:00")),
+               std::runtime_error);
+}
+
+TEST(ScanRecords, toFile) {
+  const mtt::Time time = mtt::Time::fromStr("2021-03-11 10:00:00");
+  const mtt::ScanRecords src_records = {{time,
+                                         {mtt::Address::fromStr("00:11:22:33:44:55"),
+                                          mtt::Address::fromStr("66:77:88:99:AA:BB")}},
+                                        {time + std::chrono::minutes(5), {}}};
+  const std::string temp_file = makeTempFile();
+  src_records.toFile(temp_file);
+  const mtt::ScanRecords dst_records = mtt::ScanRecords::fromFile(temp_file);
+  ASSERT_EQ(2, dst_records.size());
+  ASSERT_EQ(2, dst_records.at(time).size());
+  ASSERT_EQ(0, dst_records.at(time + std::chrono::minutes(5)).size());
+  ASSERT_EQ(src_records, dst_records);
+}
+
+TEST(ScanRecords, hasRecordIn) {
+  const std::chrono::minutes five(5);
+  const mtt::Time day_end = mtt::Time::fromStr("2021-03-12 00:00:00");
+  // records stop 15 mins before the end of a day and resume 10 mins after it
+  const mtt::ScanRecords records = {
+      {day_end - 4 * five, {}}, {day_end - 3 * five, {}}, {day_end + 2 * five, {}}};
+  ASSERT_TRUE(records.hasRecordIn(day_end - 4 * five, day_end));
+  ASSERT_TRUE(records.hasRecordIn(day_end - 3 * five, day_end));
+  // the scan ending at day_end - 2 * five is the last one of the day, across the gap
+  ASSERT_FALSE(records.hasRecordIn(day_end - 2 * five, day_end));
+  ASSERT_TRUE(records.hasRecordIn(day_end - 2 * five, day_end + std::chrono::hours(24)));
+  ASSERT_FALSE(records.hasRecordIn(day_end, day_end));
+  ASSERT_FALSE(records.hasRecordIn(day_end + 3 * five, day_end + std::chrono::hours(24)));
+}
+
+// lines read without tokenizing them are same as tokenized ones
+TEST(ScanRecords, parseLine) {
+  const std::string lines[] = {
+      R"("2021-03-11 10:00:00","00:11:22:33:44:55","66:77:88:99:AA:BB")",
+      R"( 2021-03-11 10:05:00 , " 00-11-22-33-44-55 " ,66:77:88:99:aa:bb )",
+      R"("2021-03-11 10:10:00")",
+      // tokenized
+      R"("2021-03-11 10:15:00","00:11:22:33:44:55\n")",
+      R"("2021-03-11 10:20:00","00:11:22:33:44:55" "")",
+      R"("2021-03-11 10:25:00",""00:11:22:33:44:55)",
+      R"("2021-03-11 10:30:00","00:11:22:33:44:55 66:77:88:99:AA:BB")"};
+  for (const std::string &line : lines) {
+    const mtt::ScanRecords records = mtt::ScanRecords::fromStr(line);
+    ASSERT_EQ(mtt::ScanRecords::fromCSV(mtt::CSV::fromStr(line)), records) << line;
+  }
+  // ill-formed lines
+  const std::string ng_lines[] = {
+      R"("2021-03-11 10:00:00","00:11:22:33:44:55",)",
+      R"("2021-03-11 10:00:00","00:11:22:33:44:55x")",
+      R"("2021-03-11","00:11:22:33:44:55")"};
+  for (const std::string &line : ng_lines) {
+    ASSERT_THROW(mtt::ScanRecords::fromStr(line), std::runtime_error) << line;
+    ASSERT_THROW(mtt::ScanRecords::fromCSV(mtt::CSV::fromStr(line)), std::runtime_error) << line;
+  }
+}
@@ -0,0 +1,71 @@
+#include <chrono>
+#include <stdexcept>
+
+#include <gtest/gtest.h>
+
+#include <mac_time_tracker/clock.hpp>
+#include <mac_time_tracker/scan_scheduler.hpp>
+#include <mac_time_tracker/time.hpp>
+
+namespace mtt = mac_time_tracker;
+namespace sc = std::chrono;
+
+TEST(Histogram, add) {
+  mtt::Histogram hist({10, 100});
+  hist.add(-1);
+  hist.add(10);
+  hist.add(99);
+  hist.add(1000);
+  ASSERT_EQ(std::vector<std::size_t>({1, 2, 1}), hist.counts());
+  ASSERT_EQ(4u, hist.total());
+  ASSERT_THROW(mtt::Histogram({100, 10}), std::runtime_error);
+}
+
+TEST(ScanScheduler, onTime) {
+  const mtt::Time base = mtt::Time::fromStr("2021-03-11 00:00:00");
+  mtt::ManualClock clock(base + sc::minutes(12));
+  mtt::ScanScheduler scheduler(&clock, base, sc::minutes(5), false);
+  ASSERT_EQ(base + sc::minutes(10), scheduler.gridStart(clock.now()));
+  ASSERT_EQ(base - sc::minutes(5), scheduler.gridStart(base - sc::minutes(1)));
+  // a cycle of 1 minute in the period [10, 15)
+  clock.sleepUntil(base + sc::minutes(13));
+  ASSERT_EQ(0u, scheduler.sleepAfter({base + sc::minutes(10), base + sc::minutes(15)}));
+  ASSERT_EQ(base + sc::minutes(15), clock.now());
+  const mtt::ScanScheduler::Stats &stats = scheduler.stats();
+  ASSERT_EQ(0u, stats.missed);
+  ASSERT_EQ(1u, stats.jitter.counts()[0]); // no lateness
+  ASSERT_EQ(1u, stats.cycle.counts()[1]);  // 20% of the interval
+  // a cycle ending just on the boundary misses nothing
+  clock.sleepUntil(base + sc::minutes(20));
+  ASSERT_EQ(0u, scheduler.sleepAfter({base + sc::minutes(15), base + sc::minutes(20)}));
+  ASSERT_EQ(base + sc::minutes(20), clock.now());
+  ASSERT_EQ(0u, stats.missed);
+}
+
+TEST(ScanScheduler, overrun) {
+  const mtt::Time base = mtt::Time::fromStr("2021-03-11 00:00:00");
+  for (const bool catch_up : {false, true}) {
+    mtt::ManualClock clock(base);
+    mtt::ScanScheduler scheduler(&clock, base, sc::minutes(5), catch_up);
+    // a cycle for [0, 5) ends at 12, so [5, 10) is missed
+    clock.sleepUntil(base + sc::minutes(12));
+    bool caught_up;
+    const std::size_t missed = scheduler.sleepAfter({base, base + sc::minutes(5)}, &caught_up);
+    ASSERT_EQ(catch_up, caught_up);
+    if (catch_up) {
+      // [10, 15) is scanned immediately
+      ASSERT_EQ(1u, missed);
+      ASSERT_EQ(base + sc::minutes(12), clock.now());
+      ASSERT_EQ(1u, scheduler.stats().catch_ups);
+      ASSERT_EQ(0u, scheduler.stats().jitter.total());
+    } else {
+      // [10, 15) is also skipped to start on the grid
+      ASSERT_EQ(2u, missed);
+      ASSERT_EQ(base + sc::minutes(15), clock.now());
+      ASSERT_EQ(0u, scheduler.stats().catch_ups);
+      ASSERT_EQ(1u, scheduler.stats().jitter.total());
+    }
+    ASSERT_EQ(missed, scheduler.stats().missed);
+    ASSERT_EQ(1u, scheduler.stats().cycle.counts().back()); // over 100% of the interval
+  }
+}
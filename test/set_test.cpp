@@ -1,3 +1,5 @@
+#include <string>
+
 #include <gtest/gtest.h>
 
 #include <mac_time_tracker/address.hpp>
@@ -30,4 +32,14 @@ TEST(Set, generalUse) {
   ASSERT_EQ(1, set.erase(addr[0]));
   ASSERT_EQ(set.end(), set.find(addr[0]));
   ASSERT_EQ(0, set.erase(addr[0]));
-}
\ No newline at end of file
+}
+
+TEST(Set, fromText) {
+  const std::string text = "192.168.0.2\t00:11:22:33:44:55\tVendor\n"
+                           "192.168.0.3\t66-77-88-99-aa-bb\t(DUP: 2)\n"
+                           "192.168.0.4\t00:11:22:33:44:55\tVendor\n";
+  const mtt::Set set = mtt::Set::fromText(text.data(), text.data() + text.size());
+  ASSERT_EQ(mtt::Set({mtt::Address::fromStr("00:11:22:33:44:55"),
+                      mtt::Address::fromStr("66:77:88:99:AA:BB")}),
+            set);
+}
@@ -0,0 +1,88 @@
+#include <chrono>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <mac_time_tracker/address.hpp>
+#include <mac_time_tracker/clock.hpp>
+#include <mac_time_tracker/set.hpp>
+#include <mac_time_tracker/sharded_sweeper.hpp>
+#include <mac_time_tracker/time.hpp>
+
+namespace mtt = mac_time_tracker;
+
+// responds for every 16th address, taking the time to send requests at the rate
+class FakeRangeScanner : public mtt::RangeScanner {
+public:
+  explicit FakeRangeScanner(mtt::ManualClock *const clock) : clock_(clock) {}
+
+  virtual mtt::Set scan(const std::uint32_t first, const std::uint32_t last,
+                        const unsigned int pps) override {
+    ranges.push_back({first, last});
+    clock_->sleepUntil(clock_->now() +
+                       std::chrono::microseconds((last - first + 1) * 1000000ull / pps));
+    mtt::Set found;
+    for (std::uint32_t ip = first; ip <= last; ++ip) {
+      if (ip % 16 == 0) {
+        found.insert(mtt::Address::fromInt(ip));
+      }
+    }
+    return found;
+  }
+
+  std::vector<std::pair<std::uint32_t, std::uint32_t>> ranges;
+
+private:
+  mtt::ManualClock *clock_;
+};
+
+TEST(ShardedSweeper, parseCIDR) {
+  const std::pair<std::uint32_t, std::uint32_t> range =
+      mtt::ShardedSweeper::parseCIDR("10.1.2.3/16");
+  ASSERT_EQ(0x0A010001u, range.first);
+  ASSERT_EQ(0x0A01FFFEu, range.second);
+  ASSERT_EQ("10.1.255.254", mtt::ArpScanRangeScanner::ipToStr(range.second));
+  ASSERT_THROW(mtt::ShardedSweeper::parseCIDR("10.1.2.3"), std::runtime_error);
+  ASSERT_THROW(mtt::ShardedSweeper::parseCIDR("10.1.2.256/16"), std::runtime_error);
+  ASSERT_THROW(mtt::ShardedSweeper::parseCIDR("10.1.2.3/31"), std::runtime_error);
+}
+
+TEST(ShardedSweeper, sweep) {
+  const mtt::Time start = mtt::Time::fromStr("2021-03-11 10:00:00");
+  mtt::ManualClock clock(start);
+  FakeRangeScanner scanner(&clock);
+  // 1000 addresses in 4 shards (the last one is short) at 10 packets per second
+  mtt::ShardedSweeper sweeper(&scanner, &clock, 1, 1000, 256, 10);
+  ASSERT_EQ(4u, sweeper.shards());
+  ASSERT_EQ(std::make_pair(769u, 1000u), sweeper.shardAt(3));
+
+  // enough time for all shards. they start on their slots.
+  mtt::ShardedSweeper::Stats stats;
+  const mtt::Set found = sweeper.sweep(start + std::chrono::minutes(5), &stats);
+  ASSERT_EQ(62u, found.size());
+  ASSERT_EQ(4u, stats.scanned_shards);
+  ASSERT_DOUBLE_EQ(1., stats.coverage());
+  ASSERT_EQ(std::chrono::milliseconds(25600), stats.max_latency);
+  ASSERT_EQ(4u, scanner.ranges.size());
+  ASSERT_EQ(start + std::chrono::seconds(225) + std::chrono::milliseconds(23200), clock.now());
+
+  // 60 seconds fit 2 shards at the rate. the next sweep resumes from the 3rd shard.
+  // the skipped shards give their last results.
+  scanner.ranges.clear();
+  const mtt::Time second = clock.now();
+  ASSERT_EQ(found, sweeper.sweep(second + std::chrono::seconds(60), &stats));
+  ASSERT_EQ(2u, stats.scanned_shards);
+  ASSERT_EQ(2u, stats.stale_shards);
+  ASSERT_DOUBLE_EQ(512. / 1000., stats.coverage());
+  scanner.ranges.clear();
+  sweeper.sweep(clock.now() + std::chrono::seconds(60), &stats);
+  ASSERT_EQ(2u, stats.scanned_shards);
+  ASSERT_EQ(std::make_pair(513u, 768u), scanner.ranges[0]);
+  ASSERT_EQ(std::make_pair(769u, 1000u), scanner.ranges[1]);
+
+  // the rate never exceeds the budget
+  ASSERT_GE(clock.now() - second, std::chrono::seconds(1000 / 10));
+}
@@ -0,0 +1,79 @@
+#include <chrono>
+#include <map>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <mac_time_tracker/address.hpp>
+#include <mac_time_tracker/period_map.hpp>
+#include <mac_time_tracker/sqlite_store.hpp>
+#include <mac_time_tracker/time.hpp>
+
+#include "make_temp_file.hpp"
+
+namespace mtt = mac_time_tracker;
+
+TEST(SQLiteStore, query) {
+  const std::string filename = makeTempFile();
+  const mtt::Time t0 = mtt::Time::fromStr("2021-03-11 10:00:00");
+  const std::chrono::minutes five(5);
+  const mtt::Address phone = mtt::Address::fromStr("00:11:22:33:44:55"),
+                     pc = mtt::Address::fromStr("66:77:88:99:AA:BB"),
+                     tablet = mtt::Address::fromStr("CC:DD:EE:FF:00:11");
+  {
+    mtt::SQLiteStore store(filename);
+    // John is present in 3 periods with 2 devices, and Jane is in 1
+    mtt::PeriodMap scans;
+    scans.insert({{t0, t0 + five}, {phone, "John", "Phone"}});
+    scans.insert({{t0, t0 + five}, {pc, "John", "PC"}});
+    scans.insert({{t0 + five, t0 + 2 * five}, {pc, "John", "PC"}});
+    store.insert(scans.begin(), scans.end());
+    scans.clear();
+    scans.insert({{t0 + 3 * five, t0 + 4 * five}, {phone, "John", "Phone"}});
+    scans.insert({{t0 + 3 * five, t0 + 4 * five}, {tablet, "Jane", "Tablet"}});
+    store.insert(scans.begin(), scans.end());
+  }
+
+  // reopen
+  mtt::SQLiteStore store(filename);
+  mtt::Time last;
+  ASSERT_TRUE(store.lastSeen(phone, &last));
+  ASSERT_EQ(t0 + 4 * five, last);
+  ASSERT_TRUE(store.lastSeen(pc, &last));
+  ASSERT_EQ(t0 + 2 * five, last);
+  ASSERT_FALSE(store.lastSeen(mtt::Address::fromStr("FF:FF:FF:FF:FF:FF"), &last));
+
+  // periods of 2 devices are counted once, and clipped by the range
+  std::map<std::string, mtt::Time::duration> presence =
+      store.presenceByCategory(t0, t0 + std::chrono::hours(1));
+  ASSERT_EQ(2u, presence.size());
+  ASSERT_EQ(3 * five, presence["John"]);
+  ASSERT_EQ(five, presence["Jane"]);
+  presence = store.presenceByCategory(t0 + std::chrono::minutes(7), t0 + 3 * five);
+  ASSERT_EQ(1u, presence.size());
+  ASSERT_EQ(std::chrono::minutes(3), presence["John"]);
+
+  // queries use the indexes
+  ASSERT_NE(std::string::npos,
+            store.explain("SELECT end FROM presence WHERE address = 1 ORDER BY start DESC LIMIT 1")
+                .find("presence_address_start"));
+  // the range of start of each category is bounded on both sides
+  const std::string plan = store.explain(mtt::SQLiteStore::presenceByCategoryQuery());
+  ASSERT_NE(std::string::npos,
+            plan.find("presence_category_start (category=? AND start>? AND start<?)"));
+  ASSERT_EQ(std::string::npos, plan.find("SCAN p"));
+}
+
+TEST(SQLiteStore, insertMany) {
+  mtt::SQLiteStore store(makeTempFile());
+  const mtt::Time t0 = mtt::Time::fromStr("2021-03-11 10:00:00");
+  mtt::PeriodMap scan;
+  for (int i = 0; i < 10000; ++i) {
+    scan.insert({{t0, t0 + std::chrono::minutes(5)},
+                 {mtt::Address::fromInt(i), "category" + std::to_string(i % 100), ""}});
+  }
+  store.insert(scan.begin(), scan.end());
+  mtt::Time last;
+  ASSERT_TRUE(store.lastSeen(mtt::Address::fromInt(9999), &last));
+  ASSERT_EQ(100u, store.presenceByCategory(t0, t0 + std::chrono::hours(1)).size());
+}
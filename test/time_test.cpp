@@ -1,5 +1,8 @@
 #include <chrono>
 #include <regex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
 
 #include <gtest/gtest.h>
 
@@ -30,4 +33,45 @@ TEST(Time, toStr) {
   ASSERT_TRUE(std::regex_match(t0.toStr(fmt_custom), re_custom));
   ASSERT_TRUE(std::regex_match(t1.toStr(fmt_custom), re_custom));
   ASSERT_STRNE(t0.toStr(fmt_custom).c_str(), t1.toStr(fmt_custom).c_str());
-}
\ No newline at end of file
+}
+TEST(Time, fromStr) {
+  // Round trip in the default format
+  const mtt::Time t0 = mtt::Time::fromStr("2021-03-11 10:20:30");
+  ASSERT_STREQ("2021-03-11 10:20:30", t0.toStr().c_str());
+  ASSERT_EQ(t0, mtt::Time::fromStr(t0.toStr()));
+  ASSERT_EQ(t0 + std::chrono::seconds(30), mtt::Time::fromStr("2021-03-11 10:21:00"));
+  // Custom format
+  ASSERT_EQ(t0, mtt::Time::fromStr("10:20:30 on 11/03/2021", "%H:%M:%S on %d/%m/%Y"));
+  // Invalid strings
+  ASSERT_THROW(mtt::Time::fromStr(""), std::runtime_error);
+  ASSERT_THROW(mtt::Time::fromStr("2021-03-11"), std::runtime_error);
+  ASSERT_THROW(mtt::Time::fromStr("10:20:30", "%H:%M:%S on %d/%m/%Y"), std::runtime_error);
+}
+
+TEST(Time, chars) {
+  const std::string str = "2021-03-11 10:20:30 ";
+  mtt::Time t;
+  ASSERT_EQ(str.data() + str.size(),
+            mtt::Time::fromChars(str.data(), str.data() + str.size(), &t));
+  ASSERT_EQ(mtt::Time::fromStr("2021-03-11 10:20:30"), t);
+  ASSERT_EQ(nullptr, mtt::Time::fromChars(str.data(), str.data() + 10, &t));
+  // 19 chars and a terminating null are written
+  char buf[20];
+  ASSERT_EQ(buf + 19, t.toChars(buf, buf + 20));
+  ASSERT_STREQ("2021-03-11 10:20:30", buf);
+  ASSERT_EQ(nullptr, t.toChars(buf, buf + 19));
+  ASSERT_EQ(buf + 4, t.toChars(buf, buf + 20, "%Y"));
+  ASSERT_STREQ("2021", buf);
+}
+
+TEST(Time, stream) {
+  std::istringstream iss("2021-03-11 10:20:30 42");
+  mtt::Time t;
+  int n = 0;
+  ASSERT_TRUE(iss >> t >> n);
+  ASSERT_EQ(mtt::Time::fromStr("2021-03-11 10:20:30"), t);
+  ASSERT_EQ(42, n);
+  // a truncated time fails
+  std::istringstream truncated("2021-03-11");
+  ASSERT_FALSE(truncated >> t);
+}
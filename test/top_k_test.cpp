@@ -0,0 +1,41 @@
+#include <cstdint>
+#include <stdexcept>
+
+#include <gtest/gtest.h>
+
+#include <mac_time_tracker/address.hpp>
+#include <mac_time_tracker/top_k.hpp>
+
+namespace mtt = mac_time_tracker;
+
+TEST(TopK, insert) {
+  ASSERT_THROW(mtt::TopK<mtt::Address> top_k(0), std::runtime_error);
+
+  mtt::TopK<mtt::Address> top_k(3);
+  const mtt::Address frequent[] = {mtt::Address::fromStr("00:11:22:33:44:55"),
+                                   mtt::Address::fromStr("66:77:88:99:AA:BB")};
+  // a flood of one-off addresses between frequent ones
+  for (std::uint64_t i = 0; i < 1000; ++i) {
+    top_k.insert(frequent[0]);
+    top_k.insert(frequent[1]);
+    top_k.insert(mtt::Address::fromInt(0x020000000000ull + i));
+    ASSERT_LE(top_k.size(), 3);
+  }
+  // frequent addresses are exactly counted
+  for (const mtt::Address &addr : frequent) {
+    const mtt::TopK<mtt::Address>::Counter *const counter = top_k.find(addr);
+    ASSERT_NE(nullptr, counter);
+    ASSERT_EQ(1000, counter->count);
+    ASSERT_EQ(0, counter->error);
+  }
+  // only the last one-off address is monitored and it is seen once for sure
+  ASSERT_EQ(nullptr, top_k.find(mtt::Address::fromInt(0x020000000000ull)));
+  const mtt::TopK<mtt::Address>::Counter *const counter =
+      top_k.find(mtt::Address::fromInt(0x020000000000ull + 999));
+  ASSERT_NE(nullptr, counter);
+  ASSERT_EQ(1, counter->count - counter->error);
+  // clear
+  top_k.clear();
+  ASSERT_EQ(0, top_k.size());
+  ASSERT_EQ(nullptr, top_k.find(frequent[0]));
+}
@@ -0,0 +1,57 @@
+#include <stdexcept>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <mac_time_tracker/address.hpp>
+#include <mac_time_tracker/vendor_map.hpp>
+
+#include "make_temp_file.hpp"
+
+namespace mtt = mac_time_tracker;
+
+TEST(VendorMap, fromFile) {
+  // [OK]
+  // - header and entries of all the registries are OK
+  ASSERT_NO_THROW(mtt::VendorMap::fromFile(
+      makeTempFile("Registry,Assignment,Organization Name,Organization Address\n"
+                   "MA-L,001122,Vendor L,\"1 Street, City\"\n"
+                   "MA-M,0011223,Vendor M,\"2 Street, City\"\n"
+                   "MA-S,001122334,Vendor S,\"3 Street, City\"")));
+  // - missing address is OK
+  ASSERT_NO_THROW(mtt::VendorMap::fromFile(makeTempFile("MA-L,001122,Vendor L")));
+  // [NG]
+  // - missing name is NG
+  ASSERT_THROW(mtt::VendorMap::fromFile(makeTempFile("MA-L,001122")), std::runtime_error);
+  // - non-hex assignment is NG
+  ASSERT_THROW(mtt::VendorMap::fromFile(makeTempFile("MA-L,00112G,Vendor L")), std::runtime_error);
+  // - assignment with unsupported length is NG
+  ASSERT_THROW(mtt::VendorMap::fromFile(makeTempFile("MA-L,00112,Vendor L")), std::runtime_error);
+}
+
+TEST(VendorMap, find) {
+  const mtt::VendorMap vendor_map =
+      mtt::VendorMap::fromFile(makeTempFile("MA-L,001122,Vendor L\n"
+                                            "MA-M,0011223,Vendor M\n"
+                                            "MA-S,001122334,Vendor S\n"
+                                            "MA-L,AABBCC,Vendor L\n"
+                                            "MA-L,AABBCC,Duplicated Vendor L"));
+  ASSERT_EQ(4, vendor_map.size());
+  // the longest prefix wins
+  const std::string *vendor = vendor_map.find(mtt::Address::fromStr("00:11:22:33:45:67"));
+  ASSERT_NE(nullptr, vendor);
+  ASSERT_STREQ("Vendor S", vendor->c_str());
+  vendor = vendor_map.find(mtt::Address::fromStr("00:11:22:34:56:78"));
+  ASSERT_NE(nullptr, vendor);
+  ASSERT_STREQ("Vendor M", vendor->c_str());
+  vendor = vendor_map.find(mtt::Address::fromStr("00:11:22:FF:FF:FF"));
+  ASSERT_NE(nullptr, vendor);
+  ASSERT_STREQ("Vendor L", vendor->c_str());
+  // names are shared between assignments and the first one of duplicated assignments wins
+  vendor = vendor_map.find(mtt::Address::fromStr("AA:BB:CC:00:00:00"));
+  ASSERT_NE(nullptr, vendor);
+  ASSERT_STREQ("Vendor L", vendor->c_str());
+  // no matches
+  ASSERT_EQ(nullptr, vendor_map.find(mtt::Address::fromStr("00:11:23:33:44:55")));
+  ASSERT_EQ(nullptr, vendor_map.find(mtt::Address::fromStr("FF:FF:FF:FF:FF:FF")));
+}